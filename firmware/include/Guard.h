@@ -1,8 +1,8 @@
 #pragma once
-#include <ESPAsyncWebServer.h>
+#include "HttpRequest.h"
 
 class Guard {
 public:
-    virtual bool canActivate(AsyncWebServerRequest* req) = 0;
+    virtual bool canActivate(HttpRequest* req) = 0;
     virtual ~Guard() {}
 };
@@ -1,15 +1,46 @@
 #pragma once
 #include <Arduino.h>
+#include "HttpRequest.h"
+#include <utility>
+#include "JsonWriter.h"
 
+// Move-only; thrown by value and caught by const reference
 class HttpError {
 public:
-    HttpError(int statusCode, const String& message)
-        : _statusCode(statusCode), _message(message) {}
+    // retryAfterSeconds > 0 adds a Retry-After header (503 responses)
+    HttpError(int statusCode, const String& message, uint16_t retryAfterSeconds = 0)
+        : _statusCode(statusCode), _message(message), _retryAfter(retryAfterSeconds) {}
+
+    HttpError(HttpError&& other)
+        : _statusCode(other._statusCode), _message(std::move(other._message)), _retryAfter(other._retryAfter) {}
+
+    HttpError(const HttpError&) = delete;
+    HttpError& operator=(const HttpError&) = delete;
 
     int statusCode() const { return _statusCode; }
-    String message() const { return _message; }
+    const String& message() const { return _message; }
+    uint16_t retryAfter() const { return _retryAfter; }
+
+    // Send as { ok: false, error }, streamed like HttpSuccess
+    void send(HttpRequest* request) const {
+        bool msgpack = request->acceptsMsgPack();
+        HttpResponse response(_statusCode, msgpack ? "application/msgpack" : "application/json");
+        if (_retryAfter) response.header("Retry-After", String(_retryAfter));
+        response.stream(_message.length() + 32, [this, msgpack](Print& out) {
+            if (msgpack) {
+                printMsgPackEnvelope(out, false, "error");
+                printMsgPackString(out, _message.c_str(), _message.length());
+                return;
+            }
+            out.print("{\"ok\":false,\"error\":");
+            printJsonString(out, _message.c_str());
+            out.print("}");
+        });
+        request->send(response);
+    }
 
 private:
     int _statusCode;
     String _message;
+    uint16_t _retryAfter;
 };
@@ -0,0 +1,177 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include <utility>
+#include <vector>
+
+enum class HttpMethod : uint8_t { Get, Post, Delete, Put, Patch, Head, Options, Other };
+
+// What a handler answers with, independent of the server library. The body is one of
+// a complete text, a writer that prints it synchronously while the response is sent,
+// or a filler that is pulled as the client accepts data (files, long outputs).
+// Content types are not copied: pass string literals.
+class HttpResponse {
+public:
+    using Writer = std::function<void(Print& out)>;
+    using Filler = std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)>;
+    static const size_t UNKNOWN_LENGTH = (size_t)-1;   // filler responses sent chunked
+    static const size_t FILL_LATER = (size_t)-1;       // filler has nothing yet, ask again
+
+    enum class Body : uint8_t { Empty, Text, Stream, Fill };
+
+    explicit HttpResponse(int status = 200, const char* contentType = "application/json")
+        : _status(status), _contentType(contentType) {}
+
+    HttpResponse(HttpResponse&&) = default;
+    HttpResponse& operator=(HttpResponse&&) = default;
+    HttpResponse(const HttpResponse&) = delete;
+    HttpResponse& operator=(const HttpResponse&) = delete;
+
+    HttpResponse& status(int status) { _status = status; return *this; }
+    HttpResponse& header(const String& name, const String& value) {
+        _headers.emplace_back(name, value);
+        return *this;
+    }
+    HttpResponse& text(const String& body) {
+        _body = Body::Text;
+        _text = body;
+        return *this;
+    }
+    // sizeHint: expected length, so buffers are sized once
+    HttpResponse& stream(size_t sizeHint, Writer writer) {
+        _body = Body::Stream;
+        _length = sizeHint;
+        _writer = std::move(writer);
+        return *this;
+    }
+    // The filler returns the bytes written to buffer, 0 at the end, or FILL_LATER while
+    // it waits for data (long-polls): the headers are out and it is called again shortly.
+    // Check HttpRequest::canWait() first; where it is false the body ends there.
+    HttpResponse& fill(size_t length, Filler filler) {
+        _body = Body::Fill;
+        _length = length;
+        _filler = std::move(filler);
+        return *this;
+    }
+
+    int status() const { return _status; }
+    const char* contentType() const { return _contentType; }
+    const std::vector<std::pair<String, String>>& headers() const { return _headers; }
+    Body body() const { return _body; }
+    const String& text() const { return _text; }
+    size_t length() const { return _length; }
+    const Writer& writer() const { return _writer; }
+    const Filler& filler() const { return _filler; }
+
+private:
+    int _status;
+    const char* _contentType;
+    std::vector<std::pair<String, String>> _headers;
+    Body _body = Body::Empty;
+    String _text;
+    size_t _length = 0;
+    Writer _writer;
+    Filler _filler;
+};
+
+// Most :param / * segments in one route pattern
+#ifndef HTTP_MAX_PATH_PARAMS
+#define HTTP_MAX_PATH_PARAMS 4
+#endif
+
+// One path parameter: a view into the request's url(), not NUL-terminated and valid
+// while the request lives. Missing parameters are empty.
+struct PathParam {
+    const char* data = nullptr;
+    uint16_t length = 0;
+
+    bool empty() const { return length == 0; }
+    bool equals(const char* text) const {
+        return strlen(text) == length && (length == 0 || memcmp(data, text, length) == 0);
+    }
+    // Decimal value; false if empty, not a number or out of range
+    bool toULong(unsigned long& value) const {
+        if (length == 0 || length > 10) return false;
+        unsigned long long result = 0;
+        for (uint16_t i = 0; i < length; i++) {
+            if (data[i] < '0' || data[i] > '9') return false;
+            result = result * 10 + (data[i] - '0');
+        }
+        if (result > 0xFFFFFFFFULL) return false;
+        value = (unsigned long)result;
+        return true;
+    }
+    String toString() const {   // copies
+        String text;
+        if (length) text.concat(data, length);
+        return text;
+    }
+};
+
+// Path parameters of the matched route, filled in by the router before dispatch.
+// Names point into the route table.
+struct PathParams {
+    const char* names[HTTP_MAX_PATH_PARAMS];
+    PathParam values[HTTP_MAX_PATH_PARAMS];
+    uint8_t count = 0;
+
+    PathParam get(const char* name) const {
+        for (uint8_t i = 0; i < count; i++)
+            if (strcmp(names[i], name) == 0) return values[i];
+        return PathParam();
+    }
+};
+
+// The request as routers, guards and middleware see it. Implemented by the server
+// backend (AsyncHttpRequest) and by SyntheticRequest for in-process dispatch.
+// Lookups return references into the request; a missing value is an empty String.
+class HttpRequest {
+public:
+    virtual ~HttpRequest() {}
+
+    virtual HttpMethod method() const = 0;
+    virtual const String& url() const = 0;                      // path, without the query
+    virtual bool hasParam(const char* name) const = 0;          // query parameter
+    virtual const String& param(const char* name) const = 0;
+    virtual bool hasHeader(const char* name) const = 0;
+    virtual const String& header(const char* name) const = 0;
+
+    // Content negotiation: MessagePack if the client asks for it (Accept) or sent its
+    // body that way (Content-Type); JSON otherwise
+    bool acceptsMsgPack() const { return mentionsMsgPack("Accept"); }
+    bool sentMsgPack() const { return mentionsMsgPack("Content-Type"); }
+
+    // `:name` or `*` segment of the route pattern, e.g. pathParam("id") for /jobs/:id
+    PathParam pathParam(const char* name) const { return _pathParams.get(name); }
+    PathParams& pathParams() { return _pathParams; }
+
+    // True for in-process sub-requests whose caller already validated the client's
+    // token (POST /batch); AuthGuard accepts them as is. Never set for network requests.
+    bool authenticated() const { return _authenticated; }
+
+    // Same value for every callback of one request, e.g. all chunks of an upload
+    virtual const void* id() const = 0;
+
+    // Whether a FILL_LATER filler is asked again without holding up other clients.
+    // Long-polls answer at once where it is not.
+    virtual bool canWait() const { return true; }
+
+    // Sends the response; call once per request
+    virtual void send(HttpResponse& response) = 0;
+
+protected:
+    PathParams _pathParams;
+    bool _authenticated = false;
+
+    static const String& none() {
+        static const String empty;
+        return empty;
+    }
+
+private:
+    bool mentionsMsgPack(const char* name) const {
+        if (!hasHeader(name)) return false;
+        const char* value = header(name).c_str();
+        return strstr(value, "application/msgpack") || strstr(value, "application/x-msgpack");
+    }
+};
@@ -1,65 +1,132 @@
 #pragma once
 #include <Arduino.h>
-#include <ESPAsyncWebServer.h>
+#include "HttpRequest.h"
 #include <ArduinoJson.h>
+#include "JsonWriter.h"
+#include "JsonPool.h"
+#include "HttpError.h"
 
+// Move-only: JSON payloads are owned, never copied on the way to the client
 class HttpSuccess {
 public:
     // Constructors for different input types
-    HttpSuccess(const String& message, AsyncWebServerResponse* response = nullptr)
-        : _type(Type::STRING), _stringValue(message), _response(response) {}
+    HttpSuccess(const String& message)
+        : _type(Type::STRING), _stringValue(message) {}
 
-    HttpSuccess(bool message, AsyncWebServerResponse* response = nullptr)
-        : _type(Type::BOOL), _boolValue(message), _response(response) {}
+    HttpSuccess(bool message)
+        : _type(Type::BOOL), _boolValue(message) {}
 
-    HttpSuccess(const DynamicJsonDocument& doc, AsyncWebServerResponse* response = nullptr)
-        : _type(Type::JSON), _jsonDoc(new DynamicJsonDocument(doc)), _response(response) {}
+    // Takes a document from JsonPool (preferred)
+    HttpSuccess(PooledJson&& doc)
+        : _type(Type::JSON), _pooledDoc(std::move(doc)) {}
 
-    // Copy constructor (deep copy for JSON)
-    HttpSuccess(const HttpSuccess& other)
+    // Takes over a heap document, e.g. one returned by a manager; its data is moved, not copied
+    HttpSuccess(JsonDocument&& doc)
+        : _type(Type::JSON), _ownedDoc(new JsonDocument(std::move(doc))) {}
+
+    // A complete response (custom status, headers, content type, streamed body), sent as-is
+    HttpSuccess(HttpResponse&& response)
+        : _type(Type::BOOL), _boolValue(true), _response(std::move(response)), _hasResponse(true) {}
+
+    HttpSuccess(HttpSuccess&& other)
         : _type(other._type),
-          _stringValue(other._stringValue),
+          _stringValue(std::move(other._stringValue)),
           _boolValue(other._boolValue),
-          _jsonDoc(other._jsonDoc ? new DynamicJsonDocument(*other._jsonDoc) : nullptr),
-          _response(other._response) {}
+          _pooledDoc(std::move(other._pooledDoc)),
+          _ownedDoc(other._ownedDoc),
+          _response(std::move(other._response)),
+          _hasResponse(other._hasResponse) {
+        other._ownedDoc = nullptr;
+        other._hasResponse = false;
+    }
+
+    HttpSuccess(const HttpSuccess&) = delete;
+    HttpSuccess& operator=(const HttpSuccess&) = delete;
 
     // Destructor
     ~HttpSuccess() {
-        if (_jsonDoc) delete _jsonDoc;
+        if (_ownedDoc) delete _ownedDoc;
     }
 
-    // ✅ Return as JSON document
-    DynamicJsonDocument json() const {
-        DynamicJsonDocument doc(4096);
-        doc["ok"] = true;
+    // ✅ Send as { ok, data }, serialized straight into the response stream.
+    // The payload is written in place; no envelope document or intermediate String.
+    // MessagePack instead of JSON when the client accepts it.
+    // Returns the status code that was sent.
+    int send(HttpRequest* request) {
+        if (_hasResponse) {
+            request->send(_response);
+            return _response.status();
+        }
+
+        const JsonDocument* doc = payload();
+        if (doc && doc->overflowed()) {
+            throw HttpError(500, "Response too large");
+        }
+
+        bool msgpack = request->acceptsMsgPack();
+        size_t payloadSize = 0;
+        switch (_type) {
+            case Type::STRING: payloadSize = _stringValue.length() + 8; break;
+            case Type::BOOL:   payloadSize = 5; break;
+            case Type::JSON:   payloadSize = doc ? (msgpack ? measureMsgPack(*doc) : measureJson(*doc)) : 4; break;
+        }
+
+        // Sized up front so the stream buffer never has to grow
+        HttpResponse response(200, msgpack ? "application/msgpack" : "application/json");
+        response.stream(payloadSize + 20, [this, msgpack](Print& out) {
+            if (msgpack) printMsgPack(out);
+            else printEnvelope(out);
+        });
+        request->send(response);
+        return 200;
+    }
+
+    bool hasResponse() const { return _hasResponse; }
+
+private:
+    const JsonDocument* payload() const {
+        if (_pooledDoc) return &*_pooledDoc;
+        return _ownedDoc;
+    }
+
+    void printEnvelope(Print& out) const {
+        out.print("{\"ok\":true,\"data\":");
         switch (_type) {
             case Type::STRING:
-                doc["data"] = _stringValue;
+                printJsonString(out, _stringValue.c_str());
                 break;
             case Type::BOOL:
-                doc["data"] = _boolValue;
+                out.print(_boolValue ? "true" : "false");
                 break;
             case Type::JSON:
-                if (_jsonDoc) doc["data"] = *_jsonDoc;
+                if (payload()) serializeJson(*payload(), out);
+                else out.print("null");
                 break;
         }
-        return doc;
+        out.print("}");
     }
 
-    // ✅ Return as serialized JSON string
-    String output() const {
-        DynamicJsonDocument doc = json();
-        String output;
-        serializeJson(doc, output);
-        return output;
+    void printMsgPack(Print& out) const {
+        printMsgPackEnvelope(out, true, "data");
+        switch (_type) {
+            case Type::STRING:
+                printMsgPackString(out, _stringValue.c_str(), _stringValue.length());
+                break;
+            case Type::BOOL:
+                out.write((uint8_t)(_boolValue ? 0xc3 : 0xc2));
+                break;
+            case Type::JSON:
+                if (payload()) serializeMsgPack(*payload(), out);
+                else out.write((uint8_t)0xc0);
+                break;
+        }
     }
 
-    AsyncWebServerResponse* response() const { return _response; }
-
-private:
     enum class Type { STRING, BOOL, JSON } _type;
     String _stringValue;
     bool _boolValue = false;
-    DynamicJsonDocument* _jsonDoc = nullptr;
-    AsyncWebServerResponse* _response = nullptr;
+    PooledJson _pooledDoc;
+    JsonDocument* _ownedDoc = nullptr;
+    HttpResponse _response;
+    bool _hasResponse = false;
 };
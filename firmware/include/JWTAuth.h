@@ -4,12 +4,16 @@
 #include <mbedtls/md.h> // Include mbedTLS for HMAC-SHA256
 #include "ConfigManager.h" // Include ConfigManager for secret key
 
+// Recently validated tokens; override with -D JWT_CACHE_SLOTS=...
+#ifndef JWT_CACHE_SLOTS
+#define JWT_CACHE_SLOTS 8
+#endif
+
 class JWTAuth {
 public:
     // Create a JWT token (access or refresh)
     static String createToken(const JsonObject& payload) {
-        String secretKey = ConfigManager::getInstance().get("jwt")["secret"] | "";
-        if (secretKey.isEmpty()) return "";
+        if (!keyReady()) return "";
 
         // Header
         DynamicJsonDocument headerDoc(256);
@@ -23,38 +27,85 @@ public:
         serializeJson(payload, payloadStr);
 
         // Encode header and payload
-        String encodedHeader = base64::encode(header);
-        String encodedPayload = base64::encode(payloadStr);
+        String signingInput = base64::encode(header) + "." + base64::encode(payloadStr);
 
         // Create signature
-        String signature = hmacSha256(encodedHeader + "." + encodedPayload, secretKey);
+        char signature[HEX_SIGNATURE_LENGTH + 1];
+        sign(signingInput.c_str(), signingInput.length(), signature);
 
         // Return the full token
-        return encodedHeader + "." + encodedPayload + "." + signature;
+        return signingInput + "." + signature;
     }
 
-    // Validate a JWT token
+    // Validate a JWT token: signature, then `exp` (required) and `iat` against the
+    // uptime clock the tokens are issued with. Tokens seen before are answered from
+    // the cache with one SHA-256 of the token and no HMAC or payload parsing.
+    // Not thread-safe; called from the web server task only.
     static bool validateToken(const String& token) {
-        String secretKey = ConfigManager::getInstance().get("jwt")["secret"] | "";
-        if (secretKey.isEmpty()) return false;
+        if (!keyReady()) return false;
+
+        const uint32_t now = millis() / 1000;
+        State& s = state();
+
+        uint8_t digest[32];
+        tokenDigest(token, digest);
+        for (CacheEntry& entry : s.cache) {
+            if (!entry.used || !constantTimeEquals(entry.digest, digest, sizeof(digest))) continue;
+            if (now < entry.issuedAt || now >= entry.expiresAt) {
+                entry.used = false;
+                return false;
+            }
+            s.hits++;
+            return true;
+        }
+        s.misses++;
 
         int firstDot = token.indexOf('.');
         int secondDot = token.indexOf('.', firstDot + 1);
 
         if (firstDot == -1 || secondDot == -1) return false;
 
-        // Extract parts
-        String encodedHeader = token.substring(0, firstDot);
-        String encodedPayload = token.substring(firstDot + 1, secondDot);
-        String providedSignature = token.substring(secondDot + 1);
+        // Recreate signature over "<header>.<payload>" without copying it out
+        const char* raw = token.c_str();
+        size_t signatureLength = token.length() - secondDot - 1;
+        if (signatureLength != HEX_SIGNATURE_LENGTH) return false;
+
+        char expected[HEX_SIGNATURE_LENGTH + 1];
+        sign(raw, secondDot, expected);
+        if (!constantTimeEquals(reinterpret_cast<const uint8_t*>(raw + secondDot + 1),
+                                reinterpret_cast<const uint8_t*>(expected), HEX_SIGNATURE_LENGTH)) {
+            return false;
+        }
+
+        // Claims
+        uint8_t payload[MAX_PAYLOAD_LENGTH];
+        size_t payloadLength = base64Decode(raw + firstDot + 1, secondDot - firstDot - 1, payload, sizeof(payload));
+        if (payloadLength == 0) return false;
+
+        DynamicJsonDocument claims(256);
+        if (deserializeJson(claims, payload, payloadLength)) return false;
+        if (!claims["exp"].is<uint32_t>()) return false;
 
-        // Recreate signature
-        String recreatedSignature = hmacSha256(encodedHeader + "." + encodedPayload, secretKey);
+        uint32_t expiresAt = claims["exp"].as<uint32_t>();
+        uint32_t issuedAt = claims["iat"] | 0u;
+        // Tokens from before a reboot are issued "in the future" of the uptime clock
+        if (now < issuedAt || now >= expiresAt) return false;
 
-        // Compare signatures
-        return providedSignature == recreatedSignature;
+        remember(digest, issuedAt, expiresAt);
+        return true;
     };
-    
+
+    // Drop the prepared key and every cached token, e.g. after jwt.secret changed
+    static void resetKey() {
+        State& s = state();
+        if (s.keyReady) mbedtls_md_free(&s.key);
+        s.keyReady = false;
+        for (CacheEntry& entry : s.cache) entry.used = false;
+    }
+
+    static uint32_t cacheHits() { return state().hits; }
+    static uint32_t cacheMisses() { return state().misses; }
+
     // HMAC-SHA256 implementation using mbedTLS
     static String hmacSha256(const String& message, const String& key) {
         unsigned char hash[32];
@@ -68,11 +119,127 @@ public:
         mbedtls_md_hmac_finish(&ctx, hash);
         mbedtls_md_free(&ctx);
 
-        String result;
+        char hex[HEX_SIGNATURE_LENGTH + 1];
+        toHex(hash, hex);
+        return String(hex);
+    }
+
+private:
+    static const size_t HEX_SIGNATURE_LENGTH = 64;
+    static const size_t MAX_PAYLOAD_LENGTH = 192;
+
+    struct CacheEntry {
+        uint8_t digest[32];     // SHA-256 of the whole token
+        uint32_t issuedAt;
+        uint32_t expiresAt;     // uptime seconds
+        bool used;
+    };
+
+    struct State {
+        mbedtls_md_context_t key;   // HMAC context with the secret already absorbed
+        bool keyReady = false;
+        CacheEntry cache[JWT_CACHE_SLOTS] = {};
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    // jwt.secret is read and turned into an HMAC context once, not per request
+    static bool keyReady() {
+        State& s = state();
+        if (s.keyReady) return true;
+
+        String secretKey = ConfigManager::getInstance().get("jwt")["secret"] | "";
+        if (secretKey.isEmpty()) return false;
+
+        mbedtls_md_init(&s.key);
+        if (mbedtls_md_setup(&s.key, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) != 0 ||
+            mbedtls_md_hmac_starts(&s.key, reinterpret_cast<const unsigned char*>(secretKey.c_str()), secretKey.length()) != 0) {
+            mbedtls_md_free(&s.key);
+            return false;
+        }
+        s.keyReady = true;
+        return true;
+    }
+
+    static void sign(const char* message, size_t length, char* hexOut) {
+        State& s = state();
+        unsigned char hash[32];
+        mbedtls_md_hmac_reset(&s.key);
+        mbedtls_md_hmac_update(&s.key, reinterpret_cast<const unsigned char*>(message), length);
+        mbedtls_md_hmac_finish(&s.key, hash);
+        toHex(hash, hexOut);
+    }
+
+    static void tokenDigest(const String& token, uint8_t* digest) {
+        mbedtls_md_context_t ctx;
+        mbedtls_md_init(&ctx);
+        mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+        mbedtls_md_starts(&ctx);
+        mbedtls_md_update(&ctx, reinterpret_cast<const unsigned char*>(token.c_str()), token.length());
+        mbedtls_md_finish(&ctx, digest);
+        mbedtls_md_free(&ctx);
+    }
+
+    // Reuse a free or expired slot, otherwise evict the token that expires first
+    static void remember(const uint8_t* digest, uint32_t issuedAt, uint32_t expiresAt) {
+        State& s = state();
+        const uint32_t now = millis() / 1000;
+        CacheEntry* slot = &s.cache[0];
+        for (CacheEntry& entry : s.cache) {
+            if (!entry.used || now >= entry.expiresAt) { slot = &entry; break; }
+            if (entry.expiresAt < slot->expiresAt) slot = &entry;
+        }
+        memcpy(slot->digest, digest, sizeof(slot->digest));
+        slot->issuedAt = issuedAt;
+        slot->expiresAt = expiresAt;
+        slot->used = true;
+    }
+
+    // Runtime depends only on the length, never on where the first difference is
+    static bool constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t length) {
+        uint8_t diff = 0;
+        for (size_t i = 0; i < length; i++) diff |= a[i] ^ b[i];
+        return diff == 0;
+    }
+
+    static void toHex(const unsigned char* hash, char* out) {
+        static const char digits[] = "0123456789abcdef";
         for (int i = 0; i < 32; i++) {
-            if (hash[i] < 16) result += "0";
-            result += String(hash[i], HEX);
+            out[i * 2] = digits[hash[i] >> 4];
+            out[i * 2 + 1] = digits[hash[i] & 0x0F];
+        }
+        out[HEX_SIGNATURE_LENGTH] = '\0';
+    }
+
+    // Standard alphabet; padding and line breaks are skipped. 0 on bad input or overflow.
+    static size_t base64Decode(const char* in, size_t length, uint8_t* out, size_t capacity) {
+        uint32_t bits = 0;
+        int bitCount = 0;
+        size_t written = 0;
+        for (size_t i = 0; i < length; i++) {
+            char c = in[i];
+            int value;
+            if (c >= 'A' && c <= 'Z') value = c - 'A';
+            else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+            else if (c >= '0' && c <= '9') value = c - '0' + 52;
+            else if (c == '+' || c == '-') value = 62;
+            else if (c == '/' || c == '_') value = 63;
+            else if (c == '=' || c == '\n' || c == '\r') continue;
+            else return 0;
+
+            bits = (bits << 6) | value;
+            bitCount += 6;
+            if (bitCount >= 8) {
+                bitCount -= 8;
+                if (written == capacity) return 0;
+                out[written++] = (bits >> bitCount) & 0xFF;
+            }
         }
-        return result;
+        return written;
     }
 };
@@ -0,0 +1,105 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "HttpRequest.h"
+#include "HttpError.h"
+#include "JsonPool.h"
+
+// Parses a request body into doc: MessagePack when the client sent
+// Content-Type: application/msgpack, JSON otherwise
+inline DeserializationError deserializeBody(JsonDocument& doc, HttpRequest* request,
+                                            const uint8_t* data, size_t len) {
+    return request->sentMsgPack() ? deserializeMsgPack(doc, data, len) : deserializeJson(doc, data, len);
+}
+
+inline DeserializationError deserializeBody(JsonDocument& doc, HttpRequest* request,
+                                            const uint8_t* data, size_t len,
+                                            DeserializationOption::Filter filter) {
+    return request->sentMsgPack() ? deserializeMsgPack(doc, data, len, filter)
+                                  : deserializeJson(doc, data, len, filter);
+}
+
+enum class BodyType : uint8_t { String, Int, Float, Bool };
+
+// One top-level field of a body; maxLength limits strings (0 = no limit)
+struct BodyField {
+    BodyField(const char* name, BodyType type, bool required = false, uint16_t maxLength = 0)
+        : name(name), type(type), required(required), maxLength(maxLength) {}
+
+    const char* name;
+    BodyType type;
+    bool required;
+    uint16_t maxLength;
+};
+
+// Validated body handed to Router::postWithSchema() handlers. Every declared field
+// has its declared type or is absent; accessors return the fallback when absent.
+class ParsedBody {
+public:
+    explicit ParsedBody(PooledJson&& doc) : _doc(std::move(doc)) {}
+
+    bool has(const char* name) const { return !(*_doc)[name].isNull(); }
+    const char* str(const char* name, const char* fallback = "") const { return (*_doc)[name] | fallback; }
+    long integer(const char* name, long fallback = 0) const { return (*_doc)[name] | fallback; }
+    float number(const char* name, float fallback = 0) const { return (*_doc)[name] | fallback; }
+    bool flag(const char* name, bool fallback = false) const { return (*_doc)[name] | fallback; }
+
+private:
+    PooledJson _doc;
+};
+
+// Declared shape of a POST body: its fields and the largest body accepted. Only the
+// declared fields are kept while parsing (DeserializationOption::Filter), so unknown
+// keys cost no pool memory, and the size limit is enforced by the router before a
+// body buffer is taken. Schemas are built once, next to the route.
+class BodySchema {
+public:
+    BodySchema(std::initializer_list<BodyField> fields, size_t maxBody)
+        : _fields(fields), _maxBody(maxBody) {
+        for (const BodyField& field : _fields) _filter[field.name] = true;
+    }
+
+    size_t maxBody() const { return _maxBody; }
+
+    // Parses and validates; throws HttpError 400 naming the first bad field
+    ParsedBody parse(HttpRequest* request, const uint8_t* data, size_t len) const {
+        PooledJson doc = JsonPool::acquire();
+        DeserializationError error = deserializeBody(*doc, request, data, len,
+                                                     DeserializationOption::Filter(_filter));
+        if (error == DeserializationError::NoMemory) throw HttpError(413, "Payload too large");
+        if (error || !doc->is<JsonObject>()) throw HttpError(400, "Invalid JSON body");
+
+        for (const BodyField& field : _fields) {
+            JsonVariantConst value = (*doc)[field.name];
+            if (value.isNull()) {
+                if (field.required) throw HttpError(400, String(field.name) + " is required");
+                continue;
+            }
+            switch (field.type) {
+                case BodyType::String:
+                    if (!value.is<const char*>()) throw HttpError(400, String(field.name) + " must be a string");
+                    if (field.maxLength && strlen(value.as<const char*>()) > field.maxLength)
+                        throw HttpError(400, String(field.name) + " is too long");
+                    break;
+                case BodyType::Int:
+                    if (!value.is<long>()) throw HttpError(400, String(field.name) + " must be an integer");
+                    break;
+                case BodyType::Float:
+                    if (!value.is<float>()) throw HttpError(400, String(field.name) + " must be a number");
+                    break;
+                case BodyType::Bool:
+                    if (!value.is<bool>()) throw HttpError(400, String(field.name) + " must be a boolean");
+                    break;
+            }
+        }
+        return ParsedBody(std::move(doc));
+    }
+
+private:
+    std::vector<BodyField> _fields;
+    size_t _maxBody;
+    JsonDocument _filter;
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <utility>
+#include "HttpError.h"
+
+// Size of the preallocated pool; override with -D JSON_POOL_SLOTS=... / -D JSON_POOL_ARENA_SIZE=...
+#ifndef JSON_POOL_SLOTS
+#define JSON_POOL_SLOTS 4
+#endif
+#ifndef JSON_POOL_ARENA_SIZE
+#define JSON_POOL_ARENA_SIZE 4096
+#endif
+
+// Bump allocator over a fixed region. Frees are no-ops; the whole arena is reset when
+// its document goes back to the pool, so request-scoped JSON never fragments the heap.
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    void attach(uint8_t* memory, size_t size) {
+        _memory = memory;
+        _size = size;
+        reset();
+    }
+
+    void reset() {
+        _used = 0;
+        _last = nullptr;
+    }
+
+    size_t used() const { return _used; }
+    size_t size() const { return _size; }
+
+    void* allocate(size_t size) override {
+        size_t total = HEADER + align(size);
+        if (!_memory || _used + total > _size) return nullptr;
+
+        uint8_t* block = _memory + _used;
+        *reinterpret_cast<size_t*>(block) = size;
+        _used += total;
+        _last = block + HEADER;
+        return _last;
+    }
+
+    void deallocate(void* ptr) override {
+        // Only the most recent block can be given back
+        if (ptr && ptr == _last) {
+            _used = static_cast<uint8_t*>(ptr) - HEADER - _memory;
+            _last = nullptr;
+        }
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (!ptr) return allocate(newSize);
+
+        size_t* sizeField = reinterpret_cast<size_t*>(static_cast<uint8_t*>(ptr) - HEADER);
+        size_t oldSize = *sizeField;
+
+        // Strings grow and shrink at the end of the arena: resize in place
+        if (ptr == _last) {
+            size_t start = static_cast<uint8_t*>(ptr) - _memory;
+            if (start + align(newSize) > _size) return nullptr;
+            *sizeField = newSize;
+            _used = start + align(newSize);
+            return ptr;
+        }
+
+        if (newSize <= oldSize) {
+            *sizeField = newSize;
+            return ptr;
+        }
+
+        void* moved = allocate(newSize);
+        if (moved) memcpy(moved, ptr, oldSize);
+        return moved;
+    }
+
+private:
+    static const size_t HEADER = 8;   // block size, keeps 8-byte alignment
+
+    static size_t align(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+    uint8_t* _memory = nullptr;
+    size_t _size = 0;
+    size_t _used = 0;
+    void* _last = nullptr;
+};
+
+class JsonPool;
+
+// Move-only handle to a pooled document; returns it to the pool when destroyed
+class PooledJson {
+public:
+    PooledJson() {}
+    PooledJson(PooledJson&& other) : _pool(other._pool), _slot(other._slot) {
+        other._slot = -1;
+    }
+    PooledJson& operator=(PooledJson&& other) {
+        if (this != &other) {
+            release();
+            _pool = other._pool;
+            _slot = other._slot;
+            other._slot = -1;
+        }
+        return *this;
+    }
+    PooledJson(const PooledJson&) = delete;
+    PooledJson& operator=(const PooledJson&) = delete;
+    ~PooledJson() { release(); }
+
+    explicit operator bool() const { return _slot >= 0; }
+    JsonDocument& operator*() const;
+    JsonDocument* operator->() const { return &**this; }
+
+    template<typename K>
+    auto operator[](const K& key) const -> decltype(std::declval<JsonDocument&>()[key]) {
+        return (**this)[key];
+    }
+
+private:
+    friend class JsonPool;
+    PooledJson(JsonPool* pool, int slot) : _pool(pool), _slot(slot) {}
+    void release();
+
+    JsonPool* _pool = nullptr;
+    int _slot = -1;
+};
+
+// Fixed set of JSON documents, each backed by its own preallocated arena
+class JsonPool {
+public:
+    static const uint8_t SLOTS = JSON_POOL_SLOTS;
+    static const size_t ARENA_SIZE = JSON_POOL_ARENA_SIZE;
+
+    static JsonPool& instance() {
+        static JsonPool pool;
+        return pool;
+    }
+
+    // Allocates all arenas in one block; called once at boot before the heap fragments
+    bool begin() {
+        if (_memory) return true;
+        _memory = static_cast<uint8_t*>(malloc(SLOTS * ARENA_SIZE));
+        if (!_memory) return false;
+        for (uint8_t i = 0; i < SLOTS; i++) {
+            _slots[i].arena.attach(_memory + i * ARENA_SIZE, ARENA_SIZE);
+        }
+        return true;
+    }
+
+    // Throws HttpError(503) when every document is in use
+    static PooledJson acquire() {
+        JsonPool& pool = instance();
+        if (!pool._memory) pool.begin();
+
+        for (uint8_t i = 0; i < SLOTS; i++) {
+            bool expected = false;
+            if (pool._slots[i].inUse.compare_exchange_strong(expected, true)) {
+                uint8_t inUse = ++pool._inUse;
+                if (inUse > pool._peakInUse) pool._peakInUse = inUse;
+                return PooledJson(&pool, i);
+            }
+        }
+        pool._exhausted++;
+        throw HttpError(503, "Server busy, try again");
+    }
+
+    // Stats
+    uint8_t available() const { return SLOTS - _inUse; }
+    uint8_t peakInUse() const { return _peakInUse; }
+    uint32_t exhausted() const { return _exhausted; }
+    size_t peakArenaBytes() const { return _peakArenaBytes; }
+
+private:
+    friend class PooledJson;
+
+    struct Slot {
+        JsonArena arena;
+        JsonDocument doc;
+        std::atomic<bool> inUse;
+        Slot() : doc(&arena), inUse(false) {}
+    };
+
+    JsonPool() {}
+
+    JsonDocument& document(int slot) { return _slots[slot].doc; }
+
+    void release(int slot) {
+        Slot& s = _slots[slot];
+        if (s.arena.used() > _peakArenaBytes) _peakArenaBytes = s.arena.used();
+        s.doc.clear();
+        s.arena.reset();
+        _inUse--;
+        s.inUse.store(false);
+    }
+
+    uint8_t* _memory = nullptr;
+    Slot _slots[SLOTS];
+    std::atomic<uint8_t> _inUse{0};
+    volatile uint8_t _peakInUse = 0;
+    volatile uint32_t _exhausted = 0;
+    volatile size_t _peakArenaBytes = 0;
+};
+
+inline JsonDocument& PooledJson::operator*() const {
+    return _pool->document(_slot);
+}
+
+inline void PooledJson::release() {
+    if (_slot >= 0) {
+        _pool->release(_slot);
+        _slot = -1;
+    }
+}
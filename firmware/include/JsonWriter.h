@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+
+// Writes `value` as a quoted, escaped JSON string straight to `out`, so envelopes can be
+// streamed around a payload without building a document for them.
+inline void printJsonString(Print& out, const char* value) {
+    out.write('"');
+    for (const char* p = value; *p; p++) {
+        char c = *p;
+        switch (c) {
+            case '"':  out.print("\\\""); break;
+            case '\\': out.print("\\\\"); break;
+            case '\n': out.print("\\n"); break;
+            case '\r': out.print("\\r"); break;
+            case '\t': out.print("\\t"); break;
+            default:
+                if ((uint8_t)c < 0x20) {
+                    char escaped[7];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out.print(escaped);
+                } else {
+                    out.write((uint8_t)c);
+                }
+        }
+    }
+    out.write('"');
+}
+
+// Writes `value` as a MessagePack string (str header + bytes), the counterpart of
+// printJsonString for binary envelopes.
+inline void printMsgPackString(Print& out, const char* value, size_t length) {
+    if (length < 32) {
+        out.write((uint8_t)(0xa0 | length));
+    } else if (length < 0x100) {
+        out.write((uint8_t)0xd9);
+        out.write((uint8_t)length);
+    } else if (length < 0x10000) {
+        out.write((uint8_t)0xda);
+        out.write((uint8_t)(length >> 8));
+        out.write((uint8_t)length);
+    } else {
+        out.write((uint8_t)0xdb);
+        for (int shift = 24; shift >= 0; shift -= 8) out.write((uint8_t)(length >> shift));
+    }
+    out.write(reinterpret_cast<const uint8_t*>(value), length);
+}
+
+// Start of a MessagePack { ok, <key> } envelope; the value of <key> follows
+inline void printMsgPackEnvelope(Print& out, bool ok, const char* key) {
+    out.write((uint8_t)0x82);                      // map with 2 entries
+    printMsgPackString(out, "ok", 2);
+    out.write((uint8_t)(ok ? 0xc3 : 0xc2));
+    printMsgPackString(out, key, strlen(key));
+}
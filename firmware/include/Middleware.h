@@ -1,10 +1,15 @@
 #pragma once
 #include <Arduino.h>
 #include <functional>
-#include <ESPAsyncWebServer.h>
+#include "HttpRequest.h"
 
 class Middleware {
 public:
     Middleware() = default;
-    virtual void handle(AsyncWebServerRequest* request, std::function<void()> next) = 0;
+    virtual ~Middleware() {}
+    virtual void handle(HttpRequest* request, std::function<void()> next) = 0;
+
+    // Called once the response of a routed request was sent, including errors and
+    // rejections that happened before this middleware ran. `route` is the route path.
+    virtual void onResponse(HttpRequest* request, const char* route, int status) {}
 };
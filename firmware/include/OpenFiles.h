@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Counts LittleFS files that stay open after their handler returned: downloads and
+// static assets being sent, uploads being written. A filesystem update unmounts the
+// partition and must not do so under any of them.
+class OpenFiles {
+public:
+    // Held next to the File; every copy counts, so it can be captured by a filler
+    struct Use {
+        Use() { count()++; }
+        Use(const Use&) { count()++; }
+        Use& operator=(const Use&) = default;
+        ~Use() { count()--; }
+    };
+
+    static uint32_t inUse() { return count().load(); }
+
+private:
+    static std::atomic<uint32_t>& count() {
+        static std::atomic<uint32_t> n{0};
+        return n;
+    }
+};
@@ -2,10 +2,11 @@
 #include <Arduino.h>
 #include <functional>
 #include <vector>
-#include <ESPAsyncWebServer.h>
+#include "HttpRequest.h"
 #include "Middleware.h"
 #include "Guard.h"
 #include "HttpSuccess.h"
+#include "JsonBody.h"
 #include "DependencyContainer.h"
 
 class Router {
@@ -18,12 +19,28 @@ public:
         if (setup) setup(this);
     }
 
+    using Handler = std::function<HttpSuccess(HttpRequest*)>;
+    // Whole body, NUL-terminated for convenience
+    using BodyHandler = std::function<HttpSuccess(HttpRequest*, const uint8_t* data, size_t len)>;
+    // One chunk of a streamed body, in order; throw HttpError to reject the upload
+    using ChunkHandler = std::function<void(HttpRequest*, const uint8_t* data, size_t len, size_t index, size_t total)>;
+    // Body already parsed and checked against the route's BodySchema
+    using SchemaHandler = std::function<HttpSuccess(HttpRequest*, const ParsedBody& body)>;
+
+    // Default body limit for postWithBody routes
+    static const size_t DEFAULT_MAX_BODY = 1024;
+
     // Route structure
     struct Route {
         String path;
-        std::function<HttpSuccess(AsyncWebServerRequest*)> handler;
-        std::function<HttpSuccess(AsyncWebServerRequest*, const uint8_t*)> bodyHandler;
+        Handler handler;            // plain routes; completion handler of streamed routes
+        BodyHandler bodyHandler;
+        ChunkHandler chunkHandler;
         std::vector<Guard*> guards;
+        size_t maxBodySize;         // 0 = unlimited (streamed routes only)
+        uint32_t cacheTtlMs;        // 0 = responses are not cached
+        std::vector<String> cacheKeys;   // config keys the cached response depends on
+        bool fillsBody;             // answers with HttpResponse::fill() (see fills())
     };
 
     // --- Dependency Injection Support ---
@@ -39,24 +56,78 @@ public:
     // --- Endpoint Registration ---
 
     void get(const String& endpoint,
-             std::function<HttpSuccess(AsyncWebServerRequest*)> handler,
+             Handler handler,
              std::vector<Guard*> guards = {}) 
     {
-        _getEndpoints.push_back({_basePath + endpoint, handler, nullptr, guards});
+        _getEndpoints.push_back({_basePath + endpoint, handler, nullptr, nullptr, guards, 0});
     }
 
     void post(const String& endpoint,
-              std::function<HttpSuccess(AsyncWebServerRequest*)> handler,
+              Handler handler,
               std::vector<Guard*> guards = {}) 
     {
-        _postEndpoints.push_back({_basePath + endpoint, handler, nullptr, guards});
+        _postEndpoints.push_back({_basePath + endpoint, handler, nullptr, nullptr, guards, 0});
+    }
+
+    void del(const String& endpoint,
+             Handler handler,
+             std::vector<Guard*> guards = {})
+    {
+        _deleteEndpoints.push_back({_basePath + endpoint, handler, nullptr, nullptr, guards, 0});
     }
 
+    // Body is accumulated into a pooled buffer; larger than maxBodySize -> 413
     void postWithBody(const String& endpoint,
-                      std::function<HttpSuccess(AsyncWebServerRequest*, const uint8_t*)> bodyHandler,
-                      std::vector<Guard*> guards = {}) 
+                      BodyHandler bodyHandler,
+                      std::vector<Guard*> guards = {},
+                      size_t maxBodySize = DEFAULT_MAX_BODY) 
+    {
+        _postEndpoints.push_back({_basePath + endpoint, nullptr, bodyHandler, nullptr, guards, maxBodySize});
+    }
+
+    // Body is parsed with only the schema's fields kept and validated before the
+    // handler runs; the schema's maxBody is the route's body limit
+    void postWithSchema(const String& endpoint,
+                        const BodySchema& schema,
+                        SchemaHandler handler,
+                        std::vector<Guard*> guards = {})
     {
-        _postEndpoints.push_back({_basePath + endpoint, nullptr, bodyHandler, guards});
+        postWithBody(endpoint, [schema, handler](HttpRequest* request, const uint8_t* data, size_t len) {
+            return handler(request, schema.parse(request, data, len));
+        }, guards, schema.maxBody());
+    }
+
+    // Body is handed to chunkHandler as it arrives and never buffered whole;
+    // onComplete sends the response once the last chunk was accepted
+    void postStream(const String& endpoint,
+                    ChunkHandler chunkHandler,
+                    Handler onComplete,
+                    std::vector<Guard*> guards = {},
+                    size_t maxBodySize = 0)
+    {
+        _postEndpoints.push_back({_basePath + endpoint, onComplete, nullptr, chunkHandler, guards, maxBodySize});
+    }
+
+    // Caches 200 responses of an already registered GET route for ttlMs, per path,
+    // query parameters the handler reads, client token and encoding, with an ETag.
+    // config->set() of one of configKeys (or a parent/child key) drops the entries
+    // early. Only for routes whose answer depends on nothing else (no other headers).
+    void cache(const String& endpoint, uint32_t ttlMs, std::vector<String> configKeys = {}) {
+        for (Route& route : _getEndpoints) {
+            if (route.path == _basePath + endpoint) {
+                route.cacheTtlMs = ttlMs;
+                route.cacheKeys = configKeys;
+            }
+        }
+    }
+
+    // Marks an already registered GET route whose answer is pulled with
+    // HttpResponse::fill() (downloads, long-polls). Such a body only exists while
+    // the client reads it, so /batch refuses the route instead of collecting it.
+    void fills(const String& endpoint) {
+        for (Route& route : _getEndpoints) {
+            if (route.path == _basePath + endpoint) route.fillsBody = true;
+        }
     }
 
     // --- Guards ---
@@ -65,15 +136,17 @@ public:
     }
 
     // --- Accessors ---
-    std::vector<Route> getEndpoints() const { return _getEndpoints; }
-    std::vector<Route> postEndpoints() const { return _postEndpoints; }
-    std::vector<Guard*> routerGuards() const { return _routerGuards; }
-    String basePath() const { return _basePath; }
+    const std::vector<Route>& getEndpoints() const { return _getEndpoints; }
+    const std::vector<Route>& postEndpoints() const { return _postEndpoints; }
+    const std::vector<Route>& deleteEndpoints() const { return _deleteEndpoints; }
+    const std::vector<Guard*>& routerGuards() const { return _routerGuards; }
+    const String& basePath() const { return _basePath; }
 
 private:
     String _basePath;
     std::vector<Route> _getEndpoints;
     std::vector<Route> _postEndpoints;
+    std::vector<Route> _deleteEndpoints;
     std::vector<Guard*> _routerGuards;
     DependencyContainer* _deps;   // ✅ added dependency container pointer
 };
@@ -0,0 +1,165 @@
+#pragma once
+#include <Arduino.h>
+#include <utility>
+#include <vector>
+#include "HttpRequest.h"
+
+// Bytes of a response body kept by SyntheticRequest; the rest is counted, not stored
+#ifndef SYNTHETIC_MAX_BODY
+#define SYNTHETIC_MAX_BODY 4096
+#endif
+
+// A request that did not come from the network: built in code, dispatched with
+// ServerManager::handle() through the same middleware, guards and handlers, and
+// answered into memory. Used by POST /batch for its entries and by the
+// `server bench` command.
+class SyntheticRequest : public HttpRequest {
+public:
+    // target is a path with an optional query string, e.g. "/jobs?id=3"
+    SyntheticRequest(HttpMethod method, const String& target) : _method(method) {
+        int query = target.indexOf('?');
+        _url = query < 0 ? target : target.substring(0, query);
+        if (query >= 0) parseQuery(target.c_str() + query + 1);
+    }
+
+    SyntheticRequest& withHeader(const String& name, const String& value) {
+        _headers.emplace_back(name, value);
+        return *this;
+    }
+
+    // Marks the request as coming from an already authenticated client
+    SyntheticRequest& withAuthentication() {
+        _authenticated = true;
+        return *this;
+    }
+
+    HttpMethod method() const override { return _method; }
+    const String& url() const override { return _url; }
+    bool hasParam(const char* name) const override { return find(_params, name) != nullptr; }
+    const String& param(const char* name) const override {
+        const String* value = find(_params, name);
+        return value ? *value : none();
+    }
+    bool hasHeader(const char* name) const override { return find(_headers, name, true) != nullptr; }
+    const String& header(const char* name) const override {
+        const String* value = find(_headers, name, true);
+        return value ? *value : none();
+    }
+    const void* id() const override { return this; }
+    bool canWait() const override { return false; }   // may run on the web server task
+
+    void send(HttpResponse& response) override {
+        _status = response.status();
+        _contentType = response.contentType();
+        _responseHeaders = response.headers();
+        _body = "";
+        _bodyLength = 0;
+
+        switch (response.body()) {
+            case HttpResponse::Body::Empty:
+                break;
+            case HttpResponse::Body::Text:
+                append(reinterpret_cast<const uint8_t*>(response.text().c_str()), response.text().length());
+                break;
+            case HttpResponse::Body::Stream: {
+                BodyPrint out(*this);
+                response.writer()(out);
+                break;
+            }
+            case HttpResponse::Body::Fill: {
+                uint8_t buffer[256];
+                for (size_t index = 0; index < response.length(); ) {
+                    // Not waited for: the caller may be the web server task
+                    size_t written = response.filler()(buffer, sizeof(buffer), index);
+                    if (written == 0 || written == HttpResponse::FILL_LATER) break;
+                    append(buffer, written);
+                    index += written;
+                }
+                break;
+            }
+        }
+    }
+
+    // Response, once a handler answered
+    bool answered() const { return _status != 0; }
+    int status() const { return _status; }
+    const char* contentType() const { return _contentType; }
+    const String& body() const { return _body; }             // first SYNTHETIC_MAX_BODY bytes
+    size_t bodyLength() const { return _bodyLength; }
+    const String& responseHeader(const char* name) const {
+        const String* value = find(_responseHeaders, name, true);
+        return value ? *value : none();
+    }
+
+    // Forget the response, so the same request can be dispatched again
+    void reset() {
+        _status = 0;
+        _contentType = "";
+        _body = "";
+        _bodyLength = 0;
+        _responseHeaders.clear();
+    }
+
+private:
+    using Pairs = std::vector<std::pair<String, String>>;
+
+    class BodyPrint : public Print {
+    public:
+        explicit BodyPrint(SyntheticRequest& request) : _request(request) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size) override {
+            _request.append(buffer, size);
+            return size;
+        }
+    private:
+        SyntheticRequest& _request;
+    };
+
+    HttpMethod _method;
+    String _url;
+    Pairs _params;
+    Pairs _headers;
+
+    int _status = 0;
+    const char* _contentType = "";
+    String _body;
+    size_t _bodyLength = 0;
+    Pairs _responseHeaders;
+
+    void append(const uint8_t* data, size_t length) {
+        _bodyLength += length;
+        size_t room = _body.length() < SYNTHETIC_MAX_BODY ? SYNTHETIC_MAX_BODY - _body.length() : 0;
+        if (length > room) length = room;
+        _body.concat(reinterpret_cast<const char*>(data), length);
+    }
+
+    static const String* find(const Pairs& pairs, const char* name, bool ignoreCase = false) {
+        for (const auto& pair : pairs) {
+            if (ignoreCase ? pair.first.equalsIgnoreCase(name) : pair.first == name) return &pair.second;
+        }
+        return nullptr;
+    }
+
+    // name=value&name2=value2, with %XX and '+' decoded
+    void parseQuery(const char* query) {
+        String name, value;
+        String* current = &name;
+        for (const char* p = query; ; p++) {
+            if (*p == '&' || *p == '\0') {
+                if (name.length()) _params.emplace_back(name, value);
+                name = "";
+                value = "";
+                current = &name;
+                if (*p == '\0') break;
+            } else if (*p == '=' && current == &name) {
+                current = &value;
+            } else if (*p == '%' && isxdigit((unsigned char)p[1]) && isxdigit((unsigned char)p[2])) {
+                char hex[3] = { p[1], p[2], '\0' };
+                *current += (char)strtol(hex, nullptr, 16);
+                p += 2;
+            } else {
+                *current += *p == '+' ? ' ' : *p;
+            }
+        }
+    }
+};
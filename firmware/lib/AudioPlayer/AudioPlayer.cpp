@@ -0,0 +1,371 @@
+#include "AudioPlayer.h"
+
+// DMA ring: 4 x 256 frames, i.e. 64 ms at 16 kHz of audio the decoder can fall behind by
+static const int DMA_BUF_COUNT = 4;
+static const int DMA_BUF_LEN = 256;
+
+// IMA ADPCM tables
+static const int16_t ADPCM_STEPS[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+static const int8_t ADPCM_INDEX[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+
+AudioPlayer::AudioPlayer(int pinBCLK, int pinLRCLK, int pinDOUT, i2s_port_t i2sPort)
+    : _pinBCLK(pinBCLK),
+      _pinLRCLK(pinLRCLK),
+      _pinDOUT(pinDOUT),
+      _i2sPort(i2sPort) {}
+
+bool AudioPlayer::begin() {
+    if (_installed) return true;
+
+    i2s_config_t config = {
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
+        .sample_rate = 16000,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+        .intr_alloc_flags = 0,
+        .dma_buf_count = DMA_BUF_COUNT,
+        .dma_buf_len = DMA_BUF_LEN,
+        .use_apll = false,
+        .tx_desc_auto_clear = true   // output silence instead of repeating stale DMA on underrun
+    };
+
+    i2s_pin_config_t pins = {
+        .bck_io_num = _pinBCLK,
+        .ws_io_num = _pinLRCLK,
+        .data_out_num = _pinDOUT,
+        .data_in_num = I2S_PIN_NO_CHANGE
+    };
+
+    if (i2s_driver_install(_i2sPort, &config, 0, NULL) != ESP_OK)
+        return false;
+
+    if (i2s_set_pin(_i2sPort, &pins) != ESP_OK)
+        return false;
+
+    i2s_zero_dma_buffer(_i2sPort);
+    _installed = true;
+    return true;
+}
+
+void AudioPlayer::setVolume(uint8_t volume) {
+    if (volume > 100) volume = 100;
+    _volume = volume;
+    _gain = (uint16_t)volume * 256 / 100;
+}
+
+bool AudioPlayer::play(const String& filename) {
+    if (!_installed) {
+        return false;
+    }
+    
+    uint32_t requestedMicros = micros();
+    
+    Track track;
+    track.file = LittleFS.open(filename, "r");
+    if (!track.file) {
+        return false;
+    }
+    
+    if (!parseHeader(track)) {
+        track.file.close();
+        return false;
+    }
+    track.filename = filename;
+    
+    // A new file replaces whatever is playing: the running task switches to it at its
+    // next refill. A file queued before and not started yet comes back in `track`.
+    bool handedOver = false;
+    portENTER_CRITICAL(&_mux);
+    if (_playbackTaskHandle) {
+        std::swap(_next, track);
+        _hasNext = true;
+        _isPlaying = true;
+        _playRequestedMicros = requestedMicros;
+        handedOver = true;
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (handedOver) {
+        if (track.file) track.file.close();
+        return true;
+    }
+    
+    _track = std::move(track);
+    _stopRequested = false;
+    startTrack(requestedMicros);
+    
+    // Core 0 next to WiFi, above idle work but below the network stack; the task
+    // spends most of its time blocked on DMA space, so render and server keep running
+    if (xTaskCreatePinnedToCore(
+            playbackTask,
+            "PlaybackTask",
+            4096,
+            this,
+            2,
+            &_playbackTaskHandle,
+            0) != pdPASS) {
+        _isPlaying = false;
+        _track.file.close();
+        return false;
+    }
+    
+    return true;
+}
+
+// Only raises a flag: the task sees it at its next refill (one DMA write, at most
+// 200 ms), closes its file and silences the output itself
+bool AudioPlayer::stop() {
+    portENTER_CRITICAL(&_mux);
+    bool running = _playbackTaskHandle != nullptr;
+    if (running) {
+        _stopRequested = true;
+        _hasNext = false;
+        _isPlaying = false;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return running;
+}
+
+void AudioPlayer::startTrack(uint32_t requestedMicros) {
+    _playRequestedMicros = requestedMicros;
+    _samplesPlayed = 0;
+    _startLatencyMicros = 0;
+    _underruns = 0;
+    _adpcmPendingCount = 0;
+    _adpcmPendingPos = 0;
+    
+    i2s_set_clk(_i2sPort, _track.sampleRate, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_MONO);
+    _isPlaying = true;
+}
+
+bool AudioPlayer::parseHeader(Track& track) {
+    uint8_t riff[12];
+    if (track.file.read(riff, 12) != 12 || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    
+    bool haveFormat = false;
+    uint16_t formatTag = 0;
+    uint16_t bitsPerSample = 0;
+    
+    // Walk the chunks; "fmt " must come before "data"
+    while (track.file.available() >= 8) {
+        uint8_t chunk[8];
+        track.file.read(chunk, 8);
+        uint32_t chunkSize;
+        memcpy(&chunkSize, chunk + 4, 4);
+        uint32_t chunkStart = track.file.position();
+        
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[20] = {0};
+            track.file.read(fmt, chunkSize < sizeof(fmt) ? chunkSize : sizeof(fmt));
+            memcpy(&formatTag, fmt, 2);
+            memcpy(&track.channels, fmt + 2, 2);
+            memcpy(&track.sampleRate, fmt + 4, 4);
+            memcpy(&track.blockAlign, fmt + 12, 2);
+            memcpy(&bitsPerSample, fmt + 14, 2);
+            if (chunkSize >= 20) memcpy(&track.adpcmSamplesPerBlock, fmt + 18, 2);
+            haveFormat = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) return false;
+            track.dataStart = chunkStart;
+            track.dataEnd = chunkStart + chunkSize;
+            if (track.dataEnd > track.file.size()) track.dataEnd = track.file.size();   // header never finalized
+            break;
+        }
+        
+        track.file.seek(chunkStart + chunkSize + (chunkSize & 1));
+    }
+    
+    if (!track.dataStart || track.sampleRate == 0) return false;
+    uint32_t dataSize = track.dataEnd - track.dataStart;
+    
+    if (formatTag == 1 && bitsPerSample == 16 && (track.channels == 1 || track.channels == 2)) {
+        track.format = Format::PCM16;
+        track.totalSamples = dataSize / (2 * track.channels);
+    }
+    else if (formatTag == 0x11 && bitsPerSample == 4 && track.channels == 1 &&
+             track.blockAlign > 4 && track.blockAlign <= MAX_ADPCM_BLOCK) {
+        track.format = Format::IMA_ADPCM;
+        uint16_t maxPerBlock = (track.blockAlign - 4) * 2 + 1;
+        if (track.adpcmSamplesPerBlock == 0 || track.adpcmSamplesPerBlock > maxPerBlock) {
+            track.adpcmSamplesPerBlock = maxPerBlock;
+        }
+        uint32_t tail = dataSize % track.blockAlign;
+        track.totalSamples = (dataSize / track.blockAlign) * track.adpcmSamplesPerBlock + (tail > 4 ? (tail - 4) * 2 + 1 : 0);
+    }
+    else {
+        return false;
+    }
+    
+    track.file.seek(track.dataStart);
+    return true;
+}
+
+size_t AudioPlayer::decode(int16_t* out, size_t maxSamples) {
+    size_t count = _track.format == Format::PCM16 ? decodePCM(out, maxSamples) : decodeADPCM(out, maxSamples);
+    if (count > 0) applyGain(out, count);
+    return count;
+}
+
+size_t AudioPlayer::decodePCM(int16_t* out, size_t maxSamples) {
+    size_t frames = maxSamples / _track.channels;
+    size_t remaining = _track.dataEnd - _track.file.position();
+    size_t bytes = frames * _track.channels * sizeof(int16_t);
+    if (bytes > remaining) bytes = remaining;
+    
+    bytes = _track.file.read((uint8_t*)out, bytes);
+    frames = bytes / (_track.channels * sizeof(int16_t));
+    
+    // Downmix stereo in place; the output is mono
+    if (_track.channels == 2) {
+        for (size_t i = 0; i < frames; i++) {
+            out[i] = (int16_t)(((int32_t)out[2 * i] + out[2 * i + 1]) / 2);
+        }
+    }
+    return frames;
+}
+
+size_t AudioPlayer::decodeADPCM(int16_t* out, size_t maxSamples) {
+    size_t produced = 0;
+    
+    while (produced < maxSamples) {
+        if (_adpcmPendingPos >= _adpcmPendingCount) {
+            size_t remaining = _track.dataEnd - _track.file.position();
+            size_t length = remaining < _track.blockAlign ? remaining : _track.blockAlign;
+            if (length <= 4) break;
+            
+            length = _track.file.read(_adpcmBlock, length);
+            _adpcmPendingCount = decodeADPCMBlock(_adpcmBlock, length, _adpcmPending);
+            _adpcmPendingPos = 0;
+            if (_adpcmPendingCount == 0) break;
+        }
+        
+        size_t take = _adpcmPendingCount - _adpcmPendingPos;
+        if (take > maxSamples - produced) take = maxSamples - produced;
+        memcpy(out + produced, _adpcmPending + _adpcmPendingPos, take * sizeof(int16_t));
+        _adpcmPendingPos += take;
+        produced += take;
+    }
+    
+    return produced;
+}
+
+size_t AudioPlayer::decodeADPCMBlock(const uint8_t* block, size_t length, int16_t* out) {
+    if (length <= 4) return 0;
+    
+    // Block header: initial predictor (int16 LE), step index, reserved
+    int32_t predictor = (int16_t)(block[0] | (block[1] << 8));
+    int index = block[2];
+    if (index > 88) index = 88;
+    
+    size_t count = 0;
+    out[count++] = (int16_t)predictor;
+    
+    for (size_t i = 4; i < length && count < _track.adpcmSamplesPerBlock; i++) {
+        // Low nibble first
+        for (uint8_t shift = 0; shift <= 4 && count < _track.adpcmSamplesPerBlock; shift += 4) {
+            uint8_t nibble = (block[i] >> shift) & 0x0F;
+            int32_t step = ADPCM_STEPS[index];
+            
+            int32_t diff = step >> 3;
+            if (nibble & 4) diff += step;
+            if (nibble & 2) diff += step >> 1;
+            if (nibble & 1) diff += step >> 2;
+            predictor += (nibble & 8) ? -diff : diff;
+            
+            if (predictor > 32767) predictor = 32767;
+            else if (predictor < -32768) predictor = -32768;
+            
+            index += ADPCM_INDEX[nibble];
+            if (index < 0) index = 0;
+            else if (index > 88) index = 88;
+            
+            out[count++] = (int16_t)predictor;
+        }
+    }
+    
+    return count;
+}
+
+void AudioPlayer::applyGain(int16_t* samples, size_t count) {
+    uint16_t gain = _gain;
+    if (gain == 256) return;
+    
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = (int16_t)(((int32_t)samples[i] * gain) >> 8);
+    }
+}
+
+void AudioPlayer::playbackTask(void* parameter) {
+    AudioPlayer* instance = static_cast<AudioPlayer*>(parameter);
+    instance->playbackLoop();
+    vTaskDelete(NULL);
+}
+
+// Plays tracks until one ends or stop() is called with nothing queued behind it
+void AudioPlayer::playbackLoop() {
+    for (;;) {
+        playTrack();
+        _track.file.close();
+        
+        Track next;
+        portENTER_CRITICAL(&_mux);
+        bool more = _hasNext;
+        std::swap(next, _next);
+        _hasNext = false;
+        _stopRequested = false;
+        if (!more) {
+            _isPlaying = false;
+            _playbackTaskHandle = nullptr;
+        }
+        portEXIT_CRITICAL(&_mux);
+        
+        if (!more) {
+            if (next.file) next.file.close();   // queued, then cancelled by stop()
+            return;
+        }
+        _track = std::move(next);
+        startTrack(_playRequestedMicros);
+    }
+}
+
+void AudioPlayer::playTrack() {
+    // How much audio the DMA ring holds; decoding slower than this means an audible gap
+    uint32_t bufferedMicros = (uint64_t)DMA_BUF_COUNT * DMA_BUF_LEN * 1000000ULL / _track.sampleRate;
+    
+    // Ping-pong: the next refill is decoded while DMA plays out the previous one
+    uint8_t current = 0;
+    size_t count = decode(_buffers[current], BUFFER_SAMPLES);
+    
+    while (!_stopRequested && !_hasNext && count > 0) {
+        size_t bytesWritten = 0;
+        i2s_write(_i2sPort, _buffers[current], count * sizeof(int16_t), &bytesWritten, pdMS_TO_TICKS(200));
+        
+        if (_startLatencyMicros == 0) {
+            _startLatencyMicros = micros() - _playRequestedMicros;
+        }
+        _samplesPlayed += bytesWritten / sizeof(int16_t);
+        
+        current ^= 1;
+        uint32_t decodeStart = micros();
+        count = decode(_buffers[current], BUFFER_SAMPLES);
+        if (micros() - decodeStart > bufferedMicros) {
+            _underruns++;
+        }
+    }
+    
+    // Let the tail of a finished file play out, then silence the output
+    if (!_stopRequested && !_hasNext) {
+        vTaskDelay(pdMS_TO_TICKS(bufferedMicros / 1000 + 1));
+    }
+    i2s_zero_dma_buffer(_i2sPort);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "driver/i2s.h"
+
+// Streams WAV files from LittleFS to an I2S DAC/amplifier (MAX98357-style).
+// Supports 16-bit PCM (mono or stereo, downmixed) and IMA ADPCM mono.
+class AudioPlayer {
+public:
+    AudioPlayer(
+        int pinBCLK,
+        int pinLRCLK,
+        int pinDOUT,
+        i2s_port_t i2sPort = I2S_NUM_1
+    );
+
+    bool begin();
+
+    // Opens and checks the file on the caller's task; a running playback task switches
+    // to it at its next refill. Neither call waits for the playback task.
+    bool play(const String& filename);
+    bool stop();
+    bool isPlaying() const { return _isPlaying; }
+
+    // 0..100, applied while decoding
+    void setVolume(uint8_t volume);
+    uint8_t getVolume() const { return _volume; }
+
+    String getCurrentFilename() const { return _track.filename; }
+    uint32_t getSampleRate() const { return _track.sampleRate; }
+    uint32_t getPlayedMs() const { return _track.sampleRate ? (uint64_t)_samplesPlayed * 1000 / _track.sampleRate : 0; }
+    uint32_t getDurationMs() const { return _track.sampleRate ? (uint64_t)_track.totalSamples * 1000 / _track.sampleRate : 0; }
+    uint32_t getStartLatencyMicros() const { return _startLatencyMicros; }
+    uint32_t getUnderruns() const { return _underruns; }
+
+private:
+    enum class Format { PCM16, IMA_ADPCM };
+
+    // An opened file and its parsed WAV header
+    struct Track {
+        File file;
+        String filename;
+        Format format = Format::PCM16;
+        uint16_t channels = 1;
+        uint32_t sampleRate = 0;
+        uint16_t blockAlign = 0;
+        uint16_t adpcmSamplesPerBlock = 0;
+        uint32_t dataStart = 0;
+        uint32_t dataEnd = 0;
+        uint32_t totalSamples = 0;
+    };
+
+    // Decoded samples per refill; two of these ping-pong between decode and DMA
+    static const uint16_t BUFFER_SAMPLES = 512;
+
+    int _pinBCLK;
+    int _pinLRCLK;
+    int _pinDOUT;
+    i2s_port_t _i2sPort;
+    bool _installed = false;
+
+    // Playback state. _track belongs to the playback task while it runs; play() hands a
+    // replacement over in _next and stop() raises _stopRequested, both under _mux.
+    // Only the task closes its file and silences I2S, so it is never deleted mid-read.
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    volatile bool _isPlaying = false;
+    volatile bool _stopRequested = false;
+    volatile bool _hasNext = false;
+    Track _track;
+    Track _next;
+    volatile uint32_t _samplesPlayed = 0;
+    volatile uint16_t _gain = 256;          // Q8
+    uint8_t _volume = 100;
+    uint32_t _playRequestedMicros = 0;
+    uint32_t _startLatencyMicros = 0;
+    uint32_t _underruns = 0;
+
+    // ADPCM decoder state: one block is decoded at a time and drained across refills
+    static const uint16_t MAX_ADPCM_BLOCK = 512;
+    uint8_t _adpcmBlock[MAX_ADPCM_BLOCK];
+    int16_t _adpcmPending[(MAX_ADPCM_BLOCK - 4) * 2 + 1];
+    uint16_t _adpcmPendingCount = 0;
+    uint16_t _adpcmPendingPos = 0;
+
+    int16_t _buffers[2][BUFFER_SAMPLES];
+
+    TaskHandle_t _playbackTaskHandle = nullptr;
+
+    // Helper methods
+    static bool parseHeader(Track& track);
+    void startTrack(uint32_t requestedMicros);
+    size_t decode(int16_t* out, size_t maxSamples);
+    size_t decodePCM(int16_t* out, size_t maxSamples);
+    size_t decodeADPCM(int16_t* out, size_t maxSamples);
+    size_t decodeADPCMBlock(const uint8_t* block, size_t length, int16_t* out);
+    void applyGain(int16_t* samples, size_t count);
+
+    // Static task function
+    static void playbackTask(void* parameter);
+    void playbackLoop();
+    void playTrack();
+};
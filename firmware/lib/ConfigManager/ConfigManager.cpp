@@ -108,7 +108,7 @@ bool ConfigManager::set(const String& key, const JsonVariant& value) {
         start = dotIndex + 1;
     }
 
-    return save();
+    return commit(key);
 }
 
 bool ConfigManager::set(const String& key, const String& value) {
@@ -138,7 +138,7 @@ bool ConfigManager::set(const String& key, const String& value) {
         start = dotIndex + 1;
     }
 
-    return save();
+    return commit(key);
 }
 bool ConfigManager::set(const String& key, const bool& value) {
     // Split key by dots
@@ -167,7 +167,7 @@ bool ConfigManager::set(const String& key, const bool& value) {
         start = dotIndex + 1;
     }
 
-    return save();
+    return commit(key);
 }
 bool ConfigManager::set(const String& key, const int& value) {
     // Split key by dots
@@ -196,5 +196,15 @@ bool ConfigManager::set(const String& key, const int& value) {
         start = dotIndex + 1;
     }
 
-    return save();
-}
\ No newline at end of file
+    return commit(key);
+}
+// Persist, then tell listeners which key changed (e.g. to drop cached responses)
+bool ConfigManager::commit(const String& key) {
+    bool saved = save();
+    for (const ChangeListener& listener : _listeners) listener(key);
+    return saved;
+}
+
+void ConfigManager::onChange(ChangeListener listener) {
+    _listeners.push_back(listener);
+}
@@ -2,9 +2,14 @@
 #include <Arduino.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <functional>
+#include <vector>
 
 class ConfigManager {
 public:
+    // Called after every set() with the key that was written, e.g. "wifi" or "wifi.ssid"
+    using ChangeListener = std::function<void(const String& key)>;
+
     ConfigManager(const char* filePath = "/config.json");
     
     static ConfigManager& getInstance() {
@@ -17,11 +22,14 @@ public:
     bool set(const String& key, const String& value); 
     bool set(const String& key, const bool& value);
     bool set(const String& key, const int& value);
+    bool save();   // save JSON to file, e.g. after the filesystem was replaced
+    void onChange(ChangeListener listener);   // register during setup
 
 private:
     const char* _filePath;
     DynamicJsonDocument _doc;
+    std::vector<ChangeListener> _listeners;
 
     bool load();   // load JSON from file
-    bool save();   // save JSON to file
+    bool commit(const String& key);   // save, then notify listeners
 };
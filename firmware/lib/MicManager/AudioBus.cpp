@@ -0,0 +1,166 @@
+#include "AudioBus.h"
+
+bool AudioBus::begin() {
+    if (_freeQueue) return true;
+
+    _lock = xSemaphoreCreateMutex();
+    _freeQueue = xQueueCreate(POOL_SIZE, sizeof(AudioBlock*));
+    if (!_lock || !_freeQueue) return false;
+
+    for (uint8_t i = 0; i < POOL_SIZE; i++) {
+        AudioBlock* block = &_pool[i];
+        xQueueSend(_freeQueue, &block, 0);
+    }
+    return true;
+}
+
+AudioBlock* AudioBus::acquire() {
+    AudioBlock* block = nullptr;
+    if (xQueueReceive(_freeQueue, &block, 0) != pdTRUE) {
+        _poolExhausted++;
+        return nullptr;
+    }
+    block->refs.store(1);
+    return block;
+}
+
+void AudioBus::publish(AudioBlock* block) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        Subscriber& sub = _subscribers[i];
+        if (!sub.queue || sub.closing) continue;
+
+        block->refs.fetch_add(1);
+        if (xQueueSend(sub.queue, &block, 0) == pdTRUE) {
+            sub.delivered++;
+            continue;
+        }
+
+        // Queue full: apply the subscriber's drop policy, never block the producer
+        if (sub.policy == DropPolicy::DropOldest) {
+            AudioBlock* oldest = nullptr;
+            if (xQueueReceive(sub.queue, &oldest, 0) == pdTRUE) release(oldest);
+            if (xQueueSend(sub.queue, &block, 0) == pdTRUE) {
+                sub.delivered++;
+                sub.dropped++;
+                continue;
+            }
+        }
+        sub.dropped++;
+        release(block);
+    }
+    xSemaphoreGive(_lock);
+
+    // Drop the producer's own reference
+    release(block);
+}
+
+void AudioBus::release(AudioBlock* block) {
+    if (!block) return;
+    if (block->refs.fetch_sub(1) == 1) {
+        xQueueSend(_freeQueue, &block, 0);
+    }
+}
+
+int AudioBus::subscribe(const char* name, uint8_t depth, DropPolicy policy) {
+    if (!ready() || depth == 0) return -1;
+
+    int id = -1;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
+        if (_subscribers[i].queue) continue;
+
+        QueueHandle_t queue = xQueueCreate(depth, sizeof(AudioBlock*));
+        if (!queue) break;
+
+        Subscriber& sub = _subscribers[i];
+        sub.name = name;
+        sub.depth = depth;
+        sub.policy = policy;
+        sub.delivered = 0;
+        sub.dropped = 0;
+        sub.queue = queue;
+        _subscriberCount++;
+        id = i;
+        break;
+    }
+    xSemaphoreGive(_lock);
+    return id;
+}
+
+void AudioBus::unsubscribe(int id) {
+    if (id < 0 || id >= MAX_SUBSCRIBERS) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Subscriber& sub = _subscribers[id];
+    if (!sub.queue || sub.closing) {
+        xSemaphoreGive(_lock);
+        return;
+    }
+    sub.closing = true;
+
+    // Hand back whatever the subscriber never consumed, then wake a blocked receiver
+    AudioBlock* block = nullptr;
+    while (xQueueReceive(sub.queue, &block, 0) == pdTRUE) release(block);
+    AudioBlock* wake = nullptr;
+    if (sub.receivers) xQueueSend(sub.queue, &wake, 0);
+    xSemaphoreGive(_lock);
+
+    // The receiver leaves as soon as it runs; one that never does was deleted
+    uint32_t timeout = millis() + 500;
+    for (;;) {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        bool waiting = sub.receivers && millis() < timeout;
+        if (!waiting) {
+            vQueueDelete(sub.queue);
+            sub.queue = nullptr;
+            sub.receivers = 0;
+            sub.closing = false;
+            _subscriberCount--;
+        }
+        xSemaphoreGive(_lock);
+        if (!waiting) return;
+        vTaskDelay(1);
+    }
+}
+
+AudioBlock* AudioBus::receive(int id, TickType_t timeout) {
+    if (id < 0 || id >= MAX_SUBSCRIBERS) return nullptr;
+
+    // The queue stays valid while receivers is non-zero
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Subscriber& sub = _subscribers[id];
+    QueueHandle_t queue = sub.closing ? nullptr : sub.queue;
+    if (queue) sub.receivers++;
+    xSemaphoreGive(_lock);
+    if (!queue) return nullptr;
+
+    AudioBlock* block = nullptr;
+    if (xQueueReceive(queue, &block, timeout) != pdTRUE) block = nullptr;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    sub.receivers--;
+    xSemaphoreGive(_lock);
+    return block;   // nullptr when woken by unsubscribe()
+}
+
+uint8_t AudioBus::freeBlocks() const {
+    return _freeQueue ? uxQueueMessagesWaiting(_freeQueue) : 0;
+}
+
+bool AudioBus::subscriberStats(int id, SubscriberStats& out) const {
+    if (id < 0 || id >= MAX_SUBSCRIBERS) return false;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    const Subscriber& sub = _subscribers[id];
+    bool found = sub.queue && !sub.closing;
+    if (found) {
+        out.name = sub.name;
+        out.depth = sub.depth;
+        out.queued = uxQueueMessagesWaiting(sub.queue);
+        out.delivered = sub.delivered;
+        out.dropped = sub.dropped;
+    }
+    xSemaphoreGive(_lock);
+    return found;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// A block of captured 16-bit mono PCM, shared by every subscriber that received it
+struct AudioBlock {
+    static const uint16_t CAPACITY = 512;
+
+    int16_t samples[CAPACITY];
+    uint16_t count = 0;
+    uint32_t sequence = 0;
+    uint32_t timestampMs = 0;
+
+    std::atomic<int> refs;
+
+    AudioBlock() : refs(0) {}
+};
+
+// Fan-out of captured audio: blocks come from a fixed pool and are reference counted,
+// so the capture task reads the I2S port once and no consumer ever copies a block.
+class AudioBus {
+public:
+    static const uint8_t POOL_SIZE = 10;
+    static const uint8_t MAX_SUBSCRIBERS = 6;
+
+    // What to do when a subscriber's queue is full
+    enum class DropPolicy {
+        DropNewest,  // keep what is queued, drop the incoming block
+        DropOldest   // make room by dropping the oldest queued block
+    };
+
+    struct SubscriberStats {
+        const char* name;
+        uint8_t depth;
+        uint8_t queued;
+        uint32_t delivered;
+        uint32_t dropped;
+    };
+
+    bool begin();
+    bool ready() const { return _freeQueue != nullptr; }
+
+    // Producer side
+    AudioBlock* acquire();
+    void publish(AudioBlock* block);
+
+    // Consumer side: every received block must be released exactly once.
+    // unsubscribe() may run on any task: a receiver blocked on the queue is woken
+    // (receive() returns nullptr) and the queue is deleted once it has left.
+    int subscribe(const char* name, uint8_t depth, DropPolicy policy);
+    void unsubscribe(int id);
+    AudioBlock* receive(int id, TickType_t timeout);
+    void release(AudioBlock* block);
+
+    // Stats
+    uint8_t subscriberCount() const { return _subscriberCount; }
+    uint8_t freeBlocks() const;
+    uint32_t poolExhausted() const { return _poolExhausted; }
+    bool subscriberStats(int id, SubscriberStats& out) const;
+
+private:
+    struct Subscriber {
+        const char* name = nullptr;
+        QueueHandle_t queue = nullptr;
+        uint8_t depth = 0;
+        DropPolicy policy = DropPolicy::DropNewest;
+        volatile uint32_t delivered = 0;
+        volatile uint32_t dropped = 0;
+        uint8_t receivers = 0;   // tasks inside receive(), under _lock
+        bool closing = false;    // unsubscribe() is waiting for the receivers
+    };
+
+    AudioBlock _pool[POOL_SIZE];
+    QueueHandle_t _freeQueue = nullptr;
+    SemaphoreHandle_t _lock = nullptr;   // guards the subscriber table
+    Subscriber _subscribers[MAX_SUBSCRIBERS];
+    volatile uint8_t _subscriberCount = 0;
+    volatile uint32_t _poolExhausted = 0;
+};
@@ -0,0 +1,155 @@
+#include "AudioSource.h"
+
+// Sleep until `served` samples are due at `sampleRate`, like a DMA-fed driver would block
+static void paceTo(uint32_t startMicros, uint64_t served, uint32_t sampleRate) {
+    uint32_t dueMicros = (uint32_t)(served * 1000000ULL / sampleRate);
+    uint32_t elapsed = micros() - startMicros;
+    if (dueMicros > elapsed) {
+        vTaskDelay(pdMS_TO_TICKS((dueMicros - elapsed) / 1000) + 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// I2S microphone
+// ---------------------------------------------------------------------------
+
+bool I2SAudioSource::begin(uint32_t sampleRate) {
+    if (_installed) return true;
+
+    i2s_config_t config = {
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
+        .sample_rate = sampleRate,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
+        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S, // Updated from deprecated I2S_COMM_FORMAT_I2S
+        .intr_alloc_flags = 0,
+        .dma_buf_count = 4,
+        .dma_buf_len = 512,
+        .use_apll = false
+    };
+
+    i2s_pin_config_t pins = {
+        .bck_io_num = _pinBCLK,
+        .ws_io_num = _pinLRCLK,
+        .data_out_num = I2S_PIN_NO_CHANGE,
+        .data_in_num = _pinDOUT
+    };
+
+    if (i2s_driver_install(_port, &config, 0, NULL) != ESP_OK)
+        return false;
+
+    if (i2s_set_pin(_port, &pins) != ESP_OK)
+        return false;
+
+    _installed = true;
+    return true;
+}
+
+bool I2SAudioSource::read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) {
+    size_t bytesRead = 0;
+
+    esp_err_t result = i2s_read(
+        _port,
+        (void*)buffer,
+        sampleCount * sizeof(int32_t),
+        &bytesRead,
+        timeout
+    );
+
+    if (result != ESP_OK || bytesRead == 0) {
+        samplesRead = 0;
+        return false;
+    }
+
+    samplesRead = bytesRead / sizeof(int32_t);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic tone
+// ---------------------------------------------------------------------------
+
+bool ToneAudioSource::begin(uint32_t sampleRate) {
+    _sampleRate = sampleRate;
+
+    // One period of the sine, already in the 24-in-32 left-aligned layout
+    for (uint16_t i = 0; i < TABLE_SIZE; i++) {
+        float v = sinf(2.0f * PI * i / TABLE_SIZE) * _amplitude;
+        _table[i] = (int32_t)(v * 8388607.0f) << 8;
+    }
+
+    _phase = 0;
+    _phaseStep = (uint32_t)((double)_frequencyHz / sampleRate * 4294967296.0);
+    _samplesServed = 0;
+    _startMicros = micros();
+    return true;
+}
+
+bool ToneAudioSource::read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) {
+    for (size_t i = 0; i < sampleCount; i++) {
+        buffer[i] = _table[_phase >> 24];
+        _phase += _phaseStep;
+    }
+
+    samplesRead = sampleCount;
+    _samplesServed += sampleCount;
+    if (_realtime) paceTo(_startMicros, _samplesServed, _sampleRate);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// WAV file replay
+// ---------------------------------------------------------------------------
+
+bool FileAudioSource::begin(uint32_t sampleRate) {
+    _sampleRate = sampleRate;
+    _file = LittleFS.open(_path, "r");
+    if (!_file) return false;
+
+    // Walk the RIFF chunks to find where the PCM data starts
+    uint8_t header[12];
+    if (_file.read(header, 12) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        _file.close();
+        return false;
+    }
+
+    while (_file.available() >= 8) {
+        uint8_t chunk[8];
+        _file.read(chunk, 8);
+        uint32_t chunkSize;
+        memcpy(&chunkSize, chunk + 4, 4);
+        if (memcmp(chunk, "data", 4) == 0) {
+            _dataStart = _file.position();
+            _samplesServed = 0;
+            _startMicros = micros();
+            return true;
+        }
+        _file.seek(_file.position() + chunkSize + (chunkSize & 1));
+    }
+
+    _file.close();
+    return false;
+}
+
+bool FileAudioSource::read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) {
+    if (!_file) {
+        samplesRead = 0;
+        return false;
+    }
+
+    // Read 16-bit samples into the back half of the buffer, then widen in place
+    int16_t* pcm = reinterpret_cast<int16_t*>(buffer) + sampleCount;
+    size_t bytes = _file.read(reinterpret_cast<uint8_t*>(pcm), sampleCount * sizeof(int16_t));
+    if (bytes < sampleCount * sizeof(int16_t)) {
+        _file.seek(_dataStart);   // loop
+    }
+
+    samplesRead = bytes / sizeof(int16_t);
+    for (size_t i = 0; i < samplesRead; i++) {
+        buffer[i] = (int32_t)pcm[i] << 16;
+    }
+
+    _samplesServed += samplesRead;
+    if (_realtime) paceTo(_startMicros, _samplesServed, _sampleRate);
+    return samplesRead > 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "driver/i2s.h"
+
+// Where MicManager's capture task gets its samples from. Every source delivers the
+// INMP441 layout: 24-bit audio left-aligned in 32-bit slots.
+class AudioSource {
+public:
+    virtual ~AudioSource() {}
+    virtual bool begin(uint32_t sampleRate) = 0;
+    virtual bool read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) = 0;
+    virtual const char* name() const = 0;
+};
+
+// The real microphone
+class I2SAudioSource : public AudioSource {
+public:
+    I2SAudioSource(int pinBCLK, int pinLRCLK, int pinDOUT, i2s_port_t port)
+        : _pinBCLK(pinBCLK), _pinLRCLK(pinLRCLK), _pinDOUT(pinDOUT), _port(port) {}
+
+    bool begin(uint32_t sampleRate) override;
+    bool read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) override;
+    const char* name() const override { return "i2s"; }
+
+private:
+    int _pinBCLK;
+    int _pinLRCLK;
+    int _pinDOUT;
+    i2s_port_t _port;
+    bool _installed = false;
+};
+
+// Synthetic sine; paced to the sample rate like the driver, or as fast as possible for benchmarks
+class ToneAudioSource : public AudioSource {
+public:
+    ToneAudioSource(float frequencyHz = 440.0f, float amplitude = 0.5f, bool realtime = true)
+        : _frequencyHz(frequencyHz), _amplitude(amplitude), _realtime(realtime) {}
+
+    bool begin(uint32_t sampleRate) override;
+    bool read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) override;
+    const char* name() const override { return "tone"; }
+
+private:
+    static const uint16_t TABLE_SIZE = 256;
+
+    float _frequencyHz;
+    float _amplitude;
+    bool _realtime;
+    uint32_t _sampleRate = 16000;
+    int32_t _table[TABLE_SIZE];
+    uint32_t _phase = 0;        // Q32 phase accumulator
+    uint32_t _phaseStep = 0;
+    uint64_t _samplesServed = 0;
+    uint32_t _startMicros = 0;
+};
+
+// Replays a 16-bit mono PCM WAV from LittleFS, looping at the end
+class FileAudioSource : public AudioSource {
+public:
+    FileAudioSource(const String& path, bool realtime = true)
+        : _path(path), _realtime(realtime) {}
+    ~FileAudioSource() { if (_file) _file.close(); }
+
+    bool begin(uint32_t sampleRate) override;
+    bool read(int32_t* buffer, size_t sampleCount, size_t& samplesRead, TickType_t timeout) override;
+    const char* name() const override { return "file"; }
+
+private:
+    String _path;
+    bool _realtime;
+    File _file;
+    size_t _dataStart = 44;
+    uint32_t _sampleRate = 16000;
+    uint64_t _samplesServed = 0;
+    uint32_t _startMicros = 0;
+};
@@ -6,57 +6,50 @@ MicManager::MicManager(int pinBCLK, int pinLRCLK, int pinDOUT,
       _pinLRCLK(pinLRCLK),
       _pinDOUT(pinDOUT),
       _sampleRate(sampleRate),
-      _i2sPort(i2sPort) {}
+      _i2sPort(i2sPort),
+      _i2sSource(pinBCLK, pinLRCLK, pinDOUT, i2sPort),
+      _source(&_i2sSource) {}
+
+MicManager::~MicManager() {
+    if (_source != &_i2sSource) {
+        delete _source;
+    }
+}
 
 bool MicManager::begin() {
-    i2s_config_t config = {
-        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-        .sample_rate = _sampleRate,
-        .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-        .communication_format = I2S_COMM_FORMAT_STAND_I2S, // Updated from deprecated I2S_COMM_FORMAT_I2S
-        .intr_alloc_flags = 0,
-        .dma_buf_count = 4,
-        .dma_buf_len = 512,
-        .use_apll = false
-    };
-
-    i2s_pin_config_t pins = {
-        .bck_io_num = _pinBCLK,
-        .ws_io_num = _pinLRCLK,
-        .data_out_num = I2S_PIN_NO_CHANGE,
-        .data_in_num = _pinDOUT
-    };
-
-    if (i2s_driver_install(_i2sPort, &config, 0, NULL) != ESP_OK)
+    if (!_source->begin(_sampleRate))
         return false;
 
-    if (i2s_set_pin(_i2sPort, &pins) != ESP_OK)
+    _captureLock = xSemaphoreCreateMutex();
+    _spectrumLock = xSemaphoreCreateMutex();
+    if (!_captureLock || !_spectrumLock || !_bus.begin())
         return false;
 
     return true;
 }
 
-bool MicManager::readSamples(int32_t* buffer, size_t sampleCount, size_t& samplesRead) {
-    size_t bytesRead = 0;
-
-    esp_err_t result = i2s_read(
-        _i2sPort,
-        (void*)buffer,
-        sampleCount * sizeof(int32_t),
-        &bytesRead,
-        100
-    );
-
-    if (result != ESP_OK || bytesRead == 0) {
-        samplesRead = 0;
+bool MicManager::setSource(AudioSource* source) {
+    if (_captureRunning) {
         return false;
     }
-
-    samplesRead = bytesRead / sizeof(int32_t);
+    
+    AudioSource* next = source ? source : &_i2sSource;
+    if (next != &_i2sSource && !next->begin(_sampleRate)) {
+        delete next;
+        return false;
+    }
+    
+    if (_source != &_i2sSource) {
+        delete _source;
+    }
+    _source = next;
     return true;
 }
 
+bool MicManager::readSamples(int32_t* buffer, size_t sampleCount, size_t& samplesRead) {
+    return _source->read(buffer, sampleCount, samplesRead, 100);
+}
+
 float MicManager::calculateRMS(int32_t* buffer, size_t samples) {
     double sum = 0;
 
@@ -140,11 +133,63 @@ bool MicManager::startRecording(const String& filename) {
     }
     
     _currentFilename = filename;
+    _segmented = false;
     
     // Reserve space for WAV header
-    uint32_t headerSize = 44; // Standard WAV header size
-    for (uint32_t i = 0; i < headerSize; i++) {
-        _recordFile.write((uint8_t)0);
+    uint8_t header[WAV_HEADER_SIZE] = {0};
+    _recordFile.write(header, WAV_HEADER_SIZE);
+    
+    if (!startRecordingTask()) {
+        _recordFile.close();
+        return false;
+    }
+    return true;
+}
+
+bool MicManager::startSegmentedRecording(const String& directory, uint32_t segmentSeconds, size_t quotaBytes) {
+    if (_isRecording || segmentSeconds == 0) {
+        return false;
+    }
+    
+    _segmentDir = directory.endsWith("/") ? directory.substring(0, directory.length() - 1) : directory;
+    if (!_segmentDir.startsWith("/")) {
+        _segmentDir = "/" + _segmentDir;
+    }
+    if (!LittleFS.exists(_segmentDir) && !LittleFS.mkdir(_segmentDir)) {
+        return false;
+    }
+    
+    _segmentBytesLimit = segmentSeconds * _sampleRate * sizeof(int16_t);
+    _segmentQuota = quotaBytes;
+    
+    // The quota has to hold at least the segment being written
+    if (_segmentQuota < _segmentBytesLimit + WAV_HEADER_SIZE) {
+        return false;
+    }
+    
+    // Continue an existing rotation in this directory so the quota survives restarts
+    loadSegmentIndex();
+    
+    _segmented = true;
+    if (!openSegment()) {
+        _segmented = false;
+        return false;
+    }
+    
+    if (!startRecordingTask()) {
+        _recordFile.close();
+        LittleFS.remove(_currentFilename);
+        _segmented = false;
+        return false;
+    }
+    return true;
+}
+
+bool MicManager::startRecordingTask() {
+    // Subscribe to the audio bus; a deep queue rides out slow flash writes
+    _recordingSubscriber = subscribeAudio("recorder", 6, AudioBus::DropPolicy::DropNewest);
+    if (_recordingSubscriber < 0) {
+        return false;
     }
     
     // Reset recording stats
@@ -190,12 +235,23 @@ bool MicManager::stopRecording() {
         }
     }
     
-    // Update WAV header with final size
-    updateWavHeader();
+    // The task unsubscribes itself; only needed if it had to be killed
+    if (_recordingSubscriber >= 0) {
+        unsubscribeAudio(_recordingSubscriber);
+        _recordingSubscriber = -1;
+    }
     
-    // Close file
-    if (_recordFile) {
-        _recordFile.close();
+    // Only still open if the task had to be killed
+    if (_segmented) {
+        closeSegment();
+    } else {
+        // Update WAV header with final size
+        updateWavHeader();
+        
+        // Close file
+        if (_recordFile) {
+            _recordFile.close();
+        }
     }
     
     // Calculate final duration
@@ -214,88 +270,509 @@ void MicManager::recordingTask(void* parameter) {
 }
 
 void MicManager::recordingLoop() {
-    // FIX 1: Use static buffer to avoid heap fragmentation
-    static const size_t BUFFER_SIZE = 512;
-    static int32_t readBuffer[BUFFER_SIZE];
-    
     uint32_t lastCallbackTime = 0;
     uint32_t lastStatsTime = 0;
-    uint32_t totalSamplesWritten = 0;
-    uint32_t bytesProcessedThisCycle = 0;
-    
-    // FIX 2: Adaptive yield mechanism
-    const uint32_t MAX_BYTES_PER_CYCLE = 4096; // Process max 4KB before yielding
-    const TickType_t YIELD_DELAY = pdMS_TO_TICKS(5); // Yield for 5ms
     
     while (_isRecording && _recordFile) {
-        size_t samplesRead = 0;
-        
-        // FIX 3: Yield CPU periodically to prevent hogging
-        if (bytesProcessedThisCycle >= MAX_BYTES_PER_CYCLE) {
-            vTaskDelay(YIELD_DELAY);
-            bytesProcessedThisCycle = 0;
+        AudioBlock* block = _bus.receive(_recordingSubscriber, pdMS_TO_TICKS(100));
+        if (!block) {
             continue;
         }
         
-        // Read samples with timeout
-        if (!readSamples(readBuffer, BUFFER_SIZE, samplesRead) || samplesRead == 0) {
-            // FIX 4: Small delay when no data instead of tight loop
-            vTaskDelay(1);
-            continue;
-        }
+        // Blocks are already 16-bit; write straight from the shared buffer
+        size_t blockBytes = block->count * sizeof(int16_t);
         
-        // Process and write samples
-        for (size_t i = 0; i < samplesRead; i++) {
-            // Convert 24-bit to 16-bit
-            int16_t sample16 = (int16_t)convertSample24to16(readBuffer[i]);
-            
-            // Write to file
-            if (_recordFile.write((uint8_t*)&sample16, sizeof(int16_t)) != sizeof(int16_t)) {
-                // Write failed
+        // Cut a new segment once this block would overflow the current one
+        if (_segmented && _segmentBytes > 0 && _segmentBytes + blockBytes > _segmentBytesLimit) {
+            if (!closeSegment() || !openSegment()) {
+                _bus.release(block);
                 _isRecording = false;
                 break;
             }
-            _recordedBytes += sizeof(int16_t);
-            totalSamplesWritten++;
-            bytesProcessedThisCycle += sizeof(int16_t);
         }
         
+        if (_recordFile.write((uint8_t*)block->samples, blockBytes) != blockBytes) {
+            // Write failed
+            _bus.release(block);
+            _isRecording = false;
+            break;
+        }
+        _recordedBytes += blockBytes;
+        _segmentBytes += blockBytes;
+        
         // Update duration
         _recordedDuration = millis() - _recordStartTime;
         
         // Call callback every 500ms (non-blocking check)
         if (_statusCallback && (millis() - lastCallbackTime > 500)) {
-            float rms = calculateRMS(readBuffer, min(samplesRead, BUFFER_SIZE));
-            float db = calculateDB(rms);
+            float db = calculateDB(calculateRMS(block->samples, block->count));
             _statusCallback(_recordedDuration, _recordedBytes, db);
             lastCallbackTime = millis();
         }
         
-        // FIX 5: Optional stats - only if serial buffer isn't full
+        _bus.release(block);
+        
+        // Optional stats - only if serial buffer isn't full
         if (millis() - lastStatsTime > 5000 && Serial.availableForWrite() > 100) {
             Serial.printf("[MIC] Recording: %ds, %dKB, Heap: %d\n", 
                          _recordedDuration/1000, _recordedBytes/1024, ESP.getFreeHeap());
             lastStatsTime = millis();
         }
-        
-        // FIX 6: Strategic yield based on workload
-        // More samples = less yield needed, but always yield a little
-        if (samplesRead > 0) {
-            // Yield 1-3ms based on how much work we did
-            TickType_t adaptiveDelay = pdMS_TO_TICKS(1 + (samplesRead / 256));
-            vTaskDelay(adaptiveDelay);
-        }
     }
     
-    // No delete needed since buffer is static
+    unsubscribeAudio(_recordingSubscriber);
+    _recordingSubscriber = -1;
     
     // Clean up if recording stopped
     if (!_isRecording && _recordFile) {
-        updateWavHeader();
-        _recordFile.flush();
-        _recordFile.close();
+        if (_segmented) {
+            closeSegment();
+        } else {
+            updateWavHeader();
+            _recordFile.flush();
+            _recordFile.close();
+        }
     }
     
-    // FIX 7: Clear task handle before exiting
+    // Clear task handle before exiting
     _recordingTaskHandle = nullptr;
-}
\ No newline at end of file
+}
+
+// ---------------------------------------------------------------------------
+// Segmented recording
+// ---------------------------------------------------------------------------
+
+String MicManager::segmentPath(const String& directory, uint32_t sequence) {
+    char name[20];
+    snprintf(name, sizeof(name), "/seg_%06u.wav", (unsigned)sequence);
+    return directory + name;
+}
+
+bool MicManager::openSegment() {
+    // Make room for a full segment before creating it
+    enforceQuota(_segmentBytesLimit + WAV_HEADER_SIZE);
+    
+    _currentFilename = segmentPath(_segmentDir, _segmentSequence);
+    _recordFile = LittleFS.open(_currentFilename, "w");
+    if (!_recordFile) {
+        return false;
+    }
+    
+    // Placeholder header; the real one is written once, on close
+    uint8_t header[WAV_HEADER_SIZE] = {0};
+    _recordFile.write(header, WAV_HEADER_SIZE);
+    _segmentBytes = 0;
+    return true;
+}
+
+bool MicManager::closeSegment() {
+    if (!_recordFile) {
+        return false;
+    }
+    
+    // The segment's size is final now, so its header is written exactly once
+    _recordFile.seek(0);
+    writeWavHeader(_recordFile, _segmentBytes, _sampleRate, 16);
+    _recordFile.close();
+    
+    if (_segmentBytes == 0) {
+        LittleFS.remove(_currentFilename);
+        return true;
+    }
+    
+    SegmentInfo info;
+    info.sequence = _segmentSequence;
+    info.startMs = _segmentTimelineMs;
+    info.durationMs = (uint32_t)((uint64_t)_segmentBytes * 1000 / (_sampleRate * sizeof(int16_t)));
+    info.bytes = _segmentBytes;
+    
+    // Only closed segments reach the index, so a crash never lists a broken file
+    File index = LittleFS.open(_segmentDir + "/index.csv", "a");
+    if (index) {
+        index.printf("%u,%u,%u,%u\n", (unsigned)info.sequence, (unsigned)info.startMs,
+                     (unsigned)info.durationMs, (unsigned)info.bytes);
+        index.close();
+    }
+    
+    _segments.push_back(info);
+    _segmentsTotalBytes += info.bytes + WAV_HEADER_SIZE;
+    _segmentTimelineMs += info.durationMs;
+    _segmentSequence++;
+    return true;
+}
+
+void MicManager::enforceQuota(size_t reserveBytes) {
+    bool removed = false;
+    
+    while (!_segments.empty()) {
+        bool overQuota = _segmentsTotalBytes + reserveBytes > _segmentQuota;
+        bool fsFull = LittleFS.totalBytes() - LittleFS.usedBytes() < reserveBytes + 8192; // keep room for metadata
+        if (!overQuota && !fsFull) {
+            break;
+        }
+        
+        // Circular: the oldest segment goes first
+        const SegmentInfo& oldest = _segments.front();
+        LittleFS.remove(segmentPath(_segmentDir, oldest.sequence));
+        _segmentsTotalBytes -= oldest.bytes + WAV_HEADER_SIZE;
+        _segments.erase(_segments.begin());
+        removed = true;
+    }
+    
+    if (removed) {
+        rewriteSegmentIndex();
+    }
+}
+
+bool MicManager::loadSegmentIndex() {
+    _segments.clear();
+    _segmentsTotalBytes = 0;
+    _segmentSequence = 0;
+    _segmentTimelineMs = 0;
+    
+    // A crash between the two steps of rewriteSegmentIndex() leaves only the temp file
+    String indexPath = _segmentDir + "/index.csv";
+    if (!LittleFS.exists(indexPath) && LittleFS.exists(_segmentDir + "/index.tmp")) {
+        LittleFS.rename(_segmentDir + "/index.tmp", indexPath);
+    }
+    
+    File index = LittleFS.open(indexPath, "r");
+    if (!index) {
+        return false;
+    }
+    
+    while (index.available()) {
+        String line = index.readStringUntil('\n');
+        unsigned seq, start, duration, bytes;
+        if (sscanf(line.c_str(), "%u,%u,%u,%u", &seq, &start, &duration, &bytes) != 4) {
+            continue;
+        }
+        
+        SegmentInfo info = { seq, start, duration, bytes };
+        _segments.push_back(info);
+        _segmentsTotalBytes += bytes + WAV_HEADER_SIZE;
+        _segmentSequence = seq + 1;
+        _segmentTimelineMs = start + duration;
+    }
+    index.close();
+    return true;
+}
+
+bool MicManager::rewriteSegmentIndex() {
+    String indexPath = _segmentDir + "/index.csv";
+    String tempPath = _segmentDir + "/index.tmp";
+    
+    File index = LittleFS.open(tempPath, "w");
+    if (!index) {
+        return false;
+    }
+    for (size_t i = 0; i < _segments.size(); i++) {
+        const SegmentInfo& info = _segments[i];
+        index.printf("%u,%u,%u,%u\n", (unsigned)info.sequence, (unsigned)info.startMs,
+                     (unsigned)info.durationMs, (unsigned)info.bytes);
+    }
+    index.close();
+    
+    // Swap in the new index in one step
+    LittleFS.remove(indexPath);
+    return LittleFS.rename(tempPath, indexPath);
+}
+
+bool MicManager::findSegments(const String& directory, uint32_t fromMs, uint32_t toMs, std::vector<SegmentInfo>& out) {
+    File index = LittleFS.open(directory + "/index.csv", "r");
+    if (!index) {
+        return false;
+    }
+    
+    // Entries are in timeline order, so the scan stops at the first segment past the range
+    while (index.available()) {
+        String line = index.readStringUntil('\n');
+        unsigned seq, start, duration, bytes;
+        if (sscanf(line.c_str(), "%u,%u,%u,%u", &seq, &start, &duration, &bytes) != 4) {
+            continue;
+        }
+        if (start >= toMs) {
+            break;
+        }
+        if (start + duration > fromMs) {
+            SegmentInfo info = { seq, start, duration, bytes };
+            out.push_back(info);
+        }
+    }
+    index.close();
+    return true;
+}
+
+float MicManager::calculateRMS(const int16_t* buffer, size_t samples) {
+    if (samples == 0) return 0;
+    
+    double sum = 0;
+    for (size_t i = 0; i < samples; i++) {
+        double f = (double)buffer[i] / 32768.0;
+        sum += f * f;
+    }
+    
+    return sqrt(sum / samples);
+}
+
+// ---------------------------------------------------------------------------
+// Audio bus: one capture task reads the I2S port and publishes to subscribers
+// ---------------------------------------------------------------------------
+
+int MicManager::subscribeAudio(const char* name, uint8_t depth, AudioBus::DropPolicy policy) {
+    if (!_bus.ready()) {
+        return -1;
+    }
+    
+    int id = _bus.subscribe(name, depth, policy);
+    if (id < 0) {
+        return -1;
+    }
+    
+    // First subscriber starts the capture task
+    xSemaphoreTake(_captureLock, portMAX_DELAY);
+    if (!_captureRunning) {
+        _captureRunning = true;
+        if (xTaskCreatePinnedToCore(
+                captureTask,
+                "CaptureTask",
+                3072,
+                this,
+                2,                      // above its consumers so DMA is always drained
+                &_captureTaskHandle,
+                1) != pdPASS) {
+            _captureRunning = false;
+        }
+    }
+    bool running = _captureRunning;
+    xSemaphoreGive(_captureLock);
+    
+    if (!running) {
+        _bus.unsubscribe(id);
+        return -1;
+    }
+    return id;
+}
+
+void MicManager::unsubscribeAudio(int id) {
+    if (id < 0) {
+        return;
+    }
+    
+    _bus.unsubscribe(id);
+    
+    // Last subscriber stops the capture task
+    xSemaphoreTake(_captureLock, portMAX_DELAY);
+    if (_captureRunning && _bus.subscriberCount() == 0) {
+        _captureRunning = false;
+        uint32_t timeout = millis() + 500;
+        while (_captureTaskHandle != nullptr && millis() < timeout) {
+            delay(5);
+        }
+        if (_captureTaskHandle) {
+            vTaskDelete(_captureTaskHandle);
+            _captureTaskHandle = nullptr;
+        }
+    }
+    xSemaphoreGive(_captureLock);
+}
+
+void MicManager::captureTask(void* parameter) {
+    MicManager* instance = static_cast<MicManager*>(parameter);
+    instance->captureLoop();
+    
+    instance->_captureTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void MicManager::captureLoop() {
+    static int32_t rawBuffer[AudioBlock::CAPACITY];
+    uint32_t sequence = 0;
+    
+    while (_captureRunning) {
+        size_t samplesRead = 0;
+        if (!readSamples(rawBuffer, AudioBlock::CAPACITY, samplesRead) || samplesRead == 0) {
+            vTaskDelay(1);
+            continue;
+        }
+        
+        // Pool exhausted means every consumer is behind; drop this block, keep draining DMA
+        AudioBlock* block = _bus.acquire();
+        if (!block) {
+            continue;
+        }
+        
+        // Convert once, 24-bit -> 16-bit; every subscriber shares this buffer
+        for (size_t i = 0; i < samplesRead; i++) {
+            block->samples[i] = (int16_t)convertSample24to16(rawBuffer[i]);
+        }
+        block->count = samplesRead;
+        block->sequence = sequence++;
+        block->timestampMs = millis();
+        
+        _bus.publish(block);
+    }
+    
+    _captureTaskHandle = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Spectrum analyser
+// ---------------------------------------------------------------------------
+
+bool MicManager::startSpectrum() {
+    if (!_bus.ready()) {
+        return false;
+    }
+    
+    xSemaphoreTake(_spectrumLock, portMAX_DELAY);
+    if (_spectrumActive) {
+        xSemaphoreGive(_spectrumLock);
+        return false;
+    }
+    _spectrumActive = true;
+    
+    // A task that is still winding down sees the flag again and keeps running.
+    // Otherwise start one on core 0, so the analysis never competes with capture and
+    // recording on core 1.
+    bool started = _spectrumTaskHandle != nullptr ||
+        xTaskCreatePinnedToCore(
+            spectrumTask,
+            "SpectrumTask",
+            4096,
+            this,
+            1,
+            &_spectrumTaskHandle,
+            0) == pdPASS;
+    if (!started) {
+        _spectrumActive = false;
+    }
+    xSemaphoreGive(_spectrumLock);
+    
+    return started;
+}
+
+bool MicManager::stopSpectrum() {
+    xSemaphoreTake(_spectrumLock, portMAX_DELAY);
+    bool wasActive = _spectrumActive;
+    _spectrumActive = false;   // the task notices within one receive timeout
+    xSemaphoreGive(_spectrumLock);
+    
+    return wasActive;
+}
+
+int MicManager::addSpectrumListener(SpectrumCallback callback) {
+    for (uint8_t i = 0; i < MAX_SPECTRUM_LISTENERS; i++) {
+        if (!_spectrumListenerActive[i]) {
+            _spectrumListeners[i] = callback;
+            _spectrumListenerActive[i] = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void MicManager::removeSpectrumListener(int id) {
+    if (id >= 0 && id < MAX_SPECTRUM_LISTENERS) {
+        _spectrumListenerActive[id] = false;
+    }
+}
+
+void MicManager::spectrumTask(void* parameter) {
+    MicManager* instance = static_cast<MicManager*>(parameter);
+    instance->spectrumLoop();
+    vTaskDelete(nullptr);
+}
+
+void MicManager::spectrumLoop() {
+    // Only the most recent block matters to the analyser
+    int subscriber = subscribeAudio("spectrum", 1, AudioBus::DropPolicy::DropOldest);
+    _spectrum.begin(_sampleRate);
+    
+    for (;;) {
+        while (_spectrumActive && subscriber >= 0) {
+            AudioBlock* block = _bus.receive(subscriber, pdMS_TO_TICKS(100));
+            if (!block) {
+                continue;
+            }
+            
+            publishSpectrum(block->samples, block->count);
+            _bus.release(block);
+        }
+        
+        // Exit unless startSpectrum() ran again meanwhile; after the handle is cleared
+        // it starts a new task instead
+        xSemaphoreTake(_spectrumLock, portMAX_DELAY);
+        if (subscriber < 0) {
+            _spectrumActive = false;
+        }
+        bool restarted = _spectrumActive;
+        if (!restarted) {
+            _spectrumTaskHandle = nullptr;
+        }
+        xSemaphoreGive(_spectrumLock);
+        if (!restarted) {
+            break;
+        }
+    }
+    
+    // Stopping the capture task may take a moment; that happens here, not in stopSpectrum()
+    unsubscribeAudio(subscriber);
+}
+
+void MicManager::publishSpectrum(const int16_t* samples, size_t count) {
+    const SpectrumFrame& frame = _spectrum.process(samples, count);
+    
+    for (uint8_t i = 0; i < MAX_SPECTRUM_LISTENERS; i++) {
+        if (_spectrumListenerActive[i] && _spectrumListeners[i]) {
+            _spectrumListeners[i](frame);
+        }
+    }
+}
+bool MicManager::runBenchmark(size_t sampleCount, CaptureBenchmark& result) {
+    result = CaptureBenchmark();
+    if (_captureRunning || _isRecording) {
+        return false;
+    }
+    
+    // Paced like the driver: an unpaced source never blocks, and the capture task
+    // would starve the recorder below it
+    ToneAudioSource tone(440.0f, 0.5f, true);
+    tone.begin(_sampleRate * BENCH_SPEEDUP);
+    AudioSource* previous = _source;
+    _source = &tone;
+    
+    uint32_t poolExhausted = _bus.poolExhausted();
+    bool finished = false;
+    uint32_t started = micros();
+    
+    if (startRecording("/bench.wav")) {
+        size_t targetBytes = sampleCount * sizeof(int16_t);
+        while (_isRecording && _recordedBytes < targetBytes) {
+            delay(5);
+        }
+        result.totalMicros = micros() - started;
+        result.samples = _recordedBytes / sizeof(int16_t);
+        
+        // Still recording unless a write came back short
+        finished = _isRecording;
+        AudioBus::SubscriberStats stats;
+        if (finished && _bus.subscriberStats(_recordingSubscriber, stats)) {
+            result.blocks = stats.delivered;
+            result.dropped = stats.dropped;
+        }
+        stopRecording();
+        
+        // After a failed write the recorder stops on its own; the capture task
+        // reads the tone until the recorder has unsubscribed
+        while (_recordingTaskHandle != nullptr || _captureRunning) {
+            delay(5);
+        }
+    }
+    result.dropped += _bus.poolExhausted() - poolExhausted;
+    
+    _source = previous;
+    // Removed on failure too: a full LittleFS must not keep the partial file
+    LittleFS.remove("/bench.wav");
+    return finished;
+}
@@ -1,7 +1,11 @@
 #pragma once
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <vector>
 #include "driver/i2s.h"
+#include "AudioBus.h"
+#include "AudioSource.h"
+#include "SpectrumAnalyzer.h"
 
 class MicManager {
 public:
@@ -12,18 +16,43 @@ public:
         uint32_t sampleRate = 16000,
         i2s_port_t i2sPort = I2S_NUM_0
     );
+    ~MicManager();
 
     bool begin();
+
+    // Where captured samples come from; defaults to the I2S microphone.
+    // Takes ownership of the source, nullptr switches back to I2S. Fails while capturing.
+    bool setSource(AudioSource* source);
+    const char* sourceName() const { return _source->name(); }
+
     bool readSamples(int32_t* buffer, size_t sampleCount, size_t& samplesRead);
     float calculateRMS(int32_t* buffer, size_t samples);
+    float calculateRMS(const int16_t* buffer, size_t samples);
     float calculateDB(float rms);
     
     // Recording control functions
     bool startRecording(const String& filename);
     bool stopRecording();
     
+    // Segmented recording: a new WAV every segmentSeconds inside directory, oldest
+    // segments deleted to stay under quotaBytes, closed segments listed in <directory>/index.csv
+    bool startSegmentedRecording(const String& directory, uint32_t segmentSeconds, size_t quotaBytes);
+
+    // One closed segment; times are on the recorded-audio timeline of the directory
+    struct SegmentInfo {
+        uint32_t sequence;
+        uint32_t startMs;
+        uint32_t durationMs;
+        uint32_t bytes;
+    };
+    static String segmentPath(const String& directory, uint32_t sequence);
+    static bool findSegments(const String& directory, uint32_t fromMs, uint32_t toMs, std::vector<SegmentInfo>& out);
+
     // Recording status
     bool isRecording() const { return _isRecording; }
+    bool isSegmented() const { return _segmented; }
+    size_t getSegmentCount() const { return _segments.size(); }
+    size_t getSegmentsBytes() const { return _segmentsTotalBytes; }
     uint32_t getRecordedDuration() const { return _recordedDuration; }
     size_t getRecordedBytes() const { return _recordedBytes; }
     String getCurrentFilename() const { return _currentFilename; }
@@ -32,6 +61,40 @@ public:
     typedef std::function<void(uint32_t duration, size_t bytes, float currentDB)> RecordingStatusCallback;
     void setRecordingCallback(RecordingStatusCallback callback) { _statusCallback = callback; }
 
+    // Audio bus: every consumer subscribes instead of reading I2S itself.
+    // The capture task runs while at least one subscriber exists.
+    int subscribeAudio(const char* name, uint8_t depth, AudioBus::DropPolicy policy);
+    void unsubscribeAudio(int id);
+    AudioBus& bus() { return _bus; }
+    bool isCapturing() const { return _captureRunning; }
+
+    // Spectrum analyser mode (runs alongside recording). Both only signal the spectrum
+    // task and return at once, so they are safe on the network task; the task
+    // subscribes to the bus itself and unsubscribes when it exits.
+    bool startSpectrum();
+    bool stopSpectrum();
+    bool isSpectrumActive() const { return _spectrumActive; }
+    const SpectrumAnalyzer& spectrum() const { return _spectrum; }
+
+    // Spectrum subscribers, called from the spectrum task for every analysed block
+    typedef std::function<void(const SpectrumFrame& frame)> SpectrumCallback;
+    int addSpectrumListener(SpectrumCallback callback);
+    void removeSpectrumListener(int id);
+
+    // Capture-path throughput: the capture and recording tasks run as for `mic record`,
+    // fed by a tone instead of I2S, into /bench.wav. The tone is paced at BENCH_SPEEDUP
+    // times the sample rate, so a run without drops shows headroom over real time.
+    static const uint8_t BENCH_SPEEDUP = 2;
+    struct CaptureBenchmark {
+        size_t samples = 0;         // written to the file
+        uint32_t blocks = 0;        // delivered to the recorder
+        uint32_t dropped = 0;       // full recorder queue or empty block pool
+        uint32_t totalMicros = 0;
+    };
+    // False while capturing, or when a write to /bench.wav came back short and the
+    // recorder stopped. The file is deleted either way.
+    bool runBenchmark(size_t sampleCount, CaptureBenchmark& result);
+
 private:
     int _pinBCLK;
     int _pinLRCLK;
@@ -39,6 +102,8 @@ private:
 
     uint32_t _sampleRate;
     i2s_port_t _i2sPort;
+    I2SAudioSource _i2sSource;
+    AudioSource* _source;
     
     // Recording state
     bool _isRecording = false;
@@ -48,18 +113,58 @@ private:
     uint32_t _recordedDuration = 0;
     size_t _recordedBytes = 0;
     
+    // Segmented recording state
+    bool _segmented = false;
+    String _segmentDir;
+    uint32_t _segmentBytesLimit = 0;
+    size_t _segmentQuota = 0;
+    uint32_t _segmentSequence = 0;
+    uint32_t _segmentTimelineMs = 0;
+    size_t _segmentBytes = 0;
+    std::vector<SegmentInfo> _segments;
+    size_t _segmentsTotalBytes = 0;
+    
     // Task handle for recording in background
     TaskHandle_t _recordingTaskHandle = nullptr;
+    int _recordingSubscriber = -1;
+    
+    // Capture state
+    AudioBus _bus;
+    SemaphoreHandle_t _captureLock = nullptr;
+    volatile bool _captureRunning = false;
+    TaskHandle_t _captureTaskHandle = nullptr;
     
     // Callback
     RecordingStatusCallback _statusCallback = nullptr;
+
+    // Spectrum state
+    static const uint8_t MAX_SPECTRUM_LISTENERS = 4;
+    SpectrumAnalyzer _spectrum;
+    SemaphoreHandle_t _spectrumLock = nullptr;   // start/stop against the task's exit
+    volatile bool _spectrumActive = false;
+    TaskHandle_t _spectrumTaskHandle = nullptr;
+    SpectrumCallback _spectrumListeners[MAX_SPECTRUM_LISTENERS];
+    volatile bool _spectrumListenerActive[MAX_SPECTRUM_LISTENERS] = {};
+    
+    static const uint8_t WAV_HEADER_SIZE = 44;
     
     // Helper methods
+    bool startRecordingTask();
     bool writeWavHeader(File& file, uint32_t dataSize, uint32_t sampleRate, uint16_t bitsPerSample = 16);
     int32_t convertSample24to16(int32_t sample);
     void updateWavHeader();
+    bool openSegment();
+    bool closeSegment();
+    void enforceQuota(size_t reserveBytes);
+    bool loadSegmentIndex();
+    bool rewriteSegmentIndex();
     
     // Static task function
     static void recordingTask(void* parameter);
     void recordingLoop();
+    static void captureTask(void* parameter);
+    void captureLoop();
+    static void spectrumTask(void* parameter);
+    void spectrumLoop();
+    void publishSpectrum(const int16_t* samples, size_t count);
 };
\ No newline at end of file
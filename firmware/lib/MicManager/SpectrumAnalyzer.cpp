@@ -0,0 +1,139 @@
+#include "SpectrumAnalyzer.h"
+
+// Band levels map log2(energy) from LEVEL_FLOOR..LEVEL_FLOOR+LEVEL_RANGE onto 0..255
+static const int32_t LEVEL_FLOOR_Q8 = 6 << 8;
+static const int32_t LEVEL_RANGE_Q8 = 24 << 8;
+static const float LOWEST_BAND_HZ = 60.0f;
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+    memset(_frame.bands, 0, sizeof(_frame.bands));
+}
+
+void SpectrumAnalyzer::begin(uint32_t sampleRate) {
+    // Hann window and twiddle factors are computed once, in Q15
+    for (uint16_t i = 0; i < FFT_SIZE; i++) {
+        float w = 0.5f - 0.5f * cosf(2.0f * PI * i / (FFT_SIZE - 1));
+        _window[i] = (int16_t)(w * 32767.0f);
+    }
+    for (uint16_t i = 0; i < FFT_SIZE / 2; i++) {
+        float angle = 2.0f * PI * i / FFT_SIZE;
+        _cos[i] = (int16_t)(cosf(angle) * 32767.0f);
+        _sin[i] = (int16_t)(sinf(angle) * 32767.0f);
+    }
+
+    // Log-spaced band edges (in bins) from ~60 Hz up to Nyquist
+    float binHz = (float)sampleRate / FFT_SIZE;
+    float firstBin = LOWEST_BAND_HZ / binHz;
+    if (firstBin < 1.0f) firstBin = 1.0f;
+    float lastBin = FFT_SIZE / 2;
+    float ratio = powf(lastBin / firstBin, 1.0f / SpectrumFrame::BAND_COUNT);
+
+    float edge = firstBin;
+    _bandEdges[0] = (uint16_t)firstBin;
+    for (uint8_t b = 1; b <= SpectrumFrame::BAND_COUNT; b++) {
+        edge *= ratio;
+        uint16_t bin = (uint16_t)(edge + 0.5f);
+        if (bin <= _bandEdges[b - 1]) bin = _bandEdges[b - 1] + 1;  // at least one bin per band
+        if (bin > FFT_SIZE / 2) bin = FFT_SIZE / 2;
+        _bandEdges[b] = bin;
+    }
+
+    _avgCpuMicros = 0;
+    _maxCpuMicros = 0;
+    _ready = true;
+}
+
+const SpectrumFrame& SpectrumAnalyzer::process(const int16_t* samples, size_t count) {
+    if (!_ready) return _frame;
+    uint32_t start = micros();
+
+    if (count > FFT_SIZE) count = FFT_SIZE;
+
+    // Block floating point: scale the block up so quiet input keeps its precision
+    int32_t peak = 1;
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = samples[i] < 0 ? -(int32_t)samples[i] : samples[i];
+        if (v > peak) peak = v;
+    }
+    uint8_t shift = 0;
+    while (shift < 15 && (peak << (shift + 1)) < 16384) shift++;
+
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        int32_t v = i < count ? ((int32_t)samples[i] << shift) : 0;
+        _re[i] = (int16_t)((v * _window[i]) >> 15);
+        _im[i] = 0;
+    }
+
+    fft();
+
+    // Sum bin power per band and map to a log level; undo the block scaling in the log domain
+    int32_t shiftQ8 = (int32_t)shift * 2 * 256;
+    for (uint8_t b = 0; b < SpectrumFrame::BAND_COUNT; b++) {
+        uint64_t energy = 0;
+        for (uint16_t k = _bandEdges[b]; k < _bandEdges[b + 1]; k++) {
+            int32_t re = _re[k];
+            int32_t im = _im[k];
+            energy += (uint32_t)(re * re) + (uint32_t)(im * im);
+        }
+
+        int32_t level = 0;
+        if (energy > 0) {
+            level = ((int32_t)log2Q8(energy) - shiftQ8 - LEVEL_FLOOR_Q8) * 255 / LEVEL_RANGE_Q8;
+            if (level < 0) level = 0;
+            if (level > 255) level = 255;
+        }
+        _frame.bands[b] = (uint8_t)level;
+    }
+
+    uint32_t elapsed = micros() - start;
+    _frame.cpuMicros = elapsed;
+    _frame.sequence++;
+    _avgCpuMicros = _avgCpuMicros ? (_avgCpuMicros * 7 + elapsed) / 8 : elapsed;
+    if (elapsed > _maxCpuMicros) _maxCpuMicros = elapsed;
+    return _frame;
+}
+
+// In-place radix-2 decimation-in-time FFT, halving every stage to avoid overflow
+void SpectrumAnalyzer::fft() {
+    for (uint16_t i = 1, j = 0; i < FFT_SIZE; i++) {
+        uint16_t bit = FFT_SIZE >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            int16_t t = _re[i]; _re[i] = _re[j]; _re[j] = t;
+            t = _im[i]; _im[i] = _im[j]; _im[j] = t;
+        }
+    }
+
+    for (uint16_t len = 2; len <= FFT_SIZE; len <<= 1) {
+        uint16_t half = len >> 1;
+        uint16_t step = FFT_SIZE / len;
+        for (uint16_t i = 0; i < FFT_SIZE; i += len) {
+            for (uint16_t k = 0; k < half; k++) {
+                int32_t wr = _cos[k * step];
+                int32_t wi = -_sin[k * step];
+                uint16_t a = i + k;
+                uint16_t b = a + half;
+
+                int32_t tr = (wr * _re[b] - wi * _im[b]) >> 15;
+                int32_t ti = (wr * _im[b] + wi * _re[b]) >> 15;
+                int32_t ar = _re[a];
+                int32_t ai = _im[a];
+
+                _re[b] = (int16_t)((ar - tr) >> 1);
+                _im[b] = (int16_t)((ai - ti) >> 1);
+                _re[a] = (int16_t)((ar + tr) >> 1);
+                _im[a] = (int16_t)((ai + ti) >> 1);
+            }
+        }
+    }
+}
+
+// Integer log2 with 8 fractional bits (linear mantissa approximation)
+uint32_t SpectrumAnalyzer::log2Q8(uint64_t value) {
+    if (value == 0) return 0;
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t frac = msb >= 8 ? (uint32_t)(value >> (msb - 8)) & 0xFF
+                             : (uint32_t)(value << (8 - msb)) & 0xFF;
+    return (msb << 8) | frac;
+}
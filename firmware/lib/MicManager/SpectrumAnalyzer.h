@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+
+// One published spectrum frame: log-spaced band levels scaled to 0..255
+struct SpectrumFrame {
+    static const uint8_t BAND_COUNT = 16;
+
+    uint8_t bands[BAND_COUNT];
+    uint32_t sequence = 0;     // increments for every analysed block
+    uint32_t cpuMicros = 0;    // time spent analysing this block
+};
+
+// Windowed fixed-point (Q15) FFT over 512-sample blocks of 16-bit PCM
+class SpectrumAnalyzer {
+public:
+    static const uint16_t FFT_SIZE = 512;
+    static const uint8_t FFT_BITS = 9;
+
+    SpectrumAnalyzer();
+
+    void begin(uint32_t sampleRate);
+    const SpectrumFrame& process(const int16_t* samples, size_t count);
+    const SpectrumFrame& frame() const { return _frame; }
+
+    // CPU cost of the analysis, in microseconds per block
+    uint32_t lastCpuMicros() const { return _frame.cpuMicros; }
+    uint32_t avgCpuMicros() const { return _avgCpuMicros; }
+    uint32_t maxCpuMicros() const { return _maxCpuMicros; }
+
+private:
+    int16_t _re[FFT_SIZE];
+    int16_t _im[FFT_SIZE];
+    int16_t _window[FFT_SIZE];
+    int16_t _cos[FFT_SIZE / 2];
+    int16_t _sin[FFT_SIZE / 2];
+    uint16_t _bandEdges[SpectrumFrame::BAND_COUNT + 1];
+
+    SpectrumFrame _frame;
+    uint32_t _avgCpuMicros = 0;
+    uint32_t _maxCpuMicros = 0;
+    bool _ready = false;
+
+    void fft();
+    static uint32_t log2Q8(uint64_t value);
+};
@@ -0,0 +1,81 @@
+#include "AdmissionControl.h"
+
+void AdmissionControl::setMaxInFlight(uint8_t requests) {
+    _maxInFlight = constrain(requests, 1, ADMISSION_MAX_IN_FLIGHT);
+}
+
+void AdmissionControl::limit(const String& prefix, uint8_t requests) {
+    for (Limit& l : _limits) {
+        if (l.prefix == prefix) {
+            l.maxInFlight = requests;
+            return;
+        }
+    }
+    _limits.push_back({prefix, requests, 0});
+}
+
+int8_t AdmissionControl::groupFor(const String& path) const {
+    int8_t best = -1;
+    for (size_t i = 0; i < _limits.size(); i++) {
+        if (!path.startsWith(_limits[i].prefix)) continue;
+        if (best < 0 || _limits[i].prefix.length() > _limits[best].prefix.length()) best = i;
+    }
+    return best;
+}
+
+AdmissionControl::Verdict AdmissionControl::admit(const void* request, int8_t group) {
+    // Heap is read outside the lock; the rest is a handful of compares
+    bool lowHeap = ESP.getFreeHeap() < _minFreeHeap || ESP.getMaxAllocHeap() < _minLargestBlock;
+
+    portENTER_CRITICAL(&_mux);
+    Verdict verdict = Verdict::Admitted;
+    if (_inFlight >= _maxInFlight) {
+        verdict = Verdict::ServerFull;
+    } else if (group >= 0 && _limits[group].inFlight >= _limits[group].maxInFlight) {
+        verdict = Verdict::RouteFull;
+    } else if (lowHeap) {
+        // A fragmented heap fails the large blocks a response needs even with enough free bytes
+        verdict = Verdict::LowHeap;
+    }
+
+    if (verdict != Verdict::Admitted) {
+        _shed[(uint8_t)verdict]++;
+        portEXIT_CRITICAL(&_mux);
+        return verdict;
+    }
+
+    for (Slot& slot : _slots) {
+        if (slot.request) continue;
+        slot.request = request;
+        slot.group = group;
+        break;
+    }
+    _inFlight++;
+    if (group >= 0) _limits[group].inFlight++;
+    _admitted++;
+    portEXIT_CRITICAL(&_mux);
+    return verdict;
+}
+
+void AdmissionControl::release(const void* request) {
+    portENTER_CRITICAL(&_mux);
+    for (Slot& slot : _slots) {
+        if (slot.request != request) continue;
+        slot.request = nullptr;
+        _inFlight--;
+        if (slot.group >= 0) _limits[slot.group].inFlight--;
+        break;
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+void AdmissionControl::printPrometheus(Print& out) const {
+    static const char* const reasons[4] = { "", "server_full", "route_full", "low_heap" };
+
+    out.printf("# TYPE jarvis_http_in_flight gauge\njarvis_http_in_flight %u\n", (unsigned)_inFlight);
+    out.printf("# TYPE jarvis_http_admitted_total counter\njarvis_http_admitted_total %u\n", (unsigned)_admitted);
+    out.print("# HELP jarvis_http_shed_total Requests answered with 503 by admission control.\n"
+              "# TYPE jarvis_http_shed_total counter\n");
+    for (uint8_t r = 1; r < 4; r++)
+        out.printf("jarvis_http_shed_total{reason=\"%s\"} %u\n", reasons[r], (unsigned)_shed[r]);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+// Most requests that can be in flight at once; override with -D ADMISSION_MAX_IN_FLIGHT=...
+#ifndef ADMISSION_MAX_IN_FLIGHT
+#define ADMISSION_MAX_IN_FLIGHT 16
+#endif
+
+// Decides whether a routed request may start, before anything is allocated for it.
+// A request is in flight from admission until its connection closes, so slow clients
+// that still hold a response count too. Requests are identified by HttpRequest::id().
+// Safe to call from several tasks (the esp_http_server backend releases on its workers).
+class AdmissionControl {
+public:
+    enum class Verdict : uint8_t { Admitted, ServerFull, RouteFull, LowHeap };
+
+    void setMaxInFlight(uint8_t requests);
+    void setMinFreeHeap(uint32_t bytes) { _minFreeHeap = bytes; }
+    void setMinLargestBlock(uint32_t bytes) { _minLargestBlock = bytes; }
+    void setRetryAfter(uint16_t seconds) { _retryAfter = seconds; }
+
+    // At most `requests` in flight for routes under `prefix`; the longest prefix wins.
+    // Must be called before ServerManager::begin().
+    void limit(const String& prefix, uint8_t requests);
+    int8_t groupFor(const String& path) const;    // -1 when no limit applies
+
+    Verdict admit(const void* request, int8_t group);
+    void release(const void* request);
+
+    uint8_t inFlight() const { return _inFlight; }
+    uint16_t retryAfter() const { return _retryAfter; }
+    uint32_t admitted() const { return _admitted; }
+    uint32_t shed(Verdict reason) const { return _shed[(uint8_t)reason]; }
+
+    // Prometheus text format, appended to /metrics
+    void printPrometheus(Print& out) const;
+
+private:
+    struct Limit {
+        String prefix;
+        uint8_t maxInFlight;
+        uint8_t inFlight;
+    };
+    struct Slot {
+        const void* request;
+        int8_t group;
+    };
+
+    std::vector<Limit> _limits;
+    Slot _slots[ADMISSION_MAX_IN_FLIGHT] = {};
+    uint8_t _maxInFlight = 4;
+    uint8_t _inFlight = 0;
+    uint32_t _minFreeHeap = 20000;
+    uint32_t _minLargestBlock = 8192;
+    uint16_t _retryAfter = 1;
+    volatile uint32_t _admitted = 0;
+    volatile uint32_t _shed[4] = {};
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
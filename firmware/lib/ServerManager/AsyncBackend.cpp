@@ -0,0 +1,200 @@
+#ifndef JARVIS_HTTPD
+#include "AsyncBackend.h"
+#include <LittleFS.h>
+
+AsyncBackend::AsyncBackend(ServerManager* server, uint16_t port)
+    : _server(server), _web(port), _routeHandler(this), _assetHandler(&server->_staticAssets) {}
+
+bool AsyncBackend::begin() {
+    // WebSockets and event streams go first so the static handler never shadows them
+    for (auto socket : _server->_sockets) {
+        _web.addHandler(socket);
+    }
+    for (auto hub : _server->_eventHubs) {
+        _web.addHandler(&hub->source());
+        if (!hub->begin()) Serial.println("⚠️ Failed to start event stream");
+    }
+
+    if (_server->_hasAssetManifest) {
+        _web.addHandler(&_assetHandler);
+    } else {
+        _web.serveStatic("/", LittleFS, "/web/").setDefaultFile("index.html");
+    }
+    _web.addHandler(&_routeHandler);
+
+    _web.begin();
+    return true;
+}
+
+bool AsyncBackend::AssetHandler::canHandle(AsyncWebServerRequest* request) {
+    AsyncHttpRequest adapter(request);
+    if (!_assets->canHandle(adapter)) return false;
+    // Headers not declared interesting are dropped before handleRequest
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void AsyncBackend::AssetHandler::handleRequest(AsyncWebServerRequest* request) {
+    AsyncHttpRequest adapter(request);
+    _assets->handle(adapter);
+}
+
+// Claiming the request here also keeps its headers: AsyncWebServer drops every
+// header no handler asked for, Authorization included.
+bool AsyncBackend::RouteHandler::canHandle(AsyncWebServerRequest* request) {
+    AsyncHttpRequest adapter(request);
+    if (!_backend->_server->findRoute(adapter)) return false;
+    request->addInterestingHeader("ANY");
+    return true;
+}
+
+void AsyncBackend::RouteHandler::handleRequest(AsyncWebServerRequest* request) {
+    AsyncHttpRequest adapter(request);
+    const RoutePlan* plan = _backend->_server->findRoute(adapter);
+    if (!plan) return;
+
+    // POST with a body (accumulated or streamed)
+    if (plan->route->bodyHandler || plan->route->chunkHandler) {
+        _backend->completeBody(plan, adapter);
+        return;
+    }
+    if (!_backend->admit(plan, request)) {
+        _backend->_server->sendError(plan, &adapter, 503, "Server busy, try again");
+        return;
+    }
+    _backend->_server->dispatch(plan, &adapter);
+}
+
+void AsyncBackend::RouteHandler::handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len,
+                                             size_t index, size_t total) {
+    AsyncHttpRequest adapter(request);
+    const RoutePlan* plan = _backend->_server->findRoute(adapter);
+    // Plain routes ignore a body, as before
+    if (plan && (plan->route->bodyHandler || plan->route->chunkHandler))
+        _backend->receiveBody(plan, adapter, data, len, index, total);
+}
+
+// Shed load before anything is allocated for the request. Admitted requests are
+// tracked until their connection closes; that is also where a body buffer is returned.
+bool AsyncBackend::admit(const RoutePlan* plan, AsyncWebServerRequest* request) {
+    if (_server->_admission.admit(request, plan->admissionGroup) != AdmissionControl::Verdict::Admitted)
+        return false;
+    request->onDisconnect([this, request]() {
+        releaseBody(request);
+        _server->_admission.release(request);
+    });
+    return true;
+}
+
+// Body chunks arrive in order, one TCP segment at a time. The first chunk decides
+// whether the upload is accepted at all; later chunks only copy or forward data.
+void AsyncBackend::receiveBody(const RoutePlan* plan, AsyncHttpRequest& adapter,
+                                const uint8_t* data, size_t len, size_t index, size_t total) {
+    AsyncWebServerRequest* request = adapter.native();
+    BodyState* state = static_cast<BodyState*>(request->_tempObject);
+
+    if (index == 0 && !state) {
+        state = static_cast<BodyState*>(malloc(sizeof(BodyState)));
+        if (!state) return;   // completeBody answers 503 for a body without state
+        state->slot = -1;
+        state->length = 0;
+        state->status = 0;
+        state->error[0] = '\0';
+        request->_tempObject = state;
+
+        // Admission first: a shed upload never reaches the guards or a buffer
+        if (!admit(plan, request)) {
+            rejectBody(state, 503, "Server busy, try again");
+            return;
+        }
+        if (plan->maxBody && total > plan->maxBody) {
+            rejectBody(state, 413, "Payload too large");
+            return;
+        }
+        try {
+            _server->checkGuards(plan, &adapter);
+        } catch (const HttpError& e) {
+            rejectBody(state, e.statusCode(), e.message().c_str());
+            return;
+        }
+        if (plan->route->bodyHandler) {
+            state->slot = _server->_bodies.acquire();
+            if (state->slot < 0) {
+                rejectBody(state, 503, "Server busy, try again");
+                return;
+            }
+        }
+    }
+    if (!state || state->status) return;
+
+    if (plan->route->bodyHandler) {
+        if (index + len > plan->maxBody) {
+            // Chunked uploads announce no total up front
+            rejectBody(state, 413, "Payload too large");
+            return;
+        }
+        memcpy(_server->_bodies.buffer(state->slot) + index, data, len);
+        state->length = index + len;
+        return;
+    }
+
+    try {
+        ServerManager::DispatchLock lock(_server->_dispatchLock);
+        plan->route->chunkHandler(&adapter, data, len, index, total);
+        state->length = index + len;
+    } catch (const HttpError& e) {
+        rejectBody(state, e.statusCode(), e.message().c_str());
+    } catch (const std::exception& e) {
+        rejectBody(state, 500, e.what());
+    }
+}
+
+void AsyncBackend::completeBody(const RoutePlan* plan, AsyncHttpRequest& adapter) {
+    AsyncWebServerRequest* request = adapter.native();
+    BodyState* state = static_cast<BodyState*>(request->_tempObject);
+
+    if (!state) {
+        if (request->contentLength() > 0) {
+            _server->sendError(plan, &adapter, 503, "Server busy, try again");
+            return;
+        }
+        // Empty body: run the handler with no data
+        if (!admit(plan, request)) {
+            _server->sendError(plan, &adapter, 503, "Server busy, try again");
+            return;
+        }
+        static const uint8_t empty[1] = { 0 };
+        _server->dispatch(plan, &adapter, plan->route->bodyHandler ? empty : nullptr, 0);
+        return;
+    }
+    if (state->status) {
+        _server->sendError(plan, &adapter, state->status, state->error);
+        releaseBody(request);
+        return;
+    }
+
+    const uint8_t* body = nullptr;
+    if (state->slot >= 0) {
+        uint8_t* buffer = _server->_bodies.buffer(state->slot);
+        buffer[state->length] = '\0';
+        body = buffer;
+    }
+    _server->dispatch(plan, &adapter, body, state->length, true);
+    releaseBody(request);
+}
+
+void AsyncBackend::releaseBody(AsyncWebServerRequest* request) {
+    BodyState* state = static_cast<BodyState*>(request->_tempObject);
+    if (state && state->slot >= 0) {
+        _server->_bodies.release(state->slot);
+        state->slot = -1;
+    }
+}
+
+void AsyncBackend::rejectBody(BodyState* state, int status, const char* message) {
+    // Later chunks are ignored; completeBody sends the error once the client finished sending
+    state->status = status;
+    strncpy(state->error, message, sizeof(state->error) - 1);
+    state->error[sizeof(state->error) - 1] = '\0';
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef JARVIS_HTTPD
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "HttpBackend.h"
+#include "AsyncHttpRequest.h"
+#include "ServerManager.h"
+
+// HttpBackend over ESPAsyncWebServer (the default). Every callback runs on the
+// AsyncTCP task; bodies arrive one TCP segment at a time and responses are sent
+// as the client acknowledges data. Also serves ServerManager's WebSockets.
+class AsyncBackend : public HttpBackend {
+public:
+    AsyncBackend(ServerManager* server, uint16_t port);
+
+    const char* name() const override { return "async"; }
+    bool begin() override;
+
+private:
+    using RoutePlan = ServerManager::RoutePlan;
+
+    // Upload state of one body request, malloc'ed into request->_tempObject
+    // (the request frees it). Plain data only: no destructor ever runs.
+    struct BodyState {
+        int16_t slot;                      // BodyPool slot, -1 for streamed routes
+        size_t length;
+        int16_t status;                    // != 0 once the upload was rejected
+        char error[48];
+    };
+
+    // The one AsyncWebServer handler for all routes: looks the request up in the trie
+    // and hands it to the pipeline. The lookup is repeated per callback instead of
+    // stored, since it is cheap and allocation-free.
+    class RouteHandler : public AsyncWebHandler {
+    public:
+        explicit RouteHandler(AsyncBackend* backend) : _backend(backend) {}
+        bool canHandle(AsyncWebServerRequest* request) override;
+        void handleRequest(AsyncWebServerRequest* request) override;
+        void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len,
+                        size_t index, size_t total) override;
+        bool isRequestHandlerTrivial() override { return false; }
+    private:
+        AsyncBackend* _backend;
+    };
+
+    // ServerManager's StaticAssetHandler as an AsyncWebHandler
+    class AssetHandler : public AsyncWebHandler {
+    public:
+        explicit AssetHandler(const StaticAssetHandler* assets) : _assets(assets) {}
+        bool canHandle(AsyncWebServerRequest* request) override;
+        void handleRequest(AsyncWebServerRequest* request) override;
+    private:
+        const StaticAssetHandler* _assets;
+    };
+
+    ServerManager* _server;
+    AsyncWebServer _web;
+    RouteHandler _routeHandler;
+    AssetHandler _assetHandler;
+
+    bool admit(const RoutePlan* plan, AsyncWebServerRequest* request);
+    void receiveBody(const RoutePlan* plan, AsyncHttpRequest& request,
+                     const uint8_t* data, size_t len, size_t index, size_t total);
+    void completeBody(const RoutePlan* plan, AsyncHttpRequest& request);
+    void releaseBody(AsyncWebServerRequest* request);
+    static void rejectBody(BodyState* state, int status, const char* message);
+};
+#endif
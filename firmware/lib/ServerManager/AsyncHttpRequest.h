@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "../../include/HttpRequest.h"
+
+static_assert((uint32_t)HttpResponse::FILL_LATER == RESPONSE_TRY_AGAIN, "fillers share the library's retry value");
+
+// HttpRequest over an ESPAsyncWebServer request. Only wraps the pointer, so it is
+// built on the stack for every callback; id() is the library's request.
+class AsyncHttpRequest : public HttpRequest {
+public:
+    explicit AsyncHttpRequest(AsyncWebServerRequest* request) : _request(request) {}
+
+    HttpMethod method() const override {
+        switch (_request->method()) {
+            case HTTP_GET:     return HttpMethod::Get;
+            case HTTP_POST:    return HttpMethod::Post;
+            case HTTP_DELETE:  return HttpMethod::Delete;
+            case HTTP_PUT:     return HttpMethod::Put;
+            case HTTP_PATCH:   return HttpMethod::Patch;
+            case HTTP_HEAD:    return HttpMethod::Head;
+            case HTTP_OPTIONS: return HttpMethod::Options;
+            default:           return HttpMethod::Other;
+        }
+    }
+
+    const String& url() const override { return _request->url(); }
+
+    bool hasParam(const char* name) const override { return _request->hasParam(name); }
+    const String& param(const char* name) const override {
+        AsyncWebParameter* p = _request->getParam(name);
+        return p ? p->value() : none();
+    }
+
+    bool hasHeader(const char* name) const override { return _request->hasHeader(name); }
+    const String& header(const char* name) const override {
+        AsyncWebHeader* h = _request->getHeader(name);
+        return h ? h->value() : none();
+    }
+
+    const void* id() const override { return _request; }
+
+    void send(HttpResponse& response) override {
+        AsyncWebServerResponse* native = nullptr;
+        switch (response.body()) {
+            case HttpResponse::Body::Empty:
+                native = _request->beginResponse(response.status());
+                break;
+            case HttpResponse::Body::Text:
+                native = _request->beginResponse(response.status(), response.contentType(), response.text());
+                break;
+            case HttpResponse::Body::Stream: {
+                AsyncResponseStream* stream = _request->beginResponseStream(response.contentType(), response.length());
+                response.writer()(*stream);
+                native = stream;
+                break;
+            }
+            case HttpResponse::Body::Fill:
+                // FILL_LATER is the library's RESPONSE_TRY_AGAIN: asked again on the next ack or poll
+                native = response.length() == HttpResponse::UNKNOWN_LENGTH
+                    ? _request->beginChunkedResponse(response.contentType(), response.filler())
+                    : _request->beginResponse(response.contentType(), response.length(), response.filler());
+                break;
+        }
+        native->setCode(response.status());
+        for (const auto& header : response.headers()) native->addHeader(header.first, header.second);
+        _request->send(native);
+    }
+
+    AsyncWebServerRequest* native() const { return _request; }
+
+private:
+    AsyncWebServerRequest* _request;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// Buffers for postWithBody routes; override with -D BODY_POOL_SLOTS=... / -D BODY_BUFFER_SIZE=...
+#ifndef BODY_POOL_SLOTS
+#define BODY_POOL_SLOTS 2
+#endif
+#ifndef BODY_BUFFER_SIZE
+#define BODY_BUFFER_SIZE 4096
+#endif
+
+// Fixed request-body buffers, allocated once so uploads never fragment the heap
+class BodyPool {
+public:
+    static const uint8_t SLOTS = BODY_POOL_SLOTS;
+    static const size_t BUFFER_SIZE = BODY_BUFFER_SIZE;
+
+    bool begin() {
+        if (_memory) return true;
+        // +1 per buffer so a full body can still be NUL-terminated
+        _memory = static_cast<uint8_t*>(malloc(SLOTS * (BUFFER_SIZE + 1)));
+        return _memory != nullptr;
+    }
+
+    // -1 when every buffer is in use
+    int acquire() {
+        if (!_memory) return -1;
+        for (uint8_t i = 0; i < SLOTS; i++) {
+            bool expected = false;
+            if (_inUse[i].compare_exchange_strong(expected, true)) return i;
+        }
+        _exhausted++;
+        return -1;
+    }
+
+    void release(int slot) {
+        if (slot >= 0 && slot < SLOTS) _inUse[slot].store(false);
+    }
+
+    uint8_t* buffer(int slot) { return _memory + slot * (BUFFER_SIZE + 1); }
+
+    uint8_t available() const {
+        uint8_t free = 0;
+        for (uint8_t i = 0; i < SLOTS; i++)
+            if (!_inUse[i].load()) free++;
+        return free;
+    }
+    uint32_t exhausted() const { return _exhausted; }
+
+private:
+    uint8_t* _memory = nullptr;
+    std::atomic<bool> _inUse[SLOTS] = {};
+    volatile uint32_t _exhausted = 0;
+};
@@ -0,0 +1,189 @@
+#include "EventHub.h"
+
+EventHub::EventHub(const char* url)
+    : _url(url)
+#ifndef JARVIS_HTTPD
+    , _source(url)
+#endif
+{}
+
+bool EventHub::publish(const char* topic, const char* json) {
+    if (!_lock || strlen(json) >= EVENT_HUB_PAYLOAD_SIZE) return false;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Topic* slot = nullptr;
+    for (uint8_t i = 0; i < _topicCount; i++) {
+        if (strcmp(_topics[i].name, topic) == 0) { slot = &_topics[i]; break; }
+    }
+    if (!slot && _topicCount < EVENT_HUB_MAX_TOPICS) {
+        slot = &_topics[_topicCount++];
+        strncpy(slot->name, topic, sizeof(slot->name) - 1);
+    }
+
+    bool changed = slot && strcmp(slot->payload, json) != 0;
+    if (changed) {
+        if (slot->pending) _coalesced++;
+        strcpy(slot->payload, json);
+        slot->pending = true;
+    }
+    xSemaphoreGive(_lock);
+    return slot != nullptr;
+}
+
+bool EventHub::begin() {
+    if (_running) return true;
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    if (!_lock) return false;
+
+#ifdef JARVIS_HTTPD
+    if (!_frameSent) _frameSent = xSemaphoreCreateBinary();
+    if (!_frameSent) return false;
+#else
+    // A new dashboard gets the current state at once instead of waiting for changes
+    _source.onConnect([this](AsyncEventSourceClient* client) { sendSnapshot(client); });
+#endif
+
+    _running = true;
+    if (xTaskCreatePinnedToCore(flushTask, "EventTask", 4096, this, 1, &_taskHandle, 0) != pdPASS) {
+        _running = false;
+        return false;
+    }
+    return true;
+}
+
+void EventHub::stop() {
+    if (!_running) return;
+    _running = false;
+    while (_taskHandle) vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+void EventHub::flushTask(void* param) {
+    static_cast<EventHub*>(param)->flushLoop();
+}
+
+void EventHub::flushLoop() {
+    TickType_t lastWake = xTaskGetTickCount();
+    while (_running) {
+        for (Sampler& sampler : _samplers) sampler(*this);
+        flush();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(_intervalMs));
+    }
+    _taskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+void EventHub::flush() {
+#ifdef JARVIS_HTTPD
+    if (_clientCount == 0) return;
+#else
+    if (_source.count() == 0) return;
+
+    // Clients are behind: keep everything pending and let newer values replace it
+    if (_source.avgPacketsWaiting() > EVENT_HUB_MAX_BACKLOG) {
+        _deferred++;
+        return;
+    }
+#endif
+
+    char payload[EVENT_HUB_PAYLOAD_SIZE];
+    for (uint8_t i = 0; i < EVENT_HUB_MAX_TOPICS; i++) {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        bool pending = i < _topicCount && _topics[i].pending;
+        if (pending) {
+            memcpy(payload, _topics[i].payload, sizeof(payload));
+            _topics[i].pending = false;
+        }
+        xSemaphoreGive(_lock);
+        if (!pending) continue;
+
+        send(payload, _topics[i].name);
+        _sent++;
+    }
+}
+
+void EventHub::send(const char* payload, const char* topic) {
+#ifdef JARVIS_HTTPD
+    // The sockets belong to the server task: hand it the frame and wait until it is written
+    _frameLength = format(_frame, sizeof(_frame), payload, topic, ++_eventId);
+    if (_server && httpd_queue_work(_server, writeFrame, this) == ESP_OK)
+        xSemaphoreTake(_frameSent, pdMS_TO_TICKS(5000));
+#else
+    _source.send(payload, topic, ++_eventId);
+#endif
+}
+
+#ifdef JARVIS_HTTPD
+size_t EventHub::format(char* out, size_t size, const char* payload, const char* topic, uint32_t id) {
+    int length = snprintf(out, size, "id: %u\nevent: %s\ndata: %s\n\n", (unsigned)id, topic, payload);
+    if (length < 0) return 0;
+    return (size_t)length < size ? length : size - 1;
+}
+
+// Runs on the server task
+bool EventHub::accept(httpd_req_t* request) {
+    if (_clientCount >= EVENT_HUB_MAX_CLIENTS) {
+        httpd_resp_set_status(request, "503 Service Unavailable");
+        httpd_resp_set_hdr(request, "Retry-After", "5");
+        httpd_resp_send(request, nullptr, 0);
+        return true;
+    }
+
+    // Written raw: the response never ends, the socket stays with the hub
+    static const char HEADERS[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                                  "Cache-Control: no-cache\r\nConnection: keep-alive\r\n\r\n";
+    if (httpd_send(request, HEADERS, sizeof(HEADERS) - 1) < 0) return false;
+    _server = request->handle;
+
+    // A new dashboard gets the current state at once instead of waiting for changes
+    char payload[EVENT_HUB_PAYLOAD_SIZE];
+    char name[sizeof(_topics[0].name)];
+    char frame[sizeof(_frame)];
+    for (uint8_t i = 0; i < EVENT_HUB_MAX_TOPICS; i++) {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        bool known = i < _topicCount && _topics[i].payload[0];
+        if (known) {
+            memcpy(payload, _topics[i].payload, sizeof(payload));
+            memcpy(name, _topics[i].name, sizeof(name));
+        }
+        xSemaphoreGive(_lock);
+        if (!known) continue;
+        size_t length = format(frame, sizeof(frame), payload, name, _eventId);
+        if (httpd_send(request, frame, length) < 0) return false;
+    }
+
+    _clients[_clientCount++] = httpd_req_to_sockfd(request);
+    return true;
+}
+
+// Runs on the server task when a session closes, before its descriptor is reused
+void EventHub::closed(int fd) {
+    for (uint8_t i = 0; i < _clientCount; i++) {
+        if (_clients[i] != fd) continue;
+        _clients[i] = _clients[--_clientCount];
+        return;
+    }
+}
+
+// Runs on the server task, queued by send()
+void EventHub::writeFrame(void* param) {
+    EventHub* hub = static_cast<EventHub*>(param);
+    for (uint8_t i = 0; i < hub->_clientCount; i++) {
+        // A failed write closes the session; closed() then drops the client
+        if (httpd_socket_send(hub->_server, hub->_clients[i], hub->_frame, hub->_frameLength, 0) < 0)
+            httpd_sess_trigger_close(hub->_server, hub->_clients[i]);
+    }
+    xSemaphoreGive(hub->_frameSent);
+}
+#else
+// Runs on the web server task while the client is being accepted
+void EventHub::sendSnapshot(AsyncEventSourceClient* client) {
+    char payload[EVENT_HUB_PAYLOAD_SIZE];
+    for (uint8_t i = 0; i < EVENT_HUB_MAX_TOPICS; i++) {
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        bool known = i < _topicCount && _topics[i].payload[0];
+        if (known) memcpy(payload, _topics[i].payload, sizeof(payload));
+        xSemaphoreGive(_lock);
+        if (known) client->send(payload, _topics[i].name, _eventId);
+    }
+}
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#ifdef JARVIS_HTTPD
+#include <esp_http_server.h>
+#else
+#include <ESPAsyncWebServer.h>
+#endif
+#include <vector>
+
+// Fixed topic table; override with -D EVENT_HUB_MAX_TOPICS=... / -D EVENT_HUB_PAYLOAD_SIZE=...
+#ifndef EVENT_HUB_MAX_TOPICS
+#define EVENT_HUB_MAX_TOPICS 8
+#endif
+#ifndef EVENT_HUB_PAYLOAD_SIZE
+#define EVENT_HUB_PAYLOAD_SIZE 128
+#endif
+// Queued events per client before flushes are held back (the library drops beyond SSE_MAX_QUEUED_MESSAGES)
+#ifndef EVENT_HUB_MAX_BACKLOG
+#define EVENT_HUB_MAX_BACKLOG 4
+#endif
+// Open streams per hub with the esp_http_server backend, which keeps the client table itself
+#ifndef EVENT_HUB_MAX_CLIENTS
+#define EVENT_HUB_MAX_CLIENTS 4
+#endif
+
+// Server-Sent Events channel for device state. Each topic keeps only its latest
+// payload; a flush task sends changed topics at most once per interval, so a value
+// that changes 100 times a second still costs the clients one event per interval.
+// While clients have more than EVENT_HUB_MAX_BACKLOG events queued, flushes are
+// skipped and topics stay pending, so slow clients get fewer, fresher events
+// instead of a backlog. With the esp_http_server backend the hub writes the stream
+// to the sockets itself, on the server task; there is no backlog to measure there.
+class EventHub {
+public:
+    using Sampler = std::function<void(EventHub&)>;
+
+    EventHub(const char* url = "/events");
+
+#ifdef JARVIS_HTTPD
+    // Called by IdfBackend on the server task: answers GET <url> with the stream
+    // headers and the current state, and keeps the socket
+    bool accept(httpd_req_t* request);
+    void closed(int fd);
+    uint8_t clients() const { return _clientCount; }
+#else
+    AsyncEventSource& source() { return _source; }
+#endif
+    const char* url() const { return _url; }
+    void setInterval(uint16_t ms) { _intervalMs = ms < 20 ? 20 : ms; }
+
+    // Runs on every flush before changed topics are sent; use it to publish polled state.
+    // Register before begin().
+    void addSampler(Sampler sampler) { _samplers.push_back(sampler); }
+
+    // Thread-safe; cheap when the payload did not change. Payloads over
+    // EVENT_HUB_PAYLOAD_SIZE - 1 bytes are rejected.
+    bool publish(const char* topic, const char* json);
+    bool publish(const char* topic, const String& json) { return publish(topic, json.c_str()); }
+
+    bool begin();
+    void stop();
+
+    uint32_t sent() const { return _sent; }
+    uint32_t coalesced() const { return _coalesced; }
+    uint32_t deferred() const { return _deferred; }
+
+private:
+    struct Topic {
+        char name[16];
+        char payload[EVENT_HUB_PAYLOAD_SIZE];
+        bool pending;
+    };
+
+    const char* _url;
+#ifdef JARVIS_HTTPD
+    httpd_handle_t _server = nullptr;
+    int _clients[EVENT_HUB_MAX_CLIENTS] = {};
+    volatile uint8_t _clientCount = 0;
+    char _frame[EVENT_HUB_PAYLOAD_SIZE + 48];   // one formatted event, written by the server task
+    size_t _frameLength = 0;
+    SemaphoreHandle_t _frameSent = nullptr;
+#else
+    AsyncEventSource _source;
+#endif
+    Topic _topics[EVENT_HUB_MAX_TOPICS] = {};
+    uint8_t _topicCount = 0;
+    std::vector<Sampler> _samplers;
+    SemaphoreHandle_t _lock = nullptr;
+    TaskHandle_t _taskHandle = nullptr;
+    volatile bool _running = false;
+    uint16_t _intervalMs = 250;
+    uint32_t _eventId = 0;
+    volatile uint32_t _sent = 0;
+    volatile uint32_t _coalesced = 0;   // updates replaced before they were sent
+    volatile uint32_t _deferred = 0;    // flushes skipped because clients were behind
+
+    static void flushTask(void* param);
+    void flushLoop();
+    void flush();
+    void send(const char* payload, const char* topic);
+#ifdef JARVIS_HTTPD
+    static size_t format(char* out, size_t size, const char* payload, const char* topic, uint32_t id);
+    static void writeFrame(void* param);
+#else
+    void sendSnapshot(AsyncEventSourceClient* client);
+#endif
+};
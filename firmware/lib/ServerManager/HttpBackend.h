@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+
+// The network side of ServerManager: owns the listening server, wraps each native
+// request in an HttpRequest and runs it through the server's routes, static assets
+// and event streams. Exactly one backend is compiled in:
+//   AsyncBackend - ESPAsyncWebServer/AsyncTCP (default)
+//   IdfBackend   - ESP-IDF esp_http_server with a fixed worker pool (-D JARVIS_HTTPD)
+class HttpBackend {
+public:
+    virtual ~HttpBackend() {}
+
+    virtual const char* name() const = 0;
+
+    // Starts listening. Routes are compiled, the FS is mounted and the static asset
+    // manifest is loaded by then.
+    virtual bool begin() = 0;
+};
@@ -0,0 +1,218 @@
+#ifdef JARVIS_HTTPD
+#include "IdfBackend.h"
+#include "HttpError.h"
+#include <unistd.h>
+
+bool IdfBackend::begin() {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = _port;
+    config.max_open_sockets = HTTPD_MAX_SOCKETS;
+    config.lru_purge_enable = true;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    config.global_user_ctx = this;
+    config.global_user_ctx_free_fn = [](void*) {};   // not heap memory
+    config.close_fn = onClose;
+#if !HTTPD_ASYNC_WORKERS
+    config.stack_size = HTTPD_WORKER_STACK;          // handlers run on the server task
+#endif
+    if (httpd_start(&_handle, &config) != ESP_OK) return false;
+
+    // One catch-all per method; the route trie does the matching
+    static const httpd_method_t methods[] = { HTTP_GET, HTTP_POST, HTTP_DELETE };
+    for (httpd_method_t method : methods) {
+        httpd_uri_t uri = {};
+        uri.uri = "/*";
+        uri.method = method;
+        uri.handler = onRequest;
+        uri.user_ctx = this;
+        httpd_register_uri_handler(_handle, &uri);
+    }
+
+    for (EventHub* hub : _server->_eventHubs) {
+        if (!hub->begin()) Serial.println("⚠️ Failed to start event stream");
+    }
+
+#if HTTPD_ASYNC_WORKERS
+    // Every request admission control lets through fits the queue
+    _queue = xQueueCreate(ADMISSION_MAX_IN_FLIGHT, sizeof(httpd_req_t*));
+    if (!_queue) return false;
+    for (uint8_t i = 0; i < HTTPD_WORKERS; i++) {
+        // Below the server task (5), so accepting and admitting is never starved
+        if (xTaskCreatePinnedToCore(workerTask, "HttpWorker", HTTPD_WORKER_STACK, this, 4, nullptr, 1) != pdPASS)
+            return false;
+    }
+    Serial.printf("🧵 %u HTTP workers\n", (unsigned)HTTPD_WORKERS);
+#else
+    Serial.println("⚠️ No async request handlers before ESP-IDF 5.1; requests run one at a time on the server task");
+#endif
+    return true;
+}
+
+esp_err_t IdfBackend::onRequest(httpd_req_t* request) {
+    return static_cast<IdfBackend*>(request->user_ctx)->accept(request);
+}
+
+// Sessions close on the server task; event streams forget the socket before its
+// descriptor can be reused
+void IdfBackend::onClose(httpd_handle_t handle, int fd) {
+    IdfBackend* backend = static_cast<IdfBackend*>(httpd_get_global_user_ctx(handle));
+    for (EventHub* hub : backend->_server->_eventHubs) hub->closed(fd);
+    close(fd);
+}
+
+void IdfBackend::workerTask(void* param) {
+    IdfBackend* backend = static_cast<IdfBackend*>(param);
+    char sendBuffer[HTTPD_CHUNK_SIZE];   // responses waiting for the dispatch lock to be released
+    httpd_req_t* request;
+    for (;;) {
+        if (xQueueReceive(backend->_queue, &request, portMAX_DELAY) == pdTRUE) backend->serve(request, sendBuffer);
+    }
+}
+
+// Server task: event streams, admission and the hand-off to a worker. Nothing here
+// waits for the client.
+esp_err_t IdfBackend::accept(httpd_req_t* request) {
+    IdfHttpRequest probe(request);
+    if (probe.method() == HttpMethod::Get) {
+        for (EventHub* hub : _server->_eventHubs) {
+            if (probe.url() == hub->url()) return hub->accept(request) ? ESP_OK : ESP_FAIL;
+        }
+    }
+
+    const RoutePlan* plan = _server->findRoute(probe);
+    httpd_req_t* work = request;
+#if HTTPD_ASYNC_WORKERS
+    if (httpd_req_async_handler_begin(request, &work) != ESP_OK) {
+        HttpError(503, "Server busy, try again", _server->_admission.retryAfter()).send(&probe);
+        return ESP_OK;
+    }
+#endif
+
+    // Static files are not admitted, as with the other backend
+    if (plan && _server->_admission.admit(work, plan->admissionGroup) != AdmissionControl::Verdict::Admitted) {
+        IdfHttpRequest rejected(work);
+        _server->sendError(plan, &rejected, 503, "Server busy, try again");
+        complete(work);
+        return ESP_OK;
+    }
+
+#if HTTPD_ASYNC_WORKERS
+    if (xQueueSend(_queue, &work, 0) != pdTRUE) {
+        _server->_admission.release(work);
+        IdfHttpRequest rejected(work);
+        HttpError(503, "Server busy, try again", _server->_admission.retryAfter()).send(&rejected);
+        complete(work);
+    }
+#else
+    // One request at a time, so there is nothing to gain from sending after the lock
+    serve(work, nullptr);
+#endif
+    return ESP_OK;
+}
+
+// Worker (or server task without async handlers): the whole request, start to end
+void IdfBackend::serve(httpd_req_t* native, char* sendBuffer) {
+    IdfHttpRequest request(native, sendBuffer);
+    const RoutePlan* plan = _server->findRoute(request);
+
+    if (!plan) {
+        const StaticAssetHandler& assets = _server->_staticAssets;
+        bool served;
+        if (_server->_hasAssetManifest) {
+            served = assets.canHandle(request);
+            if (served) assets.handle(request);
+        } else {
+            served = assets.serveFile(request);
+        }
+        if (!served) HttpError(404, "Not found").send(&request);
+    } else if (plan->route->bodyHandler || plan->route->chunkHandler) {
+        receive(plan, request);
+    } else {
+        _server->dispatch(plan, &request);
+    }
+
+    // Files and buffered answers are sent here, outside the dispatch lock, while
+    // the other workers dispatch
+    request.finish();
+    _server->_admission.release(native);
+    complete(native);
+}
+
+// httpd_req_recv, retried on socket timeouts; <= 0 when the client is gone
+static int receiveChunk(httpd_req_t* request, uint8_t* buffer, size_t length) {
+    for (uint8_t attempt = 0; attempt < 3; attempt++) {
+        int received = httpd_req_recv(request, reinterpret_cast<char*>(buffer), length);
+        if (received != HTTPD_SOCK_ERR_TIMEOUT) return received;
+    }
+    return -1;
+}
+
+// The body is read on the worker, so a slow upload holds only its own worker.
+// Content-Length is known up front: oversized bodies are refused before reading.
+void IdfBackend::receive(const RoutePlan* plan, IdfHttpRequest& request) {
+    httpd_req_t* native = request.native();
+    size_t total = native->content_len;
+
+    if (plan->maxBody && total > plan->maxBody) {
+        _server->sendError(plan, &request, 413, "Payload too large");
+        return;
+    }
+    try {
+        _server->checkGuards(plan, &request);
+    } catch (const HttpError& e) {
+        _server->sendError(plan, &request, e.statusCode(), e.message());
+        return;
+    }
+
+    if (plan->route->bodyHandler) {
+        static const uint8_t empty[1] = { 0 };
+        if (total == 0) {
+            _server->dispatch(plan, &request, empty, 0, true);
+            return;
+        }
+        int slot = _server->_bodies.acquire();
+        if (slot < 0) {
+            _server->sendError(plan, &request, 503, "Server busy, try again");
+            return;
+        }
+        uint8_t* buffer = _server->_bodies.buffer(slot);
+        size_t length = 0;
+        while (length < total) {
+            int received = receiveChunk(native, buffer + length, total - length);
+            if (received <= 0) break;
+            length += received;
+        }
+        if (length == total) {
+            buffer[length] = '\0';
+            _server->dispatch(plan, &request, buffer, length, true);
+        }
+        _server->_bodies.release(slot);
+        return;
+    }
+
+    uint8_t chunk[HTTPD_CHUNK_SIZE];
+    for (size_t index = 0; index < total; ) {
+        size_t wanted = total - index < sizeof(chunk) ? total - index : sizeof(chunk);
+        int received = receiveChunk(native, chunk, wanted);
+        if (received <= 0) return;   // client gone, nobody to answer
+        try {
+            ServerManager::DispatchLock lock(_server->_dispatchLock);
+            plan->route->chunkHandler(&request, chunk, received, index, total);
+        } catch (const HttpError& e) {
+            _server->sendError(plan, &request, e.statusCode(), e.message());
+            return;
+        } catch (const std::exception& e) {
+            _server->sendError(plan, &request, 500, e.what());
+            return;
+        }
+        index += received;
+    }
+    _server->dispatch(plan, &request, nullptr, total, true);
+}
+
+void IdfBackend::complete(httpd_req_t* request) {
+#if HTTPD_ASYNC_WORKERS
+    httpd_req_async_handler_complete(request);
+#endif
+}
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+#ifdef JARVIS_HTTPD
+#include <Arduino.h>
+#include <esp_http_server.h>
+#include "HttpBackend.h"
+#include "IdfHttpRequest.h"
+#include "ServerManager.h"
+
+// Worker tasks that run requests, and their stack; override with -D HTTPD_WORKERS=...
+#ifndef HTTPD_WORKERS
+#define HTTPD_WORKERS 2
+#endif
+#ifndef HTTPD_WORKER_STACK
+#define HTTPD_WORKER_STACK 10240
+#endif
+// Sockets open at once; the least recently used one is closed for a new client
+#ifndef HTTPD_MAX_SOCKETS
+#define HTTPD_MAX_SOCKETS 7
+#endif
+
+// HttpBackend over ESP-IDF's esp_http_server, selected with -D JARVIS_HTTPD.
+// Sockets, the header buffer, the worker stacks and the hand-off queue are allocated
+// once in begin(); ESPAsyncWebServer allocates a request object, its headers and the
+// response for every request instead. The server task parses headers, answers event
+// streams and admits the request; one of HTTPD_WORKERS tasks then reads the body,
+// runs the pipeline and sends the response, the latter after the dispatch lock is
+// released. WebSockets are not supported.
+class IdfBackend : public HttpBackend {
+public:
+    IdfBackend(ServerManager* server, uint16_t port) : _server(server), _port(port) {}
+
+    const char* name() const override { return "httpd"; }
+    bool begin() override;
+
+private:
+    using RoutePlan = ServerManager::RoutePlan;
+
+    ServerManager* _server;
+    uint16_t _port;
+    httpd_handle_t _handle = nullptr;
+    QueueHandle_t _queue = nullptr;        // admitted requests waiting for a worker
+
+    static esp_err_t onRequest(httpd_req_t* request);
+    static void onClose(httpd_handle_t handle, int fd);
+    static void workerTask(void* param);
+    esp_err_t accept(httpd_req_t* request);
+    void serve(httpd_req_t* request, char* sendBuffer);
+    void receive(const RoutePlan* plan, IdfHttpRequest& request);
+    static void complete(httpd_req_t* request);
+};
+#endif
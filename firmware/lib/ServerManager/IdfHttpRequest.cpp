@@ -0,0 +1,221 @@
+#ifdef JARVIS_HTTPD
+#include "IdfHttpRequest.h"
+
+IdfHttpRequest::IdfHttpRequest(httpd_req_t* request, char* sendBuffer)
+    : _request(request), _sendBuffer(sendBuffer) {
+    const char* uri = request->uri;
+    const char* query = strchr(uri, '?');
+    _url = decode(uri, query ? query - uri : strlen(uri), false);
+}
+
+HttpMethod IdfHttpRequest::method() const {
+    switch (_request->method) {
+        case HTTP_GET:     return HttpMethod::Get;
+        case HTTP_POST:    return HttpMethod::Post;
+        case HTTP_DELETE:  return HttpMethod::Delete;
+        case HTTP_PUT:     return HttpMethod::Put;
+        case HTTP_PATCH:   return HttpMethod::Patch;
+        case HTTP_HEAD:    return HttpMethod::Head;
+        case HTTP_OPTIONS: return HttpMethod::Options;
+        default:           return HttpMethod::Other;
+    }
+}
+
+const IdfHttpRequest::Lookup& IdfHttpRequest::lookup(const char* name, bool header) const {
+    for (uint8_t i = 0; i < _lookupCount; i++) {
+        const Lookup& entry = _lookups[i];
+        if (entry.header == header && (header ? entry.name.equalsIgnoreCase(name) : entry.name == name))
+            return entry;
+    }
+
+    Lookup& entry = _lookups[_lookupCount < HTTPD_MAX_LOOKUPS ? _lookupCount++ : HTTPD_MAX_LOOKUPS - 1];
+    entry.name = name;
+    entry.value = "";
+    entry.header = header;
+    entry.found = false;
+
+    if (header) {
+        // Bounded by CONFIG_HTTPD_MAX_REQ_HDR_LEN
+        size_t length = httpd_req_get_hdr_value_len(_request, name);
+        if (length) {
+            char value[length + 1];
+            if (httpd_req_get_hdr_value_str(_request, name, value, sizeof(value)) == ESP_OK) {
+                entry.value = value;
+                entry.found = true;
+            }
+        }
+    } else {
+        size_t length = httpd_req_get_url_query_len(_request);
+        if (length) {
+            char query[length + 1];
+            char value[length + 1];
+            if (httpd_req_get_url_query_str(_request, query, sizeof(query)) == ESP_OK &&
+                httpd_query_key_value(query, name, value, sizeof(value)) == ESP_OK) {
+                entry.value = decode(value, strlen(value), true);
+                entry.found = true;
+            }
+        }
+    }
+    return entry;
+}
+
+void IdfHttpRequest::send(HttpResponse& response) {
+    switch (response.body()) {
+        case HttpResponse::Body::Empty:
+        case HttpResponse::Body::Text:
+            if (_sendBuffer) {
+                keep(response);
+                break;
+            }
+            writeHead(response);
+            httpd_resp_send(_request, response.text().c_str(), response.text().length());
+            break;
+        case HttpResponse::Body::Stream: {
+            // Writers may point at the handler's state: run them now
+            char local[HTTPD_CHUNK_SIZE];
+            ChunkPrint out(*this, response, _sendBuffer ? _sendBuffer : local);
+            response.writer()(out);
+            if (_sendBuffer && !out.chunked()) {
+                _pendingLength = out.used();
+                keep(response);
+            } else {
+                out.end();
+            }
+            break;
+        }
+        case HttpResponse::Body::Fill:
+            // Pulled by finish(), so a slow client does not hold the dispatch lock
+            keep(response);
+            break;
+    }
+}
+
+// The head is written by finish() too: esp_http_server keeps pointers to the headers
+void IdfHttpRequest::keep(HttpResponse& response) {
+    _pending = std::move(response);
+    _hasPending = true;
+    _answered = true;
+}
+
+void IdfHttpRequest::finish() {
+    if (!_hasPending) return;
+    _hasPending = false;
+
+    writeHead(_pending);
+    switch (_pending.body()) {
+        case HttpResponse::Body::Empty:
+        case HttpResponse::Body::Text:
+            httpd_resp_send(_request, _pending.text().c_str(), _pending.text().length());
+            break;
+        case HttpResponse::Body::Stream:
+            httpd_resp_send(_request, _sendBuffer, _pendingLength);
+            break;
+        case HttpResponse::Body::Fill:
+            sendFilled();
+            break;
+    }
+    _pending = HttpResponse();   // closes files held by the filler
+}
+
+void IdfHttpRequest::sendFilled() {
+    uint8_t buffer[HTTPD_CHUNK_SIZE];
+    size_t length = _pending.length();
+    for (size_t index = 0; length == HttpResponse::UNKNOWN_LENGTH || index < length; ) {
+        size_t written = _pending.filler()(buffer, sizeof(buffer), index);
+        if (written == HttpResponse::FILL_LATER) {
+#if HTTPD_ASYNC_WORKERS
+            // Long-poll: this worker waits, the other ones keep serving
+            vTaskDelay(pdMS_TO_TICKS(HTTPD_FILL_RETRY_MS));
+            continue;
+#else
+            break;   // the server task would stall every client; canWait() is false
+#endif
+        }
+        if (written == 0) break;
+        if (httpd_resp_send_chunk(_request, reinterpret_cast<const char*>(buffer), written) != ESP_OK) return;
+        index += written;
+    }
+    httpd_resp_send_chunk(_request, nullptr, 0);
+}
+
+void IdfHttpRequest::writeHead(const HttpResponse& response) {
+    snprintf(_statusLine, sizeof(_statusLine), "%d %s", response.status(), reason(response.status()));
+    httpd_resp_set_status(_request, _statusLine);
+    httpd_resp_set_type(_request, response.contentType());
+    for (const auto& header : response.headers())
+        httpd_resp_set_hdr(_request, header.first.c_str(), header.second.c_str());
+    _answered = true;
+}
+
+size_t IdfHttpRequest::ChunkPrint::write(const uint8_t* data, size_t size) {
+    for (size_t written = 0; written < size; ) {
+        if (_used == sizeof(_buffer)) flush();
+        size_t room = sizeof(_buffer) - _used;
+        size_t count = size - written < room ? size - written : room;
+        memcpy(_buffer + _used, data + written, count);
+        _used += count;
+        written += count;
+    }
+    return size;
+}
+
+void IdfHttpRequest::ChunkPrint::flush() {
+    if (!_chunked) _owner.writeHead(_response);
+    if (_used && !_failed) _failed = httpd_resp_send_chunk(_owner._request, _buffer, _used) != ESP_OK;
+    _chunked = true;
+    _used = 0;
+}
+
+void IdfHttpRequest::ChunkPrint::end() {
+    if (!_chunked) {
+        _owner.writeHead(_response);
+        httpd_resp_send(_owner._request, _buffer, _used);
+        return;
+    }
+    flush();
+    if (!_failed) httpd_resp_send_chunk(_owner._request, nullptr, 0);
+}
+
+// %XX everywhere, '+' as space in query values
+String IdfHttpRequest::decode(const char* text, size_t length, bool plusIsSpace) {
+    String out;
+    out.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        if (c == '%' && i + 2 < length && isxdigit((unsigned char)text[i + 1]) && isxdigit((unsigned char)text[i + 2])) {
+            char hex[3] = { text[i + 1], text[i + 2], '\0' };
+            out += (char)strtol(hex, nullptr, 16);
+            i += 2;
+        } else {
+            out += plusIsSpace && c == '+' ? ' ' : c;
+        }
+    }
+    return out;
+}
+
+const char* IdfHttpRequest::reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 416: return "Range Not Satisfiable";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        case 507: return "Insufficient Storage";
+        default:  return "";
+    }
+}
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+#ifdef JARVIS_HTTPD
+#include <Arduino.h>
+#include <esp_http_server.h>
+#include <esp_idf_version.h>
+#include "../../include/HttpRequest.h"
+
+// Header and query lookups kept per request; the last slot is reused beyond that
+#ifndef HTTPD_MAX_LOOKUPS
+#define HTTPD_MAX_LOOKUPS 8
+#endif
+// Bytes per chunk for streamed and filled response bodies and streamed uploads
+#ifndef HTTPD_CHUNK_SIZE
+#define HTTPD_CHUNK_SIZE 1024
+#endif
+// Requests are handed from the server task to the workers with
+// httpd_req_async_handler_begin (ESP-IDF 5.1+). Older cores, including the IDF 4.4
+// under Arduino-ESP32 2.x, have no way to finish a request on another task: every
+// request runs on the server task, one at a time, and HTTPD_WORKERS is unused.
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define HTTPD_ASYNC_WORKERS 1
+#else
+#define HTTPD_ASYNC_WORKERS 0
+#endif
+// Pause before asking a filler that answered FILL_LATER again
+#ifndef HTTPD_FILL_RETRY_MS
+#define HTTPD_FILL_RETRY_MS 50
+#endif
+
+// HttpRequest over an esp_http_server request. Headers stay in the server's scratch
+// buffer; a header or query parameter is copied out the first time it is asked for.
+// Filled responses (files) are kept and pulled by finish(), after the dispatch lock
+// was released. With a send buffer (HTTPD_CHUNK_SIZE bytes, one per worker), text
+// bodies and streamed bodies that fit it are kept for finish() as well, so a slow
+// client holds only its worker; otherwise they are written in send().
+class IdfHttpRequest : public HttpRequest {
+public:
+    explicit IdfHttpRequest(httpd_req_t* request, char* sendBuffer = nullptr);
+
+    HttpMethod method() const override;
+    const String& url() const override { return _url; }
+    bool hasParam(const char* name) const override { return lookup(name, false).found; }
+    const String& param(const char* name) const override { return lookup(name, false).value; }
+    bool hasHeader(const char* name) const override { return lookup(name, true).found; }
+    const String& header(const char* name) const override { return lookup(name, true).value; }
+    const void* id() const override { return _request; }
+    bool canWait() const override { return HTTPD_ASYNC_WORKERS; }   // on the server task otherwise
+
+    void send(HttpResponse& response) override;
+
+    // Sends a response that send() kept back; no-op otherwise
+    void finish();
+
+    bool answered() const { return _answered; }
+    httpd_req_t* native() const { return _request; }
+
+private:
+    struct Lookup {
+        String name;
+        String value;
+        bool header;
+        bool found;
+    };
+
+    // Print that sends in chunks of HTTPD_CHUNK_SIZE, writing the head before the
+    // first one; a body that fits one chunk goes out with Content-Length instead
+    class ChunkPrint : public Print {
+    public:
+        ChunkPrint(IdfHttpRequest& owner, const HttpResponse& response, char* buffer)
+            : _owner(owner), _response(response), _buffer(buffer) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* data, size_t size) override;
+        bool chunked() const { return _chunked; }
+        size_t used() const { return _used; }
+        void end();
+    private:
+        IdfHttpRequest& _owner;
+        const HttpResponse& _response;
+        char* _buffer;                     // HTTPD_CHUNK_SIZE bytes
+        size_t _used = 0;
+        bool _chunked = false;
+        bool _failed = false;
+        void flush();
+    };
+
+    httpd_req_t* _request;
+    char* _sendBuffer;
+    String _url;
+    mutable Lookup _lookups[HTTPD_MAX_LOOKUPS];
+    mutable uint8_t _lookupCount = 0;
+    char _statusLine[40];                  // esp_http_server keeps the pointer until sent
+    HttpResponse _pending;
+    size_t _pendingLength = 0;             // streamed body waiting in _sendBuffer
+    bool _hasPending = false;
+    bool _answered = false;
+
+    const Lookup& lookup(const char* name, bool header) const;
+    void keep(HttpResponse& response);
+    void sendFilled();
+    void writeHead(const HttpResponse& response);
+    static String decode(const char* text, size_t length, bool plusIsSpace);
+    static const char* reason(int status);
+};
+#endif
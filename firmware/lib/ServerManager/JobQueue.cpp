@@ -0,0 +1,157 @@
+#include "JobQueue.h"
+#include "HttpError.h"
+
+bool JobQueue::begin() {
+    if (_taskHandle) return true;
+
+    _lock = xSemaphoreCreateMutex();
+    _queue = xQueueCreate(JOB_QUEUE_DEPTH, sizeof(uint8_t));
+    if (!_lock || !_queue) return false;
+
+    // Core 1 next to the loop; low priority so it never starves the network stack
+    return xTaskCreatePinnedToCore(workerTask, "JobTask", 6144, this, 1, &_taskHandle, 1) == pdPASS;
+}
+
+uint32_t JobQueue::submit(const char* name, Work work) {
+    if (!_queue) throw HttpError(503, "Job queue not running");
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    // A free slot, otherwise the job that finished longest ago
+    int8_t slot = -1;
+    for (uint8_t i = 0; i < JOB_QUEUE_SLOTS; i++) {
+        const Job& job = _jobs[i];
+        if (job.state == State::Free) { slot = i; break; }
+        if (job.state != State::Done && job.state != State::Failed) continue;
+        if (slot < 0 || (int32_t)(job.finishedAt - _jobs[slot].finishedAt) < 0) slot = i;
+    }
+    if (slot < 0 || uxQueueSpacesAvailable(_queue) == 0) {
+        xSemaphoreGive(_lock);
+        throw HttpError(503, "Job queue full, try again");
+    }
+
+    Job& job = _jobs[slot];
+    // Random ids: results can hold secrets (e.g. an access token) and must not be guessable
+    do { job.id = esp_random(); } while (job.id == 0);
+    strncpy(job.name, name, sizeof(job.name) - 1);
+    job.name[sizeof(job.name) - 1] = '\0';
+    job.state = State::Queued;
+    job.work = work;
+    job.status = 0;
+    job.error = "";
+    job.result = "";
+    job.submittedAt = millis();
+    uint32_t id = job.id;
+
+    uint8_t index = slot;
+    xQueueSend(_queue, &index, 0);
+    xSemaphoreGive(_lock);
+    return id;
+}
+
+bool JobQueue::info(uint32_t id, Info& out) const {
+    if (!_lock || id == 0) return false;
+    bool found = false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (const Job& job : _jobs) {
+        if (job.state == State::Free || job.id != id) continue;
+        copyInfo(job, out);
+        found = true;
+        break;
+    }
+    xSemaphoreGive(_lock);
+    return found;
+}
+
+void JobQueue::forEach(std::function<void(const Info&)> visit) const {
+    if (!_lock) return;
+    Info snapshot[JOB_QUEUE_SLOTS];
+    uint8_t count = 0;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (const Job& job : _jobs)
+        if (job.state != State::Free) copyInfo(job, snapshot[count++]);
+    xSemaphoreGive(_lock);
+    for (uint8_t i = 0; i < count; i++) visit(snapshot[i]);
+}
+
+void JobQueue::copyInfo(const Job& job, Info& out) const {
+    uint32_t now = millis();
+    out.id = job.id;
+    out.name = job.name;
+    out.state = job.state;
+    out.status = job.status;
+    out.error = job.error;
+    out.result = job.result;
+    out.queuedMs = (job.state == State::Queued ? now : job.startedAt) - job.submittedAt;
+    out.runMs = job.state == State::Queued ? 0 : (job.state == State::Running ? now : job.finishedAt) - job.startedAt;
+}
+
+HttpSuccess JobQueue::accepted(HttpRequest* request, uint32_t id) {
+    HttpResponse response(202, "application/json");
+    response.text("{\"ok\":true,\"data\":{\"id\":" + String(id) + "}}");
+    response.header("Location", "/jobs/" + String(id));
+    return HttpSuccess(std::move(response));
+}
+
+const char* JobQueue::stateName(State state) {
+    switch (state) {
+        case State::Queued:  return "queued";
+        case State::Running: return "running";
+        case State::Done:    return "done";
+        case State::Failed:  return "failed";
+        default:             return "free";
+    }
+}
+
+void JobQueue::workerTask(void* param) {
+    static_cast<JobQueue*>(param)->workerLoop();
+}
+
+void JobQueue::workerLoop() {
+    uint8_t slot;
+    while (true) {
+        if (xQueueReceive(_queue, &slot, portMAX_DELAY) == pdTRUE) run(slot);
+    }
+}
+
+void JobQueue::run(uint8_t slot) {
+    Job& job = _jobs[slot];
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    job.state = State::Running;
+    job.startedAt = millis();
+    Work work = std::move(job.work);
+    job.work = nullptr;
+    xSemaphoreGive(_lock);
+
+    DynamicJsonDocument result(1024);
+    State state = State::Done;
+    int16_t status = 200;
+    String error;
+    try {
+        work(result);
+    } catch (const HttpError& e) {
+        state = State::Failed;
+        status = e.statusCode();
+        error = e.message();
+    } catch (const std::exception& e) {
+        state = State::Failed;
+        status = 500;
+        error = e.what();
+    } catch (...) {
+        state = State::Failed;
+        status = 500;
+        error = "Unknown error";
+    }
+
+    String serialized;
+    if (state == State::Done && !result.isNull()) serializeJson(result, serialized);
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    job.state = state;
+    job.status = status;
+    job.error = error;
+    job.result = serialized;
+    job.finishedAt = millis();
+    xSemaphoreGive(_lock);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include "HttpSuccess.h"
+
+// Job records kept (queued, running and finished); override with -D JOB_QUEUE_SLOTS=...
+#ifndef JOB_QUEUE_SLOTS
+#define JOB_QUEUE_SLOTS 8
+#endif
+// Jobs waiting for the worker before submit() answers 503
+#ifndef JOB_QUEUE_DEPTH
+#define JOB_QUEUE_DEPTH 4
+#endif
+
+// Runs slow work (Wi-Fi connects, file system scans, ...) on one worker task so it
+// never blocks the AsyncTCP task. Handlers submit a job, answer 202 with its id and
+// clients poll GET /jobs/<id>. Finished jobs keep their result until the slot is
+// reused by a newer job.
+class JobQueue {
+public:
+    enum class State : uint8_t { Free, Queued, Running, Done, Failed };
+
+    // Fill `result` on success; throw HttpError to fail the job with a status and message
+    using Work = std::function<void(JsonDocument& result)>;
+
+    struct Info {
+        uint32_t id;
+        String name;
+        State state;
+        int16_t status;         // HTTP-style status of a failed job
+        String error;
+        String result;          // serialized JSON
+        uint32_t queuedMs;      // time spent waiting for the worker
+        uint32_t runMs;
+    };
+
+    bool begin();
+
+    // Returns the job id; throws HttpError(503) when JOB_QUEUE_DEPTH jobs are waiting
+    uint32_t submit(const char* name, Work work);
+
+    // Copies the job's current state; false for unknown or evicted ids
+    bool info(uint32_t id, Info& out) const;
+    void forEach(std::function<void(const Info&)> visit) const;
+
+    // 202 Accepted with the id and a Location to poll
+    static HttpSuccess accepted(HttpRequest* request, uint32_t id);
+    static const char* stateName(State state);
+
+private:
+    struct Job {
+        uint32_t id;
+        char name[24];
+        State state;
+        Work work;
+        int16_t status;
+        String error;
+        String result;
+        uint32_t submittedAt;
+        uint32_t startedAt;
+        uint32_t finishedAt;
+    };
+
+    Job _jobs[JOB_QUEUE_SLOTS] = {};
+    QueueHandle_t _queue = nullptr;
+    SemaphoreHandle_t _lock = nullptr;
+    TaskHandle_t _taskHandle = nullptr;
+
+    static void workerTask(void* param);
+    void workerLoop();
+    void run(uint8_t slot);
+    void copyInfo(const Job& job, Info& out) const;
+};
@@ -0,0 +1,207 @@
+#include "ResponseCache.h"
+
+namespace {
+const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+uint64_t fnv(uint64_t hash, const char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Appends what a handler writes to a String
+class StringPrint : public Print {
+public:
+    explicit StringPrint(String& out) : _out(out) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        _out.concat(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+private:
+    String& _out;
+};
+}
+
+int8_t ResponseCache::addRoute(uint32_t ttlMs, const std::vector<String>& configKeys) {
+    Route route;
+    route.ttlMs = ttlMs;
+    route.configKeys = configKeys;
+    route.generation = 0;
+    _routes.push_back(route);
+    return _routes.size() - 1;
+}
+
+// Route, path, the query parameters the route reads, encoding and, for guarded routes,
+// the credentials the client sent: two clients with different tokens never share an entry
+uint64_t ResponseCache::keyFor(int8_t route, HttpRequest* request, bool identified) const {
+    uint64_t hash = FNV_OFFSET;
+    char prefix[2] = { (char)route, (char)request->acceptsMsgPack() };
+    hash = fnv(hash, prefix, sizeof(prefix));
+    hash = fnv(hash, request->url().c_str(), request->url().length() + 1);
+    for (const String& name : _routes[route].queryKeys) {
+        // ?a= and no a at all are different requests
+        char present = request->hasParam(name.c_str());
+        hash = fnv(hash, &present, 1);
+        if (present) {
+            const String& value = request->param(name.c_str());
+            hash = fnv(hash, value.c_str(), value.length() + 1);
+        }
+    }
+    if (identified) {
+        const String& authorization = request->header("Authorization");
+        const String& cookie = request->header("Cookie");
+        hash = fnv(hash, authorization.c_str(), authorization.length() + 1);
+        hash = fnv(hash, cookie.c_str(), cookie.length());
+    }
+    return hash;
+}
+
+bool ResponseCache::fresh(const Entry& entry) const {
+    const Route& route = _routes[entry.route];
+    return entry.generation == route.generation && millis() - entry.storedAt < route.ttlMs;
+}
+
+const ResponseCache::Entry* ResponseCache::find(int8_t route, HttpRequest* request, bool identified) {
+    uint64_t key = keyFor(route, request, identified);
+    for (Entry& entry : _entries) {
+        if (entry.route == route && entry.key == key && fresh(entry)) {
+            _hits++;
+            return &entry;
+        }
+    }
+    _misses++;
+    return nullptr;
+}
+
+const ResponseCache::Entry* ResponseCache::store(int8_t route, HttpRequest* request, bool identified,
+                                                 const Capture& capture) {
+    // Entries stored before the handler read this parameter are keyed without it
+    if (!capture.newQueryKeys().empty()) {
+        for (const String& name : capture.newQueryKeys()) _routes[route].queryKeys.push_back(name);
+        _routes[route].generation++;
+        drop(route);
+    }
+    if (capture.body().length() > RESPONSE_CACHE_MAX_BODY) return nullptr;
+
+    // A stale entry of the same request, a free slot, an expired one, or the oldest
+    uint64_t key = keyFor(route, request, identified);
+    Entry* slot = nullptr;
+    for (Entry& entry : _entries) {
+        if (entry.route == route && entry.key == key) { slot = &entry; break; }
+    }
+    for (Entry& entry : _entries) {
+        if (slot) break;
+        if (entry.route < 0 || !fresh(entry)) slot = &entry;
+    }
+    if (!slot) {
+        slot = &_entries[0];
+        for (Entry& entry : _entries)
+            if (millis() - entry.storedAt > millis() - slot->storedAt) slot = &entry;
+    }
+
+    uint32_t digest = (uint32_t)fnv(FNV_OFFSET, capture.body().c_str(), capture.body().length());
+    char etag[12];
+    snprintf(etag, sizeof(etag), "\"%08x\"", (unsigned)digest);
+
+    slot->route = route;
+    slot->key = key;
+    slot->generation = _routes[route].generation;
+    slot->storedAt = millis();
+    slot->contentType = capture.contentType();
+    slot->etag = etag;
+    slot->body = capture.body();
+    return slot;
+}
+
+int ResponseCache::send(const Entry& entry, HttpRequest* request) {
+    // no-cache: browsers revalidate every time, so a config change is seen at once
+    if (request->header("If-None-Match") == entry.etag) {
+        HttpResponse notModified(304, entry.contentType);
+        notModified.header("ETag", entry.etag).header("Cache-Control", "private, no-cache");
+        request->send(notModified);
+        return 304;
+    }
+
+    const Entry* cached = &entry;
+    HttpResponse response(200, entry.contentType);
+    response.header("ETag", entry.etag).header("Cache-Control", "private, no-cache");
+    response.stream(entry.body.length(), [cached](Print& out) { out.print(cached->body); });
+    request->send(response);
+    return 200;
+}
+
+// "wifi" is related to "wifi" and "wifi.ssid", and "wifi.ssid" to "wifi"
+bool ResponseCache::related(const String& a, const String& b) {
+    const String& shorter = a.length() <= b.length() ? a : b;
+    const String& longer = a.length() <= b.length() ? b : a;
+    if (!longer.startsWith(shorter)) return false;
+    return longer.length() == shorter.length() || longer[shorter.length()] == '.';
+}
+
+void ResponseCache::invalidate(const String& configKey) {
+    for (size_t r = 0; r < _routes.size(); r++) {
+        bool depends = false;
+        for (const String& key : _routes[r].configKeys) depends = depends || related(key, configKey);
+        if (!depends) continue;
+
+        _routes[r].generation++;
+        _invalidations++;
+        drop(r);
+    }
+}
+
+void ResponseCache::drop(int8_t route) {
+    for (Entry& entry : _entries) {
+        if (entry.route != route) continue;
+        entry.route = -1;
+        entry.body = String();
+    }
+}
+
+void ResponseCache::clear() {
+    for (Route& route : _routes) route.generation++;
+    for (Entry& entry : _entries) {
+        entry.route = -1;
+        entry.body = String();
+    }
+}
+
+size_t ResponseCache::used() const {
+    size_t count = 0;
+    for (const Entry& entry : _entries)
+        if (entry.route >= 0 && fresh(entry)) count++;
+    return count;
+}
+
+void ResponseCache::Capture::noteParam(const char* name) const {
+    for (const String& known : _queryKeys)
+        if (known == name) return;
+    for (const String& known : _newQueryKeys)
+        if (known == name) return;
+    _newQueryKeys.push_back(name);
+}
+
+// Only plain 200 answers with a body written up front are kept: no custom headers
+// (cookies), no file fillers. Everything else goes straight to the client.
+void ResponseCache::Capture::send(HttpResponse& response) {
+    bool cacheable = response.status() == 200 && response.headers().empty() &&
+                     (response.body() == HttpResponse::Body::Text || response.body() == HttpResponse::Body::Stream);
+    if (!cacheable) {
+        _target->send(response);
+        return;
+    }
+
+    _captured = true;
+    _contentType = response.contentType();
+    if (response.body() == HttpResponse::Body::Text) {
+        _body = response.text();
+    } else {
+        _body.reserve(response.length());
+        StringPrint out(_body);
+        response.writer()(out);
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "../../include/HttpRequest.h"
+
+// Cached responses kept at once, and the largest body that is cached
+#ifndef RESPONSE_CACHE_SLOTS
+#define RESPONSE_CACHE_SLOTS 8
+#endif
+#ifndef RESPONSE_CACHE_MAX_BODY
+#define RESPONSE_CACHE_MAX_BODY 1024
+#endif
+
+// Serialized 200 responses of GET routes that opted in with Router::cache(). Entries
+// are keyed by route, path, the query parameters the handler reads, client identity
+// (token header/cookie of guarded routes) and encoding, expire after the route's TTL
+// and carry an ETag for 304 answers. Query parameter names are learned from the
+// handler's hasParam()/param() calls; a newly seen name drops the route's entries.
+// Other headers a handler reads are not part of the key.
+// A config change drops every entry of the routes that declared that key.
+// Only used under ServerManager's dispatch lock.
+class ResponseCache {
+public:
+    ResponseCache() {
+        for (Entry& entry : _entries) entry.route = -1;
+    }
+
+    struct Entry {
+        int8_t route;                   // -1 = free slot
+        uint64_t key;
+        uint32_t generation;            // route generation the entry was built in
+        uint32_t storedAt;
+        const char* contentType;        // literal, see HttpResponse
+        String etag;                    // quoted, ready for the header
+        String body;
+    };
+
+    // Registers a cached route; returns its id for RoutePlan
+    int8_t addRoute(uint32_t ttlMs, const std::vector<String>& configKeys);
+
+    // Fresh entry for this request, or nullptr
+    const Entry* find(int8_t route, HttpRequest* request, bool identified);
+
+    // Wraps the request while the handler runs: notes which query parameters it reads
+    // and forwards the response unless it can be cached, in which case the body is
+    // captured for store()
+    class Capture;
+
+    // Query parameter names in the key of a route's entries
+    const std::vector<String>& queryKeys(int8_t route) const { return _routes[route].queryKeys; }
+
+    // Stores the captured response; returns the entry to send from, or nullptr if it
+    // could not be kept (too large)
+    const Entry* store(int8_t route, HttpRequest* request, bool identified, const Capture& capture);
+
+    // 200 with ETag, or 304 when the client already has it; returns the status
+    static int send(const Entry& entry, HttpRequest* request);
+
+    void invalidate(const String& configKey);   // routes depending on the key
+    void clear();
+
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    uint32_t invalidations() const { return _invalidations; }
+    size_t used() const;
+
+private:
+    struct Route {
+        uint32_t ttlMs;
+        std::vector<String> configKeys;
+        std::vector<String> queryKeys;   // learned, see Capture
+        uint32_t generation;
+    };
+
+    std::vector<Route> _routes;
+    Entry _entries[RESPONSE_CACHE_SLOTS] = {};
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    uint32_t _invalidations = 0;
+
+    uint64_t keyFor(int8_t route, HttpRequest* request, bool identified) const;
+    static bool related(const String& a, const String& b);
+    bool fresh(const Entry& entry) const;
+    void drop(int8_t route);
+};
+
+class ResponseCache::Capture : public HttpRequest {
+public:
+    Capture(HttpRequest* target, const std::vector<String>& queryKeys)
+        : _target(target), _queryKeys(queryKeys) {
+        _pathParams = target->pathParams();
+        _authenticated = target->authenticated();
+    }
+
+    HttpMethod method() const override { return _target->method(); }
+    const String& url() const override { return _target->url(); }
+    bool hasParam(const char* name) const override { noteParam(name); return _target->hasParam(name); }
+    const String& param(const char* name) const override { noteParam(name); return _target->param(name); }
+    bool hasHeader(const char* name) const override { return _target->hasHeader(name); }
+    const String& header(const char* name) const override { return _target->header(name); }
+    const void* id() const override { return _target->id(); }
+
+    void send(HttpResponse& response) override;
+
+    bool captured() const { return _captured; }
+    const char* contentType() const { return _contentType; }
+    const String& body() const { return _body; }
+    // Parameters read that are not in the route's queryKeys yet
+    const std::vector<String>& newQueryKeys() const { return _newQueryKeys; }
+
+private:
+    HttpRequest* _target;
+    const std::vector<String>& _queryKeys;
+    mutable std::vector<String> _newQueryKeys;   // only allocates the first time a name is seen
+    bool _captured = false;
+    const char* _contentType = "";
+    String _body;
+
+    void noteParam(const char* name) const;
+};
@@ -0,0 +1,146 @@
+#include "RouteTrie.h"
+
+bool RouteTrie::insert(const String& pattern, HttpMethod method, int16_t value) {
+    if (_nodes.empty()) {
+        Node root;
+        root.kind = Kind::Literal;
+        root.firstChild = NONE;
+        root.nextSibling = NONE;
+        for (uint8_t m = 0; m < METHODS; m++) root.values[m] = NONE;
+        _nodes.push_back(root);
+    }
+
+    const char* path = pattern.c_str();
+    size_t end = pattern.length();
+    size_t pos = 0;
+    uint8_t params = 0;
+    int16_t node = 0;
+
+    while (pos < end) {
+        if (path[pos] == '/') { pos++; continue; }
+        size_t segEnd = pos;
+        while (segEnd < end && path[segEnd] != '/') segEnd++;
+
+        Kind kind = Kind::Literal;
+        const char* segment = path + pos;
+        size_t length = segEnd - pos;
+        if (*segment == ':' || *segment == '*') {
+            kind = *segment == ':' ? Kind::Param : Kind::Wildcard;
+            segment++;
+            length--;
+            if (kind == Kind::Param && length == 0) {
+                Serial.printf("  ⚠️ Unnamed parameter in %s\n", path);
+                return false;
+            }
+            if (kind == Kind::Wildcard && segEnd < end) {
+                Serial.printf("  ⚠️ Wildcard must be the last segment: %s\n", path);
+                return false;
+            }
+            if (++params > HTTP_MAX_PATH_PARAMS) {
+                Serial.printf("  ⚠️ Too many parameters in %s\n", path);
+                return false;
+            }
+        }
+
+        node = child(node, kind, segment, length);
+        if (node == NONE) {
+            Serial.printf("  ⚠️ Conflicting parameter names in %s\n", path);
+            return false;
+        }
+        pos = segEnd;
+    }
+
+    int16_t& slot = _nodes[node].values[(uint8_t)method];
+    if (slot != NONE) {
+        Serial.printf("  ⚠️ Route registered twice: %s\n", path);
+        return false;
+    }
+    slot = value;
+    return true;
+}
+
+// Child of parent with this kind and segment, created if missing. One parameter
+// or wildcard child per node: two names for the same position is a conflict (NONE).
+int16_t RouteTrie::child(int16_t parent, Kind kind, const char* segment, size_t length) {
+    int16_t last = NONE;
+    for (int16_t c = _nodes[parent].firstChild; c != NONE; c = _nodes[c].nextSibling) {
+        const Node& n = _nodes[c];
+        if (n.kind == kind) {
+            bool same = n.segment.length() == length && strncmp(n.segment.c_str(), segment, length) == 0;
+            if (same) return c;
+            if (kind != Kind::Literal) return NONE;
+        }
+        last = c;
+    }
+
+    Node n;
+    n.segment.concat(segment, length);
+    n.kind = kind;
+    n.firstChild = NONE;
+    n.nextSibling = NONE;
+    for (uint8_t m = 0; m < METHODS; m++) n.values[m] = NONE;
+    _nodes.push_back(n);
+
+    int16_t index = _nodes.size() - 1;
+    if (last == NONE) _nodes[parent].firstChild = index;
+    else _nodes[last].nextSibling = index;
+    return index;
+}
+
+int16_t RouteTrie::match(HttpMethod method, const String& path, PathParams& params) const {
+    params.count = 0;
+    if (_nodes.empty()) return NONE;
+    return find(0, (uint8_t)method, path.c_str(), 0, path.length(), params);
+}
+
+// Literal children first, then the parameter, then the wildcard. A later kind is
+// only tried when the earlier one has no route below it for this method.
+int16_t RouteTrie::find(int16_t node, uint8_t method, const char* path, size_t pos, size_t end,
+                        PathParams& params) const {
+    while (pos < end && path[pos] == '/') pos++;
+
+    int16_t param = NONE;
+    int16_t wildcard = NONE;
+    size_t segEnd = pos;
+    while (segEnd < end && path[segEnd] != '/') segEnd++;
+    size_t length = segEnd - pos;
+
+    if (pos == end) {
+        int16_t value = _nodes[node].values[method];
+        if (value != NONE) return value;
+    }
+
+    for (int16_t c = _nodes[node].firstChild; c != NONE; c = _nodes[c].nextSibling) {
+        const Node& n = _nodes[c];
+        if (n.kind == Kind::Param) { param = c; continue; }
+        if (n.kind == Kind::Wildcard) { wildcard = c; continue; }
+        if (pos == end || n.segment.length() != length || memcmp(n.segment.c_str(), path + pos, length) != 0)
+            continue;
+        int16_t value = find(c, method, path, segEnd, end, params);
+        if (value != NONE) return value;
+    }
+
+    if (param != NONE && pos < end) {
+        uint8_t slot = params.count++;
+        params.names[slot] = _nodes[param].segment.c_str();
+        params.values[slot].data = path + pos;
+        params.values[slot].length = length;
+        int16_t value = find(param, method, path, segEnd, end, params);
+        if (value != NONE) return value;
+        params.count = slot;
+    }
+
+    if (wildcard != NONE) {
+        int16_t value = _nodes[wildcard].values[method];
+        if (value != NONE) {
+            // The rest of the path, without a trailing slash
+            while (end > pos && path[end - 1] == '/') end--;
+            uint8_t slot = params.count++;
+            params.names[slot] = _nodes[wildcard].segment.length() ? _nodes[wildcard].segment.c_str() : "*";
+            params.values[slot].data = path + pos;
+            params.values[slot].length = end - pos;
+            return value;
+        }
+    }
+    return NONE;
+}
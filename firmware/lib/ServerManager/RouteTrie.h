@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "../../include/HttpRequest.h"
+
+// Route table of all mounted routers as a prefix tree of path segments. A pattern
+// segment is a literal, `:name` (one segment) or `*` / `*name` (the rest of the path,
+// last segment only). Literals win over parameters, parameters over wildcards.
+// Matching walks the path once and allocates nothing; the tree is built in begin()
+// and only read afterwards.
+class RouteTrie {
+public:
+    static const int16_t NONE = -1;
+
+    // Maps pattern + method to value (a route plan index). False, with a log line,
+    // if the pattern is malformed or the route is already taken.
+    bool insert(const String& pattern, HttpMethod method, int16_t value);
+
+    // Value of the matching route, or NONE; params receive views into path
+    int16_t match(HttpMethod method, const String& path, PathParams& params) const;
+
+    size_t nodeCount() const { return _nodes.size(); }
+
+private:
+    enum class Kind : uint8_t { Literal, Param, Wildcard };
+    static const uint8_t METHODS = (uint8_t)HttpMethod::Other + 1;
+
+    struct Node {
+        String segment;                 // literal text or parameter name
+        Kind kind;
+        int16_t firstChild;
+        int16_t nextSibling;
+        int16_t values[METHODS];        // per method, NONE when unrouted
+    };
+
+    std::vector<Node> _nodes;           // _nodes[0] is the root, "/"
+
+    int16_t child(int16_t parent, Kind kind, const char* segment, size_t length);
+    int16_t find(int16_t node, uint8_t method, const char* path, size_t pos, size_t end,
+                 PathParams& params) const;
+};
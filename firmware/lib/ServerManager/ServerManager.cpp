@@ -1,10 +1,23 @@
 #include "ServerManager.h"
+#ifdef JARVIS_HTTPD
+#include "IdfBackend.h"
+#else
+#include "AsyncBackend.h"
+#endif
 #include "HttpError.h"
 #include "HttpSuccess.h"
+#include "JsonPool.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <new>
 
-ServerManager::ServerManager(uint16_t port) : _server(port) {}
+ServerManager::ServerManager(uint16_t port)
+#ifdef JARVIS_HTTPD
+    : _backend(new IdfBackend(this, port)),
+#else
+    : _backend(new AsyncBackend(this, port)),
+#endif
+      _dispatchLock(xSemaphoreCreateRecursiveMutex()) {}
 
 void ServerManager::use(Middleware* mw) {
     _middlewares.push_back(mw);
@@ -19,15 +32,34 @@ void ServerManager::addRouter(Router* router) {
     Serial.print("📦 Router mounted with base path: ");
     Serial.println(router->basePath());
 
-    for (auto route : router->getEndpoints()) {
+    for (const auto& route : router->getEndpoints()) {
         Serial.print("  🟢 GET ");
         Serial.println(route.path);
     }
 
-    for (auto route : router->postEndpoints()) {
+    for (const auto& route : router->postEndpoints()) {
         Serial.print("  🟢 POST ");
         Serial.println(route.path);
     }
+
+    for (const auto& route : router->deleteEndpoints()) {
+        Serial.print("  🟢 DELETE ");
+        Serial.println(route.path);
+    }
+}
+
+#ifndef JARVIS_HTTPD
+void ServerManager::addSocket(AsyncWebSocket* socket) {
+    _sockets.push_back(socket);
+    Serial.print("🔌 WebSocket mounted at: ");
+    Serial.println(socket->url());
+}
+#endif
+
+void ServerManager::addEvents(EventHub* hub) {
+    _eventHubs.push_back(hub);
+    Serial.print("📡 Event stream mounted at: ");
+    Serial.println(hub->url());
 }
 
 void ServerManager::begin() {
@@ -37,172 +69,248 @@ void ServerManager::begin() {
         return;
     }
 
-    // Serve static files (React build in /web)
-    _server.serveStatic("/", LittleFS, "/web/").setDefaultFile("index.html");
+    // Request-scoped JSON documents come from fixed arenas, allocated before the heap fragments
+    if (!JsonPool::instance().begin()) {
+        Serial.println("⚠️ Failed to allocate JSON pool");
+    }
+    if (!_bodies.begin()) {
+        Serial.println("⚠️ Failed to allocate request body buffers");
+    }
+
+    // Frontend build in /web: precompressed with ETags when prebuild.py wrote a
+    // manifest, plain files otherwise
+    _hasAssetManifest = _staticAssets.load(LittleFS, "/web");
+    if (_hasAssetManifest) {
+        Serial.printf("🗜️ Serving %u precompressed web assets\n", (unsigned)_staticAssets.count());
+    }
+
+    compileRoutes();
+
+    if (!_backend->begin()) {
+        Serial.println("⚠️ Failed to start webserver");
+        return;
+    }
+    Serial.printf("✅ Webserver started! (%s)\n", _backend->name());
+}
+
+void ServerManager::compileRoutes() {
+    // The trie indexes into _plans, so both are built exactly once
+    if (!_plans.empty()) return;
+
+    size_t count = 0;
+    for (auto router : _routers)
+        count += router->getEndpoints().size() + router->postEndpoints().size() + router->deleteEndpoints().size();
+    _plans.clear();
+    _plans.reserve(count);
 
     for (auto router : _routers) {
-        auto registerRoute = [this, router](Router::Route route, WebRequestMethod method) {
-            Serial.print("Registering route: ");
-            Serial.println(route.path);
-
-            // Case 1: normal GET/POST handler
-            if (route.handler) {
-                _server.on(route.path.c_str(), method,
-                    [this, route, router](AsyncWebServerRequest* request) {
-                        size_t i = 0;
-                        std::function<void()> runMiddlewares;
-                        runMiddlewares = [&]() {
-                            if (i < _middlewares.size()) {
-                                Middleware* mw = _middlewares[i++];
-                                mw->handle(request, runMiddlewares);
-                            } else {
-                                try {
-                                    // Run router guards
-                                    for (auto guard : router->routerGuards())
-                                        if (!guard->canActivate(request)) return;
-                                    // Run route guards
-                                    for (auto guard : route.guards)
-                                        if (!guard->canActivate(request)) return;
-
-                                    HttpSuccess result = route.handler(request);
-                                    if (result.response()) {
-                                        request->send(result.response());
-                                    } else {
-                                        String output = result.output();
-                                        request->send(200, "application/json", output);
-                                    }
-                                } catch (const HttpError& e) {
-                                    DynamicJsonDocument doc(256);
-                                    doc["ok"] = false;
-                                    doc["error"] = e.message();
-                                    String output;
-                                    serializeJson(doc, output);
-                                    request->send(e.statusCode(), "application/json", output);
-                                } catch (const std::exception& e) {
-                                    DynamicJsonDocument doc(256);
-                                    doc["ok"] = false;
-                                    doc["error"] = e.what();
-                                    String output;
-                                    serializeJson(doc, output);
-                                    request->send(500, "application/json", output);
-                                } catch (...) {
-                                    DynamicJsonDocument doc(256);
-                                    doc["ok"] = false;
-                                    doc["error"] = "Unknown error";
-                                    String output;
-                                    serializeJson(doc, output);
-                                    request->send(500, "application/json", output);
-                                }
-                            }
-                        };
-                        runMiddlewares();
-                    });
-            }
+        const std::vector<Router::Route>* tables[3] = { &router->getEndpoints(), &router->postEndpoints(), &router->deleteEndpoints() };
+        const HttpMethod routeMethods[3] = { HttpMethod::Get, HttpMethod::Post, HttpMethod::Delete };
+
+        for (uint8_t t = 0; t < 3; t++) {
+            for (const Router::Route& route : *tables[t]) {
+                Serial.print("Registering route: ");
+                Serial.println(route.path);
 
-            // Case 2: POST with body handler
-            else if (route.bodyHandler && method == HTTP_POST) {
-                _server.on(route.path.c_str(), HTTP_POST,
-                    [](AsyncWebServerRequest* request) {},
-                    nullptr, // no file upload handler
-                    [this, route, router](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
-                        if (index + len == total) {
-                            size_t i = 0;
-                            std::function<void()> runMiddlewares;
-                            runMiddlewares = [&]() {
-                                if (i < _middlewares.size()) {
-                                    Middleware* mw = _middlewares[i++];
-                                    mw->handle(request, runMiddlewares);
-                                } else {
-                                    try {
-                                        // Run guards
-                                        for (auto guard : router->routerGuards())
-                                            if (!guard->canActivate(request)) return;
-                                        for (auto guard : route.guards)
-                                            if (!guard->canActivate(request)) return;
-
-                                        HttpSuccess result = route.bodyHandler(request, data);
-                                        if (result.response()) {
-                                            request->send(result.response());
-                                        } else {
-                                            String output = result.output();
-                                            request->send(200, "application/json", output);
-                                        }
-                                    } catch (const HttpError& e) {
-                                        DynamicJsonDocument doc(256);
-                                        doc["ok"] = false;
-                                        doc["error"] = e.message();
-                                        String output;
-                                        serializeJson(doc, output);
-                                        request->send(e.statusCode(), "application/json", output);
-                                    } catch (const std::exception& e) {
-                                        DynamicJsonDocument doc(256);
-                                        doc["ok"] = false;
-                                        doc["error"] = e.what();
-                                        String output;
-                                        serializeJson(doc, output);
-                                        request->send(500, "application/json", output);
-                                    } catch (...) {
-                                        DynamicJsonDocument doc(256);
-                                        doc["ok"] = false;
-                                        doc["error"] = "Unknown error";
-                                        String output;
-                                        serializeJson(doc, output);
-                                        request->send(500, "application/json", output);
-                                    }
-                                }
-                            };
-                            runMiddlewares();
-                        }
-                    });
+                RoutePlan plan;
+                plan.route = &route;
+                plan.method = routeMethods[t];
+                plan.guards = router->routerGuards();
+                plan.guards.insert(plan.guards.end(), route.guards.begin(), route.guards.end());
+                plan.maxBody = route.maxBodySize;
+                plan.admissionGroup = _admission.groupFor(route.path);
+                plan.cacheRoute = route.cacheTtlMs && plan.method == HttpMethod::Get
+                    ? _cache.addRoute(route.cacheTtlMs, route.cacheKeys) : -1;
+                if (route.bodyHandler && (plan.maxBody == 0 || plan.maxBody > BodyPool::BUFFER_SIZE)) {
+                    // Accumulated bodies must fit a pooled buffer
+                    plan.maxBody = BodyPool::BUFFER_SIZE;
+                    Serial.printf("  ⚠️ Body limit clamped to %u bytes\n", (unsigned)plan.maxBody);
+                }
+                _plans.push_back(plan);
+                _routes.insert(route.path, plan.method, _plans.size() - 1);
             }
-        };
+        }
+    }
+    Serial.printf("🌳 %u routes, %u trie nodes\n", (unsigned)_plans.size(), (unsigned)_routes.nodeCount());
+}
+
+const ServerManager::RoutePlan* ServerManager::findRoute(HttpRequest& request) const {
+    int16_t index = _routes.match(request.method(), request.url(), request.pathParams());
+    return index == RouteTrie::NONE ? nullptr : &_plans[index];
+}
+
+bool ServerManager::handle(HttpRequest& request, const uint8_t* body, size_t bodyLength) {
+    const RoutePlan* plan = findRoute(request);
+    if (!plan) {
+        HttpError(404, "Not found").send(&request);
+        return false;
+    }
 
-        for (auto route : router->getEndpoints()) registerRoute(route, HTTP_GET);
-        for (auto route : router->postEndpoints()) registerRoute(route, HTTP_POST);
+    DispatchLock lock(_dispatchLock);
+    const Router::Route* route = plan->route;
+    if (route->chunkHandler && bodyLength) {
+        // The whole body as one chunk, then the completion handler
+        try {
+            checkGuards(plan, &request);
+            route->chunkHandler(&request, body, bodyLength, 0, bodyLength);
+        } catch (const HttpError& e) {
+            sendError(plan, &request, e.statusCode(), e.message());
+            return true;
+        } catch (const std::exception& e) {
+            sendError(plan, &request, 500, e.what());
+            return true;
+        }
+        dispatch(plan, &request, nullptr, bodyLength, true);
+        return true;
     }
+    if (route->bodyHandler && plan->maxBody && bodyLength > plan->maxBody) {
+        sendError(plan, &request, 413, "Payload too large");
+        return true;
+    }
+    static const uint8_t empty[1] = { 0 };
+    dispatch(plan, &request, route->bodyHandler && !body ? empty : body, bodyLength);
+    return true;
+}
+
+bool ServerManager::fillsBody(HttpRequest& request) const {
+    const RoutePlan* plan = findRoute(request);
+    return plan && plan->route->fillsBody;
+}
 
-    _server.begin();
-    Serial.println("✅ Webserver started!");
+void ServerManager::checkGuards(const RoutePlan* plan, HttpRequest* request) {
+    DispatchLock lock(_dispatchLock);
+    // Router guards, then route guards
+    for (Guard* guard : plan->guards)
+        if (!guard->canActivate(request)) throw HttpError(403, "Forbidden");
 }
 
-void ServerManager::processRequest(AsyncWebServerRequest* request,
-                                   const Router::Route& route,
-                                   const std::vector<Guard*>& routerGuards,
-                                   std::function<void()> next) {
-    // 1. Run guards
-    for (auto guard : routerGuards)
-        if (!guard->canActivate(request)) return;
-    for (auto guard : route.guards)
-        if (!guard->canActivate(request)) return;
+#ifdef JARVIS_ALLOC_TRACE
+// Counts operator new calls made by one task while a benchmark or test measures it
+static volatile TaskHandle_t countTask = nullptr;
+static volatile uint32_t countAllocations = 0;
 
-    // 2. Run handler inside try/catch
-    DynamicJsonDocument doc(1024);
+void* operator new(size_t size) {
+    if (countTask && xTaskGetCurrentTaskHandle() == countTask) countAllocations++;
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+
+bool ServerManager::beginAllocationCount() {
+    countAllocations = 0;
+    countTask = xTaskGetCurrentTaskHandle();
+    return true;
+}
+
+uint32_t ServerManager::endAllocationCount() {
+    countTask = nullptr;
+    return countAllocations;
+}
+#else
+bool ServerManager::beginAllocationCount() { return false; }
+uint32_t ServerManager::endAllocationCount() { return 0; }
+#endif
+
+void ServerManager::dispatch(const RoutePlan* plan, HttpRequest* request,
+                             const uint8_t* body, size_t bodyLength, bool guardsPassed) {
+    DispatchLock lock(_dispatchLock);
+
+    Pipeline run;
+    run.server = this;
+    run.plan = plan;
+    run.request = request;
+    run.body = body;
+    run.bodyLength = bodyLength;
+    run.guardsPassed = guardsPassed;
+    run.position = 0;
+    Pipeline* cursor = &run;
+    run.next = [cursor]() { cursor->server->advance(*cursor); };
+
+    try {
+        advance(run);
+    } catch (const HttpError& e) {
+        // Thrown by a middleware; the handler catches its own
+        sendError(plan, request, e.statusCode(), e.message());
+    } catch (const std::exception& e) {
+        sendError(plan, request, 500, e.what());
+    } catch (...) {
+        sendError(plan, request, 500, "Unknown error");
+    }
+}
+
+void ServerManager::advance(Pipeline& run) {
+    if (run.position < _middlewares.size()) {
+        Middleware* mw = _middlewares[run.position++];
+        mw->handle(run.request, run.next);
+        return;
+    }
+    runHandler(run);
+}
+
+void ServerManager::runHandler(const Pipeline& run) {
+    const Router::Route* route = run.plan->route;
+    HttpRequest* request = run.request;
     try {
-        HttpSuccess result = route.handler(request);
-        if (result.response()) {
-            request->send(result.response());
+        if (!run.guardsPassed) checkGuards(run.plan, request);
+
+        if (run.plan->cacheRoute >= 0) {
+            notifyResponse(run.plan, request, runCached(run.plan, request));
         } else {
-            String output = result.output();
-            request->send(200, "application/json", output);
+            HttpSuccess result = route->bodyHandler ? route->bodyHandler(request, run.body, run.bodyLength)
+                                                    : route->handler(request);
+            notifyResponse(run.plan, request, result.send(request));
         }
     } catch (const HttpError& e) {
-        doc["ok"] = false;
-        doc["error"] = e.message();
-        String output;
-        serializeJson(doc, output);
-        request->send(e.statusCode(), "application/json", output);
-        return;
+        sendError(run.plan, request, e.statusCode(), e.message());
     } catch (const std::exception& e) {
-        doc["ok"] = false;
-        doc["error"] = e.what();
+        sendError(run.plan, request, 500, e.what());
     } catch (...) {
-        doc["ok"] = false;
-        doc["error"] = "Unknown error";
+        sendError(run.plan, request, 500, "Unknown error");
     }
+}
+
+// Guards have passed. A fresh entry is answered without running the handler;
+// otherwise the handler's answer is kept if it is a plain 200 and sent from the cache.
+int ServerManager::runCached(const RoutePlan* plan, HttpRequest* request) {
+    bool identified = !plan->guards.empty();
+    const ResponseCache::Entry* entry = _cache.find(plan->cacheRoute, request, identified);
+    if (entry) return ResponseCache::send(*entry, request);
+
+    // The handler sees the capture, which notes the query parameters it reads
+    ResponseCache::Capture capture(request, _cache.queryKeys(plan->cacheRoute));
+    HttpSuccess result = plan->route->handler(&capture);
+    int status = result.send(&capture);
+    if (!capture.captured()) return status;   // already sent, not cacheable
 
-    String output;
-    serializeJson(doc, output);
-    request->send(200, "application/json", output);
+    entry = _cache.store(plan->cacheRoute, request, identified, capture);
+    if (entry) return ResponseCache::send(*entry, request);
+
+    HttpResponse response(status, capture.contentType());
+    response.text(capture.body());
+    request->send(response);
+    return status;
+}
+
+void ServerManager::invalidateCache(const String& configKey) {
+    DispatchLock lock(_dispatchLock);
+    _cache.invalidate(configKey);
+}
+
+void ServerManager::clearCache() {
+    DispatchLock lock(_dispatchLock);
+    _cache.clear();
+}
+
+void ServerManager::sendError(const RoutePlan* plan, HttpRequest* request, int statusCode, const String& message) {
+    // Every 503 here means "busy"; tell clients when to come back
+    HttpError(statusCode, message, statusCode == 503 ? _admission.retryAfter() : 0).send(request);
+    notifyResponse(plan, request, statusCode);
+}
 
-    if (next) next();
+void ServerManager::notifyResponse(const RoutePlan* plan, HttpRequest* request, int statusCode) {
+    for (Middleware* mw : _middlewares)
+        mw->onResponse(request, plan->route->path.c_str(), statusCode);
 }
@@ -1,13 +1,25 @@
 #pragma once
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#ifndef JARVIS_HTTPD
 #include <ESPAsyncWebServer.h>
+#endif
 #include "../../include/Router.h"      // include from include/
 #include "../../include/Middleware.h"  // include from include/
 #include "../../include/DependencyContainer.h"
+#include "../../include/HttpRequest.h"
+#include "HttpBackend.h"
+#include "RouteTrie.h"
+#include "ResponseCache.h"
+#include "StaticAssetHandler.h"
+#include "BodyPool.h"
+#include "AdmissionControl.h"
+#include "EventHub.h"
 #include <vector>
 
 
+// Routers, middleware and guards on top of an HttpBackend (see HttpBackend.h),
+// chosen at build time
 class ServerManager {
 public:
     ServerManager(uint16_t port = 80);
@@ -18,16 +30,101 @@ public:
     }
     DependencyContainer* dependencies() { return &_deps; }
     void addRouter(Router* router);        // attach a router
+#ifndef JARVIS_HTTPD
+    void addSocket(AsyncWebSocket* socket); // attach a websocket endpoint (ESPAsyncWebServer only)
+#endif
+    void addEvents(EventHub* hub);         // attach a Server-Sent Events channel
     void begin();                          // start the server
+    const char* backendName() const { return _backend->name(); }
+    AdmissionControl& admission() { return _admission; }  // configure before begin()
+
+    // Runs a request that did not come from the network (e.g. a SyntheticRequest)
+    // through the same middleware, guards and handler as a real one. Admission control
+    // is skipped. Answers 404 and returns false when no route matches.
+    bool handle(HttpRequest& request, const uint8_t* body = nullptr, size_t bodyLength = 0);
+    // True when the route for request was marked with Router::fills()
+    bool fillsBody(HttpRequest& request) const;
+
+    // Drops cached responses of routes that declared this config key (Router::cache());
+    // wired to ConfigManager::onChange. Safe to call from any task.
+    void invalidateCache(const String& configKey);
+    void clearCache();
+    const ResponseCache& cache() const { return _cache; }
+
+    // Counts operator new calls made by the calling task, for benchmarks. Only
+    // available in builds with -D JARVIS_ALLOC_TRACE; otherwise begin returns false.
+    static bool beginAllocationCount();
+    static uint32_t endAllocationCount();
+
+    // Held while middleware, guards or handlers run (see _dispatchLock). Work on other
+    // tasks (jobs) takes it around state handlers use unlocked: ConfigManager, JWTAuth.
+    struct DispatchLock {
+        explicit DispatchLock(ServerManager& server) : DispatchLock(server._dispatchLock) {}
+        explicit DispatchLock(SemaphoreHandle_t lock) : _lock(lock) { xSemaphoreTakeRecursive(_lock, portMAX_DELAY); }
+        ~DispatchLock() { xSemaphoreGiveRecursive(_lock); }
+        DispatchLock(const DispatchLock&) = delete;
+        DispatchLock& operator=(const DispatchLock&) = delete;
+        SemaphoreHandle_t _lock;
+    };
 
 private:
-    AsyncWebServer _server;
+    friend class AsyncBackend;
+    friend class IdfBackend;
+
+    // Everything a request to one route needs, resolved once in begin().
+    // Plans are immutable afterwards; requests only read them.
+    struct RoutePlan {
+        const Router::Route* route;
+        HttpMethod method;
+        std::vector<Guard*> guards;        // router guards followed by route guards
+        size_t maxBody;                    // effective body limit, 0 = unlimited
+        int8_t admissionGroup;             // per-route concurrency limit, -1 = none
+        int8_t cacheRoute;                 // ResponseCache route id, -1 = not cached
+    };
+
+    // Per-request cursor through the middleware chain. Lives on the handler's stack;
+    // `next` only captures a pointer to it, so it fits std::function's inline storage.
+    struct Pipeline {
+        ServerManager* server;
+        const RoutePlan* plan;
+        HttpRequest* request;
+        const uint8_t* body;
+        size_t bodyLength;
+        bool guardsPassed;                 // already checked at the first body chunk
+        size_t position;
+        std::function<void()> next;
+    };
+
+    HttpBackend* _backend;
     std::vector<Middleware*> _middlewares;
     std::vector<Router*> _routers;
+#ifndef JARVIS_HTTPD
+    std::vector<AsyncWebSocket*> _sockets;
+#endif
+    std::vector<EventHub*> _eventHubs;
+    std::vector<RoutePlan> _plans;
+    RouteTrie _routes;                     // pattern -> index into _plans
+    StaticAssetHandler _staticAssets;
+    bool _hasAssetManifest = false;
+    BodyPool _bodies;
+    AdmissionControl _admission;
+    ResponseCache _cache;
     DependencyContainer _deps;
+    // Requests may arrive on several tasks (AsyncTCP, httpd workers, handle() callers);
+    // middleware, guards and upload state assume one dispatcher at a time.
+    // Recursive, so a handler may call handle() itself.
+    SemaphoreHandle_t _dispatchLock;
 
-    void processRequest(AsyncWebServerRequest* request,
-                        const Router::Route& route,
-                        const std::vector<Guard*>& routerGuards,
-                        std::function<void()> next);
+    void compileRoutes();
+    const RoutePlan* findRoute(HttpRequest& request) const;   // also binds path params
+    void dispatch(const RoutePlan* plan, HttpRequest* request,
+                  const uint8_t* body = nullptr, size_t bodyLength = 0, bool guardsPassed = false);
+    void advance(Pipeline& run);
+    void runHandler(const Pipeline& run);
+    int runCached(const RoutePlan* plan, HttpRequest* request);
+    // Takes the dispatch lock: guards share state (JWTAuth's HMAC context) with the
+    // pipeline, and backends call this ahead of dispatch() for uploads
+    void checkGuards(const RoutePlan* plan, HttpRequest* request);
+    void sendError(const RoutePlan* plan, HttpRequest* request, int statusCode, const String& message);
+    void notifyResponse(const RoutePlan* plan, HttpRequest* request, int statusCode);
 };
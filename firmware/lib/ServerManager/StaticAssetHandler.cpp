@@ -0,0 +1,134 @@
+#include "StaticAssetHandler.h"
+#include "OpenFiles.h"
+#include <algorithm>
+
+static const char* MANIFEST_FILE = "/asset-manifest.csv";
+
+bool StaticAssetHandler::load(FS& fs, const String& root) {
+    _fs = &fs;
+    _root = root.endsWith("/") ? root.substring(0, root.length() - 1) : root;
+    _assets.clear();
+
+    File manifest = fs.open(_root + MANIFEST_FILE, "r");
+    if (!manifest) {
+        return false;
+    }
+
+    // <url>,<etag>,<gzip>,<immutable>
+    while (manifest.available()) {
+        String line = manifest.readStringUntil('\n');
+        line.trim();
+        int c1 = line.indexOf(',');
+        int c2 = line.indexOf(',', c1 + 1);
+        int c3 = line.indexOf(',', c2 + 1);
+        if (c1 <= 0 || c2 < 0 || c3 < 0) continue;
+
+        Asset asset;
+        asset.url = line.substring(0, c1);
+        asset.etag = "\"" + line.substring(c1 + 1, c2) + "\"";
+        asset.gzip = line.substring(c2 + 1, c3) == "1";
+        asset.immutable = line.substring(c3 + 1) == "1";
+        _assets.push_back(asset);
+    }
+    manifest.close();
+
+    std::sort(_assets.begin(), _assets.end(), [](const Asset& a, const Asset& b) {
+        return a.url < b.url;
+    });
+    return !_assets.empty();
+}
+
+const StaticAssetHandler::Asset* StaticAssetHandler::find(const String& url) const {
+    String path = url.endsWith("/") ? url + "index.html" : url;
+
+    auto it = std::lower_bound(_assets.begin(), _assets.end(), path, [](const Asset& a, const String& p) {
+        return a.url < p;
+    });
+    if (it == _assets.end() || it->url != path) return nullptr;
+    return &*it;
+}
+
+bool StaticAssetHandler::canHandle(HttpRequest& request) const {
+    return request.method() == HttpMethod::Get && find(request.url());
+}
+
+void StaticAssetHandler::handle(HttpRequest& request) const {
+    const Asset* asset = find(request.url());
+    if (!asset) {
+        HttpResponse response(404, "text/plain");
+        request.send(response);
+        return;
+    }
+
+    const char* cacheControl = asset->immutable ? "public, max-age=31536000, immutable" : "no-cache";
+
+    // Revalidation: the browser already has these exact bytes
+    if (request.hasHeader("If-None-Match") && request.header("If-None-Match").indexOf(asset->etag) >= 0) {
+        HttpResponse response(304, contentType(asset->url));
+        response.header("ETag", asset->etag).header("Cache-Control", cacheControl);
+        request.send(response);
+        return;
+    }
+
+    String path = _root + asset->url;
+    if (asset->gzip) path += ".gz";
+
+    File file = _fs->open(path, "r");
+    if (!file) {
+        HttpResponse response(404, "text/plain");
+        request.send(response);
+        return;
+    }
+    HttpResponse response(200, contentType(asset->url));
+    if (asset->gzip) response.header("Content-Encoding", "gzip");
+    response.header("ETag", asset->etag).header("Cache-Control", cacheControl);
+    sendFile(request, file, response);
+}
+
+bool StaticAssetHandler::serveFile(HttpRequest& request) const {
+    if (!_fs || request.method() != HttpMethod::Get) return false;
+    // The URL may arrive percent-decoded and LittleFS resolves "..", so a dot
+    // segment could reach /config.json outside the root
+    const String& url = request.url();
+    if (!url.startsWith("/") || url.indexOf("/./") >= 0 || url.indexOf("/../") >= 0 ||
+        url.endsWith("/.") || url.endsWith("/..")) {
+        return false;
+    }
+    String path = _root + url;
+    if (path.endsWith("/")) path += "index.html";
+    if (!_fs->exists(path)) return false;
+
+    File file = _fs->open(path, "r");
+    if (!file || file.isDirectory()) return false;
+    HttpResponse response(200, contentType(path));
+    sendFile(request, file, response);
+    return true;
+}
+
+// The file is pulled as the client accepts data, never read whole
+void StaticAssetHandler::sendFile(HttpRequest& request, File file, HttpResponse& response) {
+    size_t size = file.size();
+    OpenFiles::Use use;
+    response.fill(size, [file, use, size](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+        if (index >= size) return 0;
+        int read = file.read(buffer, size - index < maxLen ? size - index : maxLen);
+        return read > 0 ? read : 0;
+    });
+    request.send(response);
+}
+
+const char* StaticAssetHandler::contentType(const String& path) {
+    if (path.endsWith(".html")) return "text/html";
+    if (path.endsWith(".js")) return "application/javascript";
+    if (path.endsWith(".css")) return "text/css";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".svg")) return "image/svg+xml";
+    if (path.endsWith(".png")) return "image/png";
+    if (path.endsWith(".jpg") || path.endsWith(".jpeg")) return "image/jpeg";
+    if (path.endsWith(".ico")) return "image/x-icon";
+    if (path.endsWith(".woff2")) return "font/woff2";
+    if (path.endsWith(".woff")) return "font/woff";
+    if (path.endsWith(".txt")) return "text/plain";
+    if (path.endsWith(".map")) return "application/json";
+    return "application/octet-stream";
+}
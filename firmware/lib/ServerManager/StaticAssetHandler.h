@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+#include "../../include/HttpRequest.h"
+
+// Serves the frontend build described by <root>/asset-manifest.csv (written by
+// scripts/prebuild.py): precompressed .gz files, strong ETags, 304 revalidation and
+// long-lived caching for content-hashed file names. Answers through HttpRequest, so
+// every server backend uses the same code.
+class StaticAssetHandler {
+public:
+    // Returns false if there is no manifest; the caller falls back to plain files
+    bool load(FS& fs, const String& root);
+    size_t count() const { return _assets.size(); }
+
+    bool canHandle(HttpRequest& request) const;   // GET of a manifest entry
+    void handle(HttpRequest& request) const;
+
+    // Plain file under root (index.html for directories), without manifest data.
+    // False if there is no such file or the URL has a "." or ".." segment.
+    // Fallback of backends without serveStatic.
+    bool serveFile(HttpRequest& request) const;
+
+private:
+    struct Asset {
+        String url;
+        String etag;        // quoted, ready for the header
+        bool gzip;
+        bool immutable;
+    };
+
+    FS* _fs = nullptr;
+    String _root;
+    std::vector<Asset> _assets;   // sorted by url
+
+    const Asset* find(const String& url) const;
+    static void sendFile(HttpRequest& request, File file, HttpResponse& response);
+    static const char* contentType(const String& path);
+};
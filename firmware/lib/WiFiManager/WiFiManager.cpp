@@ -10,28 +10,65 @@ void WiFiManager::begin() {
 
 void WiFiManager::startScan() {
     WiFi.scanDelete();
-    WiFi.scanNetworks(true); // async scan
+    _scanning = WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING; // async scan
+    _scanStartedAt = millis();
+    _scanRequested = false;
 }
 
-bool WiFiManager::isScanComplete() const {
-    return WiFi.scanComplete() >= 0;
+void WiFiManager::requestScan() {
+    _scanRequested = true;
 }
 
-DynamicJsonDocument WiFiManager::getScanResults() {
-    int n = WiFi.scanComplete();
-    DynamicJsonDocument doc(2048);
-    JsonArray arr = doc.to<JsonArray>();
+// Collects a finished scan, then starts the next one when it is due: every
+// WIFI_SCAN_INTERVAL_MS while the setup AP is up, sooner when a client asked.
+// Nothing is scanned while connected or connecting; a scan interrupts the STA link.
+void WiFiManager::updateScan() {
+    if (_scanning) {
+        int found = WiFi.scanComplete();
+        if (found == WIFI_SCAN_RUNNING) return;
+        _scanning = false;
+        if (found >= 0) collectScan(found);
+    }
+
+    if (_connecting || isConnected() || !(WiFi.getMode() & WIFI_AP)) return;
+    uint32_t sinceLast = millis() - _scanStartedAt;
+    bool due = sinceLast >= WIFI_SCAN_INTERVAL_MS;
+    if (_scanGeneration == 0 || _scanRequested) due = due || sinceLast >= WIFI_SCAN_MIN_INTERVAL_MS || !_scanStartedAt;
+    if (due) startScan();
+}
 
-    for (int i = 0; i < n; ++i) {
-        JsonObject obj = arr.createNestedObject();
-        obj["ssid"] = WiFi.SSID(i);
-        obj["rssi"] = WiFi.RSSI(i);
-        obj["secure"] = (WiFi.encryptionType(i) != WIFI_AUTH_OPEN);
-        obj["hidden"] = false;
+// Serialized once per scan; /wifi/list sends the same bytes to every client
+void WiFiManager::collectScan(int found) {
+    JsonDocument doc;
+    JsonArray arr = doc.to<JsonArray>();
+    for (int i = 0; i < found && i < WIFI_SCAN_MAX_NETWORKS; ++i) {
+        WiFiNetwork network{ WiFi.SSID(i), WiFi.RSSI(i), WiFi.encryptionType(i) != WIFI_AUTH_OPEN, false };
+        network.toJson(arr);
     }
-    // WiFi.scanDelete(); // clean up old results
-    startScan();
-    return doc;
+    WiFi.scanDelete();   // the driver's copy is no longer needed
+
+    String* json = new String();
+    serializeJson(doc, *json);
+
+    WiFiScan scan;
+    scan.json = std::shared_ptr<const String>(json);
+    scan.count = arr.size();
+    scan.scannedAt = millis();
+
+    // The previous table is freed outside the critical section, once no reader holds it
+    portENTER_CRITICAL(&_scanMux);
+    scan.generation = _scanGeneration + 1;
+    std::swap(_scan, scan);
+    _scanGeneration = _scan.generation;
+    portEXIT_CRITICAL(&_scanMux);
+}
+
+WiFiScan WiFiManager::scanResults() const {
+    WiFiScan scan;
+    portENTER_CRITICAL(&_scanMux);
+    scan = _scan;
+    portEXIT_CRITICAL(&_scanMux);
+    return scan;
 }
 
 bool WiFiManager::connectSTA(unsigned long timeout) {
@@ -86,6 +123,7 @@ String WiFiManager::tryConnect(const String& ssid, const String& password, unsig
     }
 
     // Keep AP active while connecting
+    _connecting = true;
     WiFi.mode(WIFI_AP_STA);
     WiFi.begin(ssid.c_str(), password.c_str());
     Serial.printf("🚀 Trying to connect to \"%s\"\n", ssid.c_str());
@@ -100,6 +138,7 @@ String WiFiManager::tryConnect(const String& ssid, const String& password, unsig
     }
 
     Serial.println();
+    _connecting = false;
 
     if (status == WL_CONNECTED) {
         IPAddress ip = WiFi.localIP();
@@ -138,7 +177,7 @@ void WiFiManager::startAP() {
         Serial.println(WiFi.softAPIP());
         if (_apStartedCallback) _apStartedCallback();
 
-        startScan();
+        requestScan();
     } else {
         Serial.println("❌ Failed to start AP!");
     }
@@ -3,8 +3,22 @@
 #include <ArduinoJson.h>
 #include <WiFi.h>
 #include <functional>
+#include <memory>
 #include <vector>
 
+// Background scans while the setup AP is up; override with -D WIFI_SCAN_INTERVAL_MS=...
+#ifndef WIFI_SCAN_INTERVAL_MS
+#define WIFI_SCAN_INTERVAL_MS 30000
+#endif
+// A requested scan does not start sooner than this after the previous one
+#ifndef WIFI_SCAN_MIN_INTERVAL_MS
+#define WIFI_SCAN_MIN_INTERVAL_MS 5000
+#endif
+// Networks kept per scan, in the driver's order (strongest first)
+#ifndef WIFI_SCAN_MAX_NETWORKS
+#define WIFI_SCAN_MAX_NETWORKS 20
+#endif
+
 struct WiFiNetwork {
     String ssid;
     int32_t rssi;
@@ -21,6 +35,15 @@ struct WiFiNetwork {
     }
 };
 
+// The last finished scan. `json` is the serialized network array, shared by every
+// reader until the next scan replaces it; null before the first scan.
+struct WiFiScan {
+    std::shared_ptr<const String> json;
+    uint32_t generation = 0;                 // +1 per finished scan, 0 = none yet
+    uint16_t count = 0;
+    uint32_t scannedAt = 0;                  // millis()
+};
+
 class WiFiManager {
 public:
     WiFiManager(const String& ssid = "", const String& password = "",
@@ -31,9 +54,13 @@ public:
     void startAP();                               
     bool isConnected() const;
     String ipAddress() const;
-    void startScan();
-    bool isScanComplete() const;
-    DynamicJsonDocument getScanResults();
+    // Scans are only started and collected by updateScan(), so the driver's scan list
+    // is touched by one task; everyone else reads the cached table.
+    void requestScan();                      // scan soon, for a waiting client
+    void updateScan();                       // scan policy, call from loop()
+    bool isScanComplete() const { return scanGeneration() != 0; }
+    uint32_t scanGeneration() const { return _scanGeneration; }
+    WiFiScan scanResults() const;
     void setAPStartedCallback(std::function<void()> cb) { _apStartedCallback = cb; }
     void stopAP();
     String tryConnect(const String& ssid, const String& password, unsigned long timeout = 10000);
@@ -47,4 +74,15 @@ private:
     String _apPassword;
 
     std::function<void()> _apStartedCallback;
+
+    mutable portMUX_TYPE _scanMux = portMUX_INITIALIZER_UNLOCKED;
+    WiFiScan _scan;
+    volatile uint32_t _scanGeneration = 0;
+    volatile bool _scanRequested = false;
+    volatile bool _connecting = false;       // tryConnect() on another task
+    bool _scanning = false;
+    uint32_t _scanStartedAt = 0;
+
+    void startScan();
+    void collectScan(int found);
 };
@@ -0,0 +1,158 @@
+"""Load a running device with concurrent HTTP clients and report throughput, latency and heap.
+
+Used to compare the two web server backends (esp32dev and esp32dev_httpd):
+
+    python scripts/bench_http.py 192.168.1.50 --label async --save async.json
+    python scripts/bench_http.py 192.168.1.50 --label httpd --save httpd.json
+    python scripts/bench_http.py --compare async.json httpd.json
+
+Every client keeps one connection and cycles through a small mix: a cached JSON route,
+a rejected login (schema parsing, 401), the Prometheus scrape and the static index.
+/metrics is scraped before and after the run for the free heap and the backend name.
+"""
+import argparse
+import http.client
+import json
+import re
+import sys
+import threading
+import time
+
+WORKLOAD = [
+    ("GET", "/status/wizard", None),
+    ("POST", "/auth/login", json.dumps({"password": "bench-wrong-password"})),
+    ("GET", "/metrics", None),
+    ("GET", "/", None),
+]
+
+
+def scrape(host, port):
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    conn.request("GET", "/metrics")
+    text = conn.getresponse().read().decode()
+    conn.close()
+    heap = re.search(r"^jarvis_heap_free_bytes (\d+)", text, re.M)
+    backend = re.search(r'^jarvis_http_backend_info\{backend="(\w+)"\}', text, re.M)
+    return {
+        "heap": int(heap.group(1)) if heap else None,
+        "backend": backend.group(1) if backend else "async",
+    }
+
+
+def client(host, port, deadline, offset, results, lock):
+    conn = None
+    latencies, statuses, errors = [], {}, 0
+    i = offset
+    while time.monotonic() < deadline:
+        method, path, body = WORKLOAD[i % len(WORKLOAD)]
+        i += 1
+        headers = {"Content-Type": "application/json"} if body else {}
+        started = time.monotonic()
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(host, port, timeout=10)
+            conn.request(method, path, body=body, headers=headers)
+            response = conn.getresponse()
+            response.read()
+            if response.getheader("Connection", "").lower() == "close":
+                conn.close()
+                conn = None
+        except (OSError, http.client.HTTPException):
+            errors += 1
+            if conn:
+                conn.close()
+            conn = None
+            continue
+        latencies.append(time.monotonic() - started)
+        statuses[response.status] = statuses.get(response.status, 0) + 1
+    if conn:
+        conn.close()
+    with lock:
+        results["latencies"].extend(latencies)
+        results["errors"] += errors
+        for status, count in statuses.items():
+            results["statuses"][status] = results["statuses"].get(status, 0) + count
+
+
+def percentile(values, fraction):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * fraction))]
+
+
+def run(args):
+    before = scrape(args.host, args.port)
+    results = {"latencies": [], "errors": 0, "statuses": {}}
+    lock = threading.Lock()
+    deadline = time.monotonic() + args.duration
+    threads = [threading.Thread(target=client, args=(args.host, args.port, deadline, n, results, lock))
+               for n in range(args.clients)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    time.sleep(1)   # let the device release the last connections
+    after = scrape(args.host, args.port)
+
+    latencies = results["latencies"]
+    return {
+        "label": args.label or before["backend"],
+        "backend": before["backend"],
+        "clients": args.clients,
+        "duration": args.duration,
+        "requests": len(latencies),
+        "rps": len(latencies) / args.duration,
+        "p50_ms": percentile(latencies, 0.50) * 1000,
+        "p99_ms": percentile(latencies, 0.99) * 1000,
+        "shed": results["statuses"].get(503, 0),
+        "errors": results["errors"],
+        "statuses": {str(k): v for k, v in sorted(results["statuses"].items())},
+        "heap_before": before["heap"],
+        "heap_after": after["heap"],
+    }
+
+
+def report(result):
+    print(f"📊 {result['label']} ({result['backend']}), {result['clients']} clients, {result['duration']} s")
+    print(f"   {result['requests']} requests, {result['rps']:.1f} req/s")
+    print(f"   latency p50 {result['p50_ms']:.1f} ms, p99 {result['p99_ms']:.1f} ms")
+    print(f"   statuses {result['statuses']}, 503 {result['shed']}, connection errors {result['errors']}")
+    print(f"   free heap {result['heap_before']} -> {result['heap_after']} bytes")
+
+
+def compare(a, b):
+    rows = [("req/s", "rps", "{:.1f}"), ("p50 ms", "p50_ms", "{:.1f}"), ("p99 ms", "p99_ms", "{:.1f}"),
+            ("503", "shed", "{}"), ("errors", "errors", "{}"), ("heap after", "heap_after", "{}")]
+    print(f"{'':12}{a['label']:>14}{b['label']:>14}")
+    for title, key, fmt in rows:
+        print(f"{title:12}{fmt.format(a[key]):>14}{fmt.format(b[key]):>14}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host", nargs="?")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--duration", type=int, default=20, help="seconds")
+    parser.add_argument("--label", help="name in the report (default: the backend)")
+    parser.add_argument("--save", help="write the result as JSON")
+    parser.add_argument("--compare", nargs=2, metavar="RESULT", help="compare two saved results")
+    args = parser.parse_args()
+
+    if args.compare:
+        with open(args.compare[0]) as a, open(args.compare[1]) as b:
+            compare(json.load(a), json.load(b))
+        return
+    if not args.host:
+        parser.error("host is required")
+
+    result = run(args)
+    report(result)
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(result, f, indent=2)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,101 @@
+"""Upload a firmware or LittleFS image to a running device over POST /system/ota.
+
+Used as the custom uploader of the esp32dev_ota environment:
+
+    JARVIS_HOST=192.168.1.50 JARVIS_PASSWORD=... pio run -e esp32dev_ota -t upload
+
+It can also be run by hand: python scripts/ota_upload.py <image.bin> [firmware|fs]
+The image is streamed from disk; the device checks its SHA-256 before using it.
+"""
+import hashlib
+import http.client
+import json
+import os
+import sys
+import time
+from pathlib import Path
+
+CHUNK_SIZE = 4096
+
+
+def request_json(conn, method, path, body=None, headers=None):
+    conn.request(method, path, body=body, headers=headers or {})
+    response = conn.getresponse()
+    payload = json.loads(response.read() or b"{}")
+    if response.status >= 300 or not payload.get("ok", False):
+        raise SystemExit(f"❌ {method} {path}: {response.status} {payload.get('message', payload)}")
+    return payload.get("data")
+
+
+def login(host, port, password):
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    data = request_json(conn, "POST", "/auth/login", json.dumps({"password": password}),
+                        {"Content-Type": "application/json"})
+    conn.close()
+    return data["accessToken"]
+
+
+def upload(image, target, host, port, token):
+    size = image.stat().st_size
+    digest = hashlib.sha256()
+    with image.open("rb") as f:
+        for chunk in iter(lambda: f.read(CHUNK_SIZE), b""):
+            digest.update(chunk)
+
+    print(f"📤 Uploading {image.name} ({size} bytes) as {target} to {host}")
+    conn = http.client.HTTPConnection(host, port, timeout=60)
+    conn.putrequest("POST", f"/system/ota?target={target}&sha256={digest.hexdigest()}")
+    conn.putheader("Authorization", f"Bearer {token}")
+    conn.putheader("Content-Type", "application/octet-stream")
+    conn.putheader("Content-Length", str(size))
+    conn.endheaders()
+
+    sent = 0
+    with image.open("rb") as f:
+        for chunk in iter(lambda: f.read(CHUNK_SIZE), b""):
+            conn.send(chunk)
+            sent += len(chunk)
+            print(f"\r   {sent * 100 // size:3d}%", end="", flush=True)
+    print()
+
+    response = conn.getresponse()
+    payload = json.loads(response.read() or b"{}")
+    if response.status != 200:
+        raise SystemExit(f"❌ Update failed: {response.status} {payload.get('message', payload)}")
+    print(f"✅ {target} updated, device is rebooting")
+
+
+def wait_for_device(host, port, timeout=60):
+    """Wait for a device that was just told to reboot to answer HTTP again."""
+    time.sleep(3)   # the reboot is scheduled a second after the response
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        try:
+            conn = http.client.HTTPConnection(host, port, timeout=3)
+            conn.request("GET", "/status/wizard")
+            conn.getresponse().read()
+            conn.close()
+            return True
+        except (OSError, http.client.HTTPException):
+            time.sleep(1)
+    return False
+
+
+def main(image, target):
+    host = os.environ.get("JARVIS_HOST")
+    password = os.environ.get("JARVIS_PASSWORD")
+    if not host or not password:
+        raise SystemExit("❌ Set JARVIS_HOST and JARVIS_PASSWORD")
+    port = int(os.environ.get("JARVIS_PORT", "80"))
+    upload(image, target, host, port, login(host, port, password))
+
+
+def target_for(image):
+    return "fs" if any(name in image.name for name in ("littlefs", "spiffs")) else "firmware"
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        raise SystemExit("Usage: ota_upload.py <image.bin> [firmware|fs]")
+    image = Path(sys.argv[1])
+    main(image, sys.argv[2] if len(sys.argv) > 2 else target_for(image))
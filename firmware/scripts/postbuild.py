@@ -1,12 +1,24 @@
 import os
+import sys
 from SCons.Script import DefaultEnvironment
 
 env = DefaultEnvironment()
 
 # This function runs after firmware is uploaded
 def after_upload(source, target, env):
+    if env.GetProjectOption("upload_protocol", "") == "custom":
+        # Over the air the device is now rebooting into the new firmware; the
+        # filesystem image must wait until it answers again
+        sys.path.insert(0, os.path.join(env["PROJECT_DIR"], "scripts"))
+        from ota_upload import wait_for_device
+        host = os.environ.get("JARVIS_HOST")
+        port = int(os.environ.get("JARVIS_PORT", "80"))
+        print("⏳ Waiting for the device to come back...")
+        if not host or not wait_for_device(host, port):
+            print("⚠️ Device did not come back; run 'pio run -e %s --target uploadfs' later" % env["PIOENV"])
+            return
     print("📂 Uploading filesystem (LittleFS/SPIFFS)...")
-    os.system("pio run --target uploadfs")
+    os.system("pio run -e %s --target uploadfs" % env["PIOENV"])
 
 # Add the hook
-env.AddPostAction("upload", after_upload)
\ No newline at end of file
+env.AddPostAction("upload", after_upload)
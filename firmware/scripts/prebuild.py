@@ -1,11 +1,55 @@
 import os
 from SCons.Script import DefaultEnvironment
+import gzip
+import hashlib
+import re
 import shutil
 import subprocess
 from pathlib import Path
 
 env = DefaultEnvironment()
 
+# Text assets worth compressing; images/fonts are already compressed
+GZIP_EXTENSIONS = {".html", ".js", ".css", ".svg", ".json", ".txt", ".ico", ".map"}
+# Vite names build output like index-Bx3kP9aZ.js; those never change content
+HASHED_NAME = re.compile(r"-[A-Za-z0-9_-]{8,}\.[a-z0-9]+$")
+MANIFEST_NAME = "asset-manifest.csv"
+
+def compress_web_assets(web_dir):
+    """Replace compressible files with .gz variants and write the asset manifest.
+
+    Manifest lines: <url path>,<etag>,<gzip 0/1>,<immutable 0/1>
+    The ETag is a hash of the served bytes, so it changes exactly when the file does.
+    """
+    entries = []
+    saved = 0
+
+    for path in sorted(p for p in web_dir.rglob("*") if p.is_file()):
+        if path.name == MANIFEST_NAME:
+            continue
+
+        raw = path.read_bytes()
+        url = "/" + path.relative_to(web_dir).as_posix()
+        served = raw
+        is_gzip = False
+
+        if path.suffix in GZIP_EXTENSIONS:
+            # mtime=0 keeps the output (and its ETag) reproducible between builds
+            compressed = gzip.compress(raw, compresslevel=9, mtime=0)
+            if len(compressed) < len(raw):
+                Path(str(path) + ".gz").write_bytes(compressed)
+                path.unlink()
+                served = compressed
+                is_gzip = True
+                saved += len(raw) - len(compressed)
+
+        etag = hashlib.sha256(served).hexdigest()[:16]
+        immutable = HASHED_NAME.search(path.name) is not None
+        entries.append(f"{url},{etag},{int(is_gzip)},{int(immutable)}")
+
+    (web_dir / MANIFEST_NAME).write_text("\n".join(entries) + "\n")
+    print(f"🗜️  {len(entries)} web assets, {saved // 1024} KB saved by gzip")
+
 def build_react_and_copy(source, target, env):
     PROJECT_DIR = Path(os.getcwd())
     REACT_DIR = PROJECT_DIR.parent / "frontend"  # adjust if your React project is here
@@ -23,8 +67,9 @@ def build_react_and_copy(source, target, env):
     if (DATA_DIR / "web").exists():
         shutil.rmtree(DATA_DIR / "web")
     shutil.copytree(DIST_DIR, DATA_DIR / "web")
+    compress_web_assets(DATA_DIR / "web")
     
     if not (DATA_DIR / "config.json").exists():
         shutil.copyfile((PROJECT_DIR / "config.example.json"), (PROJECT_DIR / "data" / "config.json"))
 
-env.AddPreAction("upload", build_react_and_copy)
\ No newline at end of file
+env.AddPreAction("upload", build_react_and_copy)
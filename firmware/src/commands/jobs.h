@@ -0,0 +1,23 @@
+#pragma once
+#include "Command.h"
+#include <Arduino.h>
+#include <JobQueue.h>
+
+// Jobs command: background job slots
+Command* jobsCommand = new Command("jobs", [](const String& args) -> String {
+    JobQueue* jobs = jobsCommand->use<JobQueue>("jobs");
+    if (!jobs) {
+        return "[JOBS] Error: Job queue not initialized";
+    }
+
+    String output = "[JOBS] Recent jobs:";
+    bool any = false;
+    jobs->forEach([&output, &any](const JobQueue::Info& job) {
+        any = true;
+        output += "\n  " + String(job.id) + " " + job.name + ": " + JobQueue::stateName(job.state) +
+                  " (waited " + String(job.queuedMs) + " ms, ran " + String(job.runMs) + " ms)";
+        if (job.state == JobQueue::State::Failed) output += " " + String(job.status) + " " + job.error;
+    });
+    if (!any) output += " none";
+    return output;
+});
@@ -0,0 +1,51 @@
+#pragma once
+#include "Command.h"
+#include <Arduino.h>
+#include <Utils.h>
+#include <vector>
+#include "server/middlewares/metrics.h"
+#include <AdmissionControl.h>
+
+// Metrics command: per-route request statistics
+Command* metricsCommand = new Command("metrics", [](const String& args) -> String {
+    std::vector<String> tokens = splitArgs(args);
+
+    MetricsMiddleware* metrics = metricsCommand->use<MetricsMiddleware>("metrics");
+    if (!metrics) {
+        return "[METRICS] Error: Metrics not initialized";
+    }
+
+    if (!tokens.empty() && tokens[0] == "reset") {
+        metrics->reset();
+        return "[METRICS] Counters reset";
+    }
+    if (!tokens.empty()) return "[METRICS] Usage: metrics [reset]";
+
+    String output = "[METRICS] route: count 2xx/4xx/5xx, avg/max ms, heap max\n";
+    const MetricsMiddleware::RouteStats* routes = metrics->routes();
+    for (uint8_t i = 0; i < METRICS_MAX_ROUTES; i++) {
+        const MetricsMiddleware::RouteStats& s = routes[i];
+        const char* route = s.route.load();
+        if (!route) continue;
+
+        uint32_t timed = 0;
+        for (uint8_t b = 0; b < MetricsMiddleware::BUCKET_COUNT; b++) timed += s.buckets[b].load();
+        uint32_t total = 0;
+        for (uint8_t c = 0; c < 5; c++) total += s.statusClass[c].load();
+
+        float avgMs = timed ? s.latencySumMicros.load() / 1000.0f / timed : 0;
+        output += "  " + String(route) + ": " + String(total) + " " +
+                  String(s.statusClass[1].load()) + "/" + String(s.statusClass[3].load()) + "/" + String(s.statusClass[4].load()) + ", " +
+                  String(avgMs, 2) + "/" + String(s.latencyMaxMicros.load() / 1000.0f, 2) + " ms, " +
+                  String(s.heapDeltaMax.load()) + " B\n";
+    }
+    AdmissionControl* admission = metricsCommand->use<AdmissionControl>("admission");
+    if (admission) {
+        output += "  In flight: " + String(admission->inFlight()) + ", admitted " + String(admission->admitted()) +
+                  ", shed " + String(admission->shed(AdmissionControl::Verdict::ServerFull)) + " full / " +
+                  String(admission->shed(AdmissionControl::Verdict::RouteFull)) + " route / " +
+                  String(admission->shed(AdmissionControl::Verdict::LowHeap)) + " heap\n";
+    }
+    output += "  Free heap: " + String(ESP.getFreeHeap()) + " bytes";
+    return output;
+});
@@ -9,7 +9,7 @@
 // Mic command with sub-commands
 Command* micCommand = new Command("mic", [](const String& args) -> String {
     std::vector<String> tokens = splitArgs(args);
-    if (tokens.empty()) return "[MIC] Usage: mic <command> [args]\nCommands: status, record";
+    if (tokens.empty()) return "[MIC] Usage: mic <command> [args]\nCommands: status, record, spectrum, source, segments, bench";
     
     String command = tokens[0];
     
@@ -32,9 +32,102 @@ Command* micCommand = new Command("mic", [](const String& args) -> String {
         
         output += "  Sample rate: 16000 Hz\n";
         output += "  Format: 16-bit mono WAV\n";
+        output += "  Source: " + String(micManager->sourceName()) + "\n";
+        output += "  Capture: " + String(micManager->isCapturing() ? "RUNNING" : "IDLE") + "\n";
+        
+        // Audio bus: pool usage and per-subscriber queue state
+        AudioBus& bus = micManager->bus();
+        output += "  Audio bus: " + String(bus.freeBlocks()) + "/" + String(AudioBus::POOL_SIZE) +
+                  " blocks free, " + String(bus.poolExhausted()) + " capture drops\n";
+        for (int i = 0; i < AudioBus::MAX_SUBSCRIBERS; i++) {
+            AudioBus::SubscriberStats stats;
+            if (!bus.subscriberStats(i, stats)) continue;
+            output += "    - " + String(stats.name) + ": " + String(stats.queued) + "/" + String(stats.depth) +
+                      " queued, " + String(stats.delivered) + " delivered, " + String(stats.dropped) + " dropped\n";
+        }
+        
+        output += "  Spectrum: " + String(micManager->isSpectrumActive() ? "ACTIVE" : "INACTIVE") + "\n";
+        
+        if (micManager->isSpectrumActive()) {
+            output += "  Spectrum CPU: " + String(micManager->spectrum().avgCpuMicros()) + " us/block avg, " +
+                      String(micManager->spectrum().maxCpuMicros()) + " us max\n";
+        }
         return output;
     }
     
+    // mic spectrum - spectrum analyser mode
+    else if (command == "spectrum") {
+        static bool liveView = false;
+        static int liveListener = -1;
+        
+        String subCommand = tokens.size() > 1 ? tokens[1] : "show";
+        
+        if (subCommand == "start") {
+            if (!micManager->startSpectrum()) {
+                return "[MIC] Error: Spectrum already running or failed to start";
+            }
+            return "[MIC] Spectrum analyser started (16 bands, 512-point FFT)";
+        }
+        
+        else if (subCommand == "stop") {
+            liveView = false;
+            if (!micManager->stopSpectrum()) {
+                return "[MIC] Error: Spectrum not running";
+            }
+            return "[MIC] Spectrum analyser stopped";
+        }
+        
+        else if (subCommand == "live") {
+            if (!micManager->isSpectrumActive()) {
+                return "[MIC] Error: Spectrum not running. Start it with 'mic spectrum start'";
+            }
+            
+            // Subscribe once; the listener prints ~4 frames/s while the live view is on
+            if (liveListener < 0) {
+                liveListener = micManager->addSpectrumListener([](const SpectrumFrame& frame) {
+                    static uint32_t lastPrint = 0;
+                    if (!liveView || millis() - lastPrint < 250) return;
+                    if (Serial.availableForWrite() < SpectrumFrame::BAND_COUNT + 16) return;
+                    lastPrint = millis();
+                    
+                    char line[SpectrumFrame::BAND_COUNT + 16];
+                    for (uint8_t b = 0; b < SpectrumFrame::BAND_COUNT; b++) {
+                        line[b] = " .:-=+*#%@"[frame.bands[b] * 9 / 255];
+                    }
+                    snprintf(line + SpectrumFrame::BAND_COUNT, 16, "| %uus", (unsigned)frame.cpuMicros);
+                    Serial.println(line);
+                });
+                if (liveListener < 0) {
+                    return "[MIC] Error: No free spectrum listener slot";
+                }
+            }
+            
+            liveView = !liveView;
+            return liveView ? "[MIC] Live spectrum view ON (run again to turn off)" : "[MIC] Live spectrum view OFF";
+        }
+        
+        else if (subCommand == "show") {
+            if (!micManager->isSpectrumActive()) {
+                return "[MIC] Error: Spectrum not running. Start it with 'mic spectrum start'";
+            }
+            
+            const SpectrumAnalyzer& spectrum = micManager->spectrum();
+            const SpectrumFrame& frame = spectrum.frame();
+            String output = "[MIC] Spectrum (frame " + String(frame.sequence) + "):\n";
+            for (uint8_t b = 0; b < SpectrumFrame::BAND_COUNT; b++) {
+                output += "  " + String(b < 10 ? " " : "") + String(b) + " |";
+                for (uint8_t i = 0; i < frame.bands[b] / 8; i++) output += "#";
+                output += "\n";
+            }
+            output += "  CPU: " + String(spectrum.lastCpuMicros()) + " us last, " +
+                      String(spectrum.avgCpuMicros()) + " us avg, " +
+                      String(spectrum.maxCpuMicros()) + " us max per block";
+            return output;
+        }
+        
+        return "[MIC] Usage: mic spectrum [start|stop|show|live]";
+    }
+    
     // mic record - recording control
     else if (command == "record") {
         if (tokens.size() < 2) {
@@ -81,6 +174,32 @@ Command* micCommand = new Command("mic", [](const String& args) -> String {
             }
         }
         
+        // mic record segmented <dir> [seconds] [quotaKB]
+        else if (subCommand == "segmented") {
+            if (tokens.size() < 3) {
+                return "[MIC] Usage: mic record segmented <directory> [segmentSeconds=60] [quotaKB=512]";
+            }
+            
+            if (micManager->isRecording()) {
+                return "[MIC] Error: Already recording. Stop first with 'mic record stop'";
+            }
+            
+            String directory = tokens[2];
+            uint32_t segmentSeconds = tokens.size() > 3 ? tokens[3].toInt() : 60;
+            size_t quotaKB = tokens.size() > 4 ? tokens[4].toInt() : 512;
+            
+            if (micManager->startSegmentedRecording(directory, segmentSeconds, quotaKB * 1024)) {
+                return "[MIC] Segmented recording started:\n"
+                       "  Directory: " + directory + "\n" +
+                       "  Segment length: " + String(segmentSeconds) + " s\n" +
+                       "  Quota: " + String(quotaKB) + " KB (oldest segments are deleted)\n" +
+                       "  Stop with: mic record stop";
+            } else {
+                return "[MIC] Error: Failed to start segmented recording\n"
+                       "Check the directory and that the quota holds at least one segment.";
+            }
+        }
+        
         // mic record stop
         else if (subCommand == "stop") {
             if (!micManager->isRecording()) {
@@ -97,6 +216,10 @@ Command* micCommand = new Command("mic", [](const String& args) -> String {
             float durationSec = duration / 1000.0;
             
             String output = "[MIC] Recording stopped:\n";
+            if (micManager->isSegmented()) {
+                output += "  Segments kept: " + String(micManager->getSegmentCount()) + " (" +
+                          String(micManager->getSegmentsBytes() / 1024) + " KB)\n";
+            }
             output += "  Duration: " + String(duration) + " ms (" + String(durationSec, 1) + "s)\n";
             output += "  File size: " + String(bytes) + " bytes (" + String(sizeKB, 1) + " KB)\n";
             output += "  Bitrate: " + String((bytes * 8) / durationSec) + " bps\n";
@@ -107,8 +230,88 @@ Command* micCommand = new Command("mic", [](const String& args) -> String {
         
         else {
             return "[MIC] Error: Unknown record sub-command: " + subCommand + "\n" +
-                   "Valid sub-commands: start, stop";
+                   "Valid sub-commands: start, segmented, stop";
+        }
+    }
+    
+    // mic segments <dir> [fromSec] [toSec] - look up segments covering a time range
+    else if (command == "segments") {
+        if (tokens.size() < 2) {
+            return "[MIC] Usage: mic segments <directory> [fromSec] [toSec]";
+        }
+        
+        String directory = tokens[1];
+        if (directory.endsWith("/")) directory = directory.substring(0, directory.length() - 1);
+        if (!directory.startsWith("/")) directory = "/" + directory;
+        
+        uint32_t fromMs = tokens.size() > 2 ? tokens[2].toInt() * 1000 : 0;
+        uint32_t toMs = tokens.size() > 3 ? tokens[3].toInt() * 1000 : UINT32_MAX;
+        
+        std::vector<MicManager::SegmentInfo> segments;
+        if (!MicManager::findSegments(directory, fromMs, toMs, segments)) {
+            return "[MIC] Error: No segment index in '" + directory + "'";
         }
+        
+        String output = "[MIC] Segments in " + directory + ":\n";
+        for (size_t i = 0; i < segments.size(); i++) {
+            const MicManager::SegmentInfo& info = segments[i];
+            output += "  " + MicManager::segmentPath(directory, info.sequence) +
+                      "  @" + String(info.startMs / 1000.0, 1) + "s" +
+                      "  " + String(info.durationMs / 1000.0, 1) + "s" +
+                      "  " + String(info.bytes) + " bytes\n";
+        }
+        output += "Total: " + String(segments.size()) + " segments";
+        return output;
+    }
+    
+    // mic source i2s|tone [hz]|file <path> - swap the capture input
+    else if (command == "source") {
+        if (tokens.size() < 2) {
+            return "[MIC] Source: " + String(micManager->sourceName()) + "\n"
+                   "Usage: mic source i2s|tone [hz]|file <path.wav>";
+        }
+        
+        String kind = tokens[1];
+        AudioSource* source = nullptr;
+        
+        if (kind == "tone") {
+            float hz = tokens.size() > 2 ? tokens[2].toFloat() : 440.0f;
+            source = new ToneAudioSource(hz);
+        } else if (kind == "file") {
+            if (tokens.size() < 3) {
+                return "[MIC] Usage: mic source file <path.wav>";
+            }
+            source = new FileAudioSource(tokens[2]);
+        } else if (kind != "i2s") {
+            return "[MIC] Error: Unknown source: " + kind + "\nValid sources: i2s, tone, file";
+        }
+        
+        if (!micManager->setSource(source)) {
+            return "[MIC] Error: Could not switch source (stop capture first, or check the WAV file)";
+        }
+        return "[MIC] Source: " + String(micManager->sourceName());
+    }
+    
+    // mic bench [seconds] - capture-path throughput without the microphone
+    else if (command == "bench") {
+        uint32_t seconds = tokens.size() > 1 ? tokens[1].toInt() : 10;
+        if (seconds == 0) seconds = 10;
+        
+        MicManager::CaptureBenchmark result;
+        if (!micManager->runBenchmark(seconds * 16000, result)) {
+            return "[MIC] Error: Benchmark needs capture idle and free space on LittleFS";
+        }
+        
+        float total = result.totalMicros > 0 ? result.totalMicros : 1;
+        float samplesPerSec = result.samples * 1000000.0f / total;
+        
+        String output = "[MIC] Capture benchmark: " + String(seconds) + " s of audio in " +
+                        String(result.totalMicros / 1000) + " ms (" + String(result.blocks) + " blocks, tone at " +
+                        String(MicManager::BENCH_SPEEDUP) + "x real time)\n";
+        output += "  Dropped: " + String(result.dropped) + " blocks\n";
+        output += "  Throughput: " + String(samplesPerSec, 0) + " samples/s (" +
+                  String(samplesPerSec / 16000.0f, 1) + "x real time)";
+        return output;
     }
     
     // mic help - show help
@@ -116,7 +319,14 @@ Command* micCommand = new Command("mic", [](const String& args) -> String {
         return "[MIC] Available commands:\n"
                "  mic status                    - Show microphone status\n"
                "  mic record start <filename>   - Start recording to file\n"
+               "  mic record segmented <dir> [s] [KB] - Record rotating segments under a quota\n"
                "  mic record stop               - Stop recording\n"
+               "  mic segments <dir> [from] [to] - List segments covering a time range (s)\n"
+               "  mic spectrum start|stop       - Start/stop the spectrum analyser\n"
+               "  mic spectrum show             - Show the latest band levels\n"
+               "  mic spectrum live             - Toggle a live band view on serial\n"
+               "  mic source i2s|tone|file      - Capture from the mic, a test tone or a WAV file\n"
+               "  mic bench [seconds]           - Measure capture-path throughput\n"
                "  mic help                      - Show this help\n"
                "\nExamples:\n"
                "  mic record start audio.wav\n"
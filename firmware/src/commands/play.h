@@ -0,0 +1,56 @@
+#pragma once
+#include "Command.h"
+#include <Arduino.h>
+#include <Utils.h>
+#include <vector>
+#include <AudioPlayer.h>
+
+// Play command: WAV playback from LittleFS
+Command* playCommand = new Command("play", [](const String& args) -> String {
+    std::vector<String> tokens = splitArgs(args);
+    if (tokens.empty()) return "[PLAY] Usage: play <filename.wav> | stop | status | volume <0-100>";
+    
+    AudioPlayer* player = playCommand->use<AudioPlayer>("audio");
+    if (!player) {
+        return "[PLAY] Error: AudioPlayer not initialized";
+    }
+    
+    String action = tokens[0];
+    
+    if (action == "stop") {
+        if (!player->stop()) {
+            return "[PLAY] Error: Nothing playing";
+        }
+        return "[PLAY] Stopped";
+    }
+    
+    else if (action == "status") {
+        String output = "[PLAY] Status:\n";
+        output += "  Playing: " + String(player->isPlaying() ? "YES" : "NO") + "\n";
+        output += "  Volume: " + String(player->getVolume()) + "%\n";
+        if (player->getCurrentFilename().length()) {
+            output += "  File: " + player->getCurrentFilename() + "\n";
+            output += "  Position: " + String(player->getPlayedMs()) + " / " + String(player->getDurationMs()) + " ms\n";
+            output += "  Sample rate: " + String(player->getSampleRate()) + " Hz\n";
+            output += "  Start latency: " + String(player->getStartLatencyMicros() / 1000.0, 1) + " ms\n";
+            output += "  Underruns: " + String(player->getUnderruns());
+        }
+        return output;
+    }
+    
+    else if (action == "volume") {
+        if (tokens.size() < 2) return "[PLAY] Volume: " + String(player->getVolume()) + "%";
+        player->setVolume(constrain(tokens[1].toInt(), 0, 100));
+        return "[PLAY] Volume set to " + String(player->getVolume()) + "%";
+    }
+    
+    // Anything else is a file name
+    String filename = action;
+    if (!filename.startsWith("/")) filename = "/" + filename;
+    
+    if (!player->play(filename)) {
+        return "[PLAY] Error: Could not play " + filename + "\n"
+               "Supported: 16-bit PCM or IMA ADPCM mono WAV";
+    }
+    return "[PLAY] Playing " + filename + " (" + String(player->getDurationMs() / 1000.0, 1) + "s)";
+});
@@ -0,0 +1,160 @@
+#pragma once
+#include "Command.h"
+#include <Arduino.h>
+#include <Utils.h>
+#include <vector>
+#include <ServerManager.h>
+#include "SyntheticRequest.h"
+#include "JWTAuth.h"
+
+// Requests benchmarked by a plain `server bench`; none of them changes device state
+struct BenchCase {
+    HttpMethod method;
+    const char* target;
+    const char* body;
+    bool authorized;
+};
+
+static const BenchCase SERVER_BENCH_SUITE[] = {
+    { HttpMethod::Get,  "/status/wizard", nullptr, false },          // no guard
+    { HttpMethod::Post, "/auth/login", "{\"password\":\"\"}", false },  // body parsing, 400
+    { HttpMethod::Post, "/wifi/connect", "{}", false },               // body parsing, 400
+    { HttpMethod::Get,  "/audio/status", nullptr, true },            // AuthGuard + JWT cache
+    { HttpMethod::Get,  "/audio/status", nullptr, false },           // AuthGuard rejection, 401
+};
+
+static bool parseBenchMethod(const String& name, HttpMethod& method) {
+    if (name.equalsIgnoreCase("GET")) method = HttpMethod::Get;
+    else if (name.equalsIgnoreCase("POST")) method = HttpMethod::Post;
+    else if (name.equalsIgnoreCase("DELETE")) method = HttpMethod::Delete;
+    else return false;
+    return true;
+}
+
+static const char* benchMethodName(HttpMethod method) {
+    switch (method) {
+        case HttpMethod::Get:    return "GET";
+        case HttpMethod::Post:   return "POST";
+        case HttpMethod::Delete: return "DELETE";
+        default:                 return "?";
+    }
+}
+
+// One `server bench` line; allocsPerRequest is -1 without JARVIS_ALLOC_TRACE
+struct BenchResult {
+    HttpMethod method;
+    String target;
+    int status;
+    size_t bodyLength;
+    uint32_t iterations;
+    uint32_t totalMicros;
+    uint32_t maxMicros;
+    float allocsPerRequest;
+    int32_t heapDelta;
+
+    float requestsPerSecond() const { return totalMicros ? iterations * 1000000.0f / totalMicros : 0; }
+};
+
+// Runs one request `iterations` times through ServerManager::handle(). Also used by
+// the native tests, which report the same numbers on the host.
+static BenchResult measureBench(ServerManager* server, HttpMethod method, const String& target,
+                                const String& body, const String& token, uint32_t iterations) {
+    SyntheticRequest request(method, target);
+    if (token.length()) request.withHeader("Authorization", "Bearer " + token);
+    const uint8_t* data = body.length() ? reinterpret_cast<const uint8_t*>(body.c_str()) : nullptr;
+
+    // Warm-up: first-use allocations (metrics slot, token cache) are not counted
+    server->handle(request, data, body.length());
+
+    uint32_t heapBefore = ESP.getFreeHeap();
+    bool counting = ServerManager::beginAllocationCount();
+    uint32_t maxMicros = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < iterations; i++) {
+        request.reset();
+        uint32_t t0 = micros();
+        server->handle(request, data, body.length());
+        uint32_t elapsed = micros() - t0;
+        if (elapsed > maxMicros) maxMicros = elapsed;
+    }
+    uint32_t totalMicros = micros() - start;
+    uint32_t allocations = ServerManager::endAllocationCount();
+
+    BenchResult result;
+    result.method = method;
+    result.target = target;
+    result.status = request.status();
+    result.bodyLength = request.bodyLength();
+    result.iterations = iterations;
+    result.totalMicros = totalMicros;
+    result.maxMicros = maxMicros;
+    result.allocsPerRequest = counting ? (float)allocations / iterations : -1;
+    result.heapDelta = (int32_t)ESP.getFreeHeap() - (int32_t)heapBefore;
+    return result;
+}
+
+static String formatBench(const BenchResult& result) {
+    String line = "  " + String(benchMethodName(result.method)) + " " + result.target + " -> " + String(result.status) +
+                  " (" + String((unsigned)result.bodyLength) + " B): " +
+                  String(result.requestsPerSecond(), 0) + " req/s, avg " +
+                  String(result.totalMicros / 1000.0f / result.iterations, 2) + " ms, max " +
+                  String(result.maxMicros / 1000.0f, 2) + " ms, ";
+    line += result.allocsPerRequest >= 0 ? String(result.allocsPerRequest, 1) + " allocs/req, " : String("allocs n/a, ");
+    line += "heap " + String(result.heapDelta) + " B";
+    return line;
+}
+
+static String runBench(ServerManager* server, HttpMethod method, const String& target,
+                       const String& body, const String& token, uint32_t iterations) {
+    return formatBench(measureBench(server, method, target, body, token, iterations));
+}
+
+// Server command: in-process request benchmarks
+Command* serverCommand = new Command("server", [](const String& args) -> String {
+    std::vector<String> tokens = splitArgs(args);
+    if (tokens.empty() || (tokens[0] != "bench" && tokens[0] != "cache")) {
+        return "[SERVER] Usage: server bench [iterations]\n"
+               "       server bench <GET|POST|DELETE> <path> [iterations] [body]\n"
+               "       server cache [clear]";
+    }
+
+    ServerManager* server = serverCommand->use<ServerManager>("server");
+    if (!server) return "[SERVER] Error: Server not initialized";
+
+    if (tokens[0] == "cache") {
+        if (tokens.size() > 1 && tokens[1] == "clear") {
+            server->clearCache();
+            return "[SERVER] Response cache cleared";
+        }
+        const ResponseCache& cache = server->cache();
+        return "[SERVER] Response cache: " + String((unsigned)cache.used()) + "/" + String(RESPONSE_CACHE_SLOTS) +
+               " entries, " + String(cache.hits()) + " hits, " + String(cache.misses()) + " misses, " +
+               String(cache.invalidations()) + " invalidations";
+    }
+
+    // A short-lived token, so guarded routes run their full path
+    PooledJson claims = JsonPool::acquire();
+    claims["user"] = "bench";
+    claims["iat"] = millis() / 1000;
+    claims["exp"] = millis() / 1000 + 60;
+    String token = JWTAuth::createToken(claims->as<JsonObject>());
+
+    String output = "[SERVER] Synthetic requests through middleware, guards and handler (" +
+                    String(server->backendName()) + " backend)\n";
+    HttpMethod method;
+    if (tokens.size() >= 3 && parseBenchMethod(tokens[1], method)) {
+        uint32_t iterations = tokens.size() > 3 ? constrain(tokens[3].toInt(), 1, 1000) : 100;
+        String body = tokens.size() > 4 ? tokens[4] : String();
+        output += runBench(server, method, tokens[2], body, token, iterations);
+    } else if (tokens.size() <= 2) {
+        uint32_t iterations = tokens.size() > 1 ? constrain(tokens[1].toInt(), 1, 1000) : 100;
+        for (const BenchCase& c : SERVER_BENCH_SUITE) {
+            output += runBench(server, c.method, c.target, c.body ? c.body : "",
+                               c.authorized ? token : String(), iterations) + "\n";
+        }
+        output += "  Free heap: " + String(ESP.getFreeHeap()) + " bytes";
+    } else {
+        return "[SERVER] Usage: server bench <GET|POST|DELETE> <path> [iterations] [body]";
+    }
+    return output;
+});
@@ -72,10 +72,8 @@ Command* wifiCommand = new Command("wifi", [](const String& args) -> String {
         else {
             if(!wifi->isScanComplete()) return "[WiFI] WiFi List still loading, please try again later.";
             else {
-                String jsonString;
-                DynamicJsonDocument wifiList = wifi->getScanResults();
-                serializeJson(wifiList, jsonString);
-                return "[WiFI] Available list: " + jsonString;
+                WiFiScan scan = wifi->scanResults();
+                return "[WiFI] Available list (" + String(millis() - scan.scannedAt) + " ms old): " + *scan.json;
             }
         }
     }
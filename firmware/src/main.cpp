@@ -13,12 +13,24 @@
 #include <TerminalManager.h>
 #include <FaceManager.h>
 #include <MicManager.h>
+#include <AudioPlayer.h>
 
-#include "server/middlewares/logger.h"
+#include "server/middlewares/metrics.h"
 
 #include "server/routes/auth.h" 
 #include "server/routes/status.h"
 #include "server/routes/wifi.h"
+#include "server/routes/audio.h"
+#include "server/routes/metrics.h"
+#include "server/routes/jobs.h"
+#include "server/routes/fs.h"
+#include "server/routes/system.h"
+#include "server/routes/batch.h"
+
+#ifndef JARVIS_HTTPD
+#include "server/sockets/spectrum.h"
+#endif
+#include "server/sockets/events.h"
 
 #include "commands/info.h"
 #include "commands/wifi.h"
@@ -26,6 +38,10 @@
 #include "commands/face.h"
 #include "commands/bash.h"
 #include "commands/mic.h"
+#include "commands/play.h"
+#include "commands/metrics.h"
+#include "commands/jobs.h"
+#include "commands/server.h"
 
 #define SDA_PIN 22
 #define SCL_PIN 23
@@ -35,10 +51,16 @@ TerminalManager terminal;
 WiFiManager *wifiManager = nullptr;
 ServerManager *webServer = nullptr;
 MicManager* micManager = nullptr;
+AudioPlayer* audioPlayer = nullptr;
+MetricsMiddleware metrics;
+JobQueue jobs;
 
 // GLOBALS
 Face *face;
 
+// Loudest spectrum band, updated from the spectrum task and consumed by the face in loop()
+volatile uint8_t spectrumPeak = 0;
+
 void setup() {
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
     Wire.begin(
@@ -80,30 +102,101 @@ void setup() {
         config.get("server.port").as<int>() | 80
     );
 
+    // Cached responses follow the config keys their routes declared; a new jwt.secret
+    // drops the prepared HMAC key and the validated-token cache
+    config.onChange([](const String& key) {
+        webServer->invalidateCache(key);
+        if (key.startsWith("jwt")) {
+            ServerManager::DispatchLock lock(*webServer);
+            JWTAuth::resetKey();
+        }
+    });
+
+    // Load shedding: answer 503 + Retry-After instead of running out of heap or sockets
+    AdmissionControl& admission = webServer->admission();
+    admission.setMaxInFlight(config.get("server.maxInFlight") | 4);
+    admission.setMinFreeHeap(config.get("server.minFreeHeap") | 20000);
+    admission.setRetryAfter(config.get("server.retryAfter") | 1);
+    admission.limit("/wifi", 1);       // connects hold the radio
+    admission.limit("/wifi/list", 2);  // long-polls only wait for the cached scan table
+    admission.limit("/metrics", 1);
+    admission.limit("/fs", 2);         // downloads hold their slot until the file is sent
+    admission.limit("/system", 1);     // one OTA image at a time
+    admission.limit("/batch", 1);      // sub-requests are not admitted one by one
+
+    // Slow route work (Wi-Fi connects) runs here instead of on the web server task
+    if (!jobs.begin()) {
+        Serial.println("Failed to start job queue");
+    }
+
     // Create and initialize mic manager
     micManager = new MicManager(26, 25, 23); // Adjust pins for your board
     if (!micManager->begin()) {
         Serial.println("Failed to initialize mic");
     }
+
+    // Speaker output on the second I2S port
+    audioPlayer = new AudioPlayer(
+        config.get("audio.bclkPin") | 27,
+        config.get("audio.lrclkPin") | 14,
+        config.get("audio.doutPin") | 13);
+    if (!audioPlayer->begin()) {
+        Serial.println("Failed to initialize audio output");
+    }
     
     // TODO: Add Dependencies
     webServer->addDependency("wifi", wifiManager);
     webServer->addDependency("config", &config);
     webServer->addDependency("face", face);
     webServer->addDependency("mic", micManager);
+    webServer->addDependency("audio", audioPlayer);
+    webServer->addDependency("metrics", &metrics);
+    webServer->addDependency("admission", &admission);
+    webServer->addDependency("jobs", &jobs);
+    webServer->addDependency("events", &deviceEvents);
+    webServer->addDependency("server", webServer);   // POST /batch dispatches through it
 
     terminal.addDependency("wifi", wifiManager);
     terminal.addDependency("config", &config);
     terminal.addDependency("face", face);
     terminal.addDependency("mic", micManager);
+    terminal.addDependency("audio", audioPlayer);
+    terminal.addDependency("metrics", &metrics);
+    terminal.addDependency("admission", &admission);
+    terminal.addDependency("jobs", &jobs);
+    terminal.addDependency("server", webServer);
 
     // TODO: Add Middlewares
-    webServer->use(new LoggerMiddleware());
+    // Metrics first, so the time spent in later middleware is counted
+    webServer->use(&metrics);
     
     // TODO: Add Routers
     webServer->addRouter(&authRouter);
     webServer->addRouter(&statusRouter);
     webServer->addRouter(&wifiRouter);
+    webServer->addRouter(&audioRouter);
+    webServer->addRouter(&metricsRouter);
+    webServer->addRouter(&jobsRouter);
+    webServer->addRouter(&fsRouter);
+    webServer->addRouter(&systemRouter);
+    webServer->addRouter(&batchRouter);
+
+#ifndef JARVIS_HTTPD
+    // Spectrum subscribers: dashboard stream and face reactivity
+    attachSpectrumSocket(micManager);
+    webServer->addSocket(&spectrumSocket);
+#endif
+
+    // Pushed device state instead of dashboard polling
+    deviceEvents.setInterval(config.get("server.eventIntervalMs") | 250);
+    attachDeviceEvents(wifiManager, micManager, face, &spectrumPeak);
+    webServer->addEvents(&deviceEvents);
+    micManager->addSpectrumListener([](const SpectrumFrame& frame) {
+        uint8_t peak = 0;
+        for (uint8_t b = 0; b < SpectrumFrame::BAND_COUNT; b++)
+            if (frame.bands[b] > peak) peak = frame.bands[b];
+        spectrumPeak = peak;
+    });
 
     // Setup Terminal Commands
     terminal.addCommand(infoCommand);
@@ -112,6 +205,10 @@ void setup() {
     terminal.addCommand(faceCommand);
     terminal.addCommand(bashCommand);
     terminal.addCommand(micCommand);
+    terminal.addCommand(playCommand);
+    terminal.addCommand(metricsCommand);
+    terminal.addCommand(jobsCommand);
+    terminal.addCommand(serverCommand);
 
     wifiManager->setAPStartedCallback([&]() {
         Serial.println("Starting webserver in AP mode...");
@@ -132,5 +229,20 @@ void setup() {
 
 void loop() {
     terminal.handleInput();
+
+#ifndef JARVIS_HTTPD
+    pumpSpectrumSocket();
+#endif
+
+    // Background Wi-Fi scans while the setup AP is up; /wifi/list reads the cached table
+    wifiManager->updateScan();
+
+    // Blink when a loud sound comes in while the spectrum analyser is running
+    static uint32_t lastReaction = 0;
+    if (micManager->isSpectrumActive() && spectrumPeak > 200 && millis() - lastReaction > 1500) {
+        face->DoBlink();
+        lastReaction = millis();
+    }
+
     face->Update();
 }
@@ -6,12 +6,15 @@
 
 class AuthGuard : public Guard {
 public:
-    bool canActivate(AsyncWebServerRequest* request) override {
+    bool canActivate(HttpRequest* request) override {
+        // Sub-request of a batch whose token was checked once for all of them
+        if (request->authenticated()) return true;
+
         String token;
 
         // Check for Authorization header
         if (request->hasHeader("Authorization")) {
-            auto auth = request->getHeader("Authorization")->value();
+            const String& auth = request->header("Authorization");
             if (auth.startsWith("Bearer ")) {
                 token = auth.substring(7);  // Extract token after "Bearer "
             }
@@ -19,7 +22,7 @@ public:
 
         // Check for accessToken in cookies if no Authorization header
         if (token.isEmpty() && request->hasHeader("Cookie")) {
-            auto cookieHeader = request->getHeader("Cookie")->value();
+            const String& cookieHeader = request->header("Cookie");
             token = extractTokenFromCookies(cookieHeader, "accessToken");
         }
 
@@ -3,7 +3,7 @@
 
 class LoggerMiddleware : public Middleware {
 public:
-    void handle(AsyncWebServerRequest* request, std::function<void()> next) override {
+    void handle(HttpRequest* request, std::function<void()> next) override {
         Serial.print("[Logger] Request URL: ");
         Serial.println(request->url());
         next();
@@ -0,0 +1,160 @@
+#pragma once
+#include "Middleware.h"
+#include <Arduino.h>
+#include <atomic>
+
+// Routes tracked individually; override with -D METRICS_MAX_ROUTES=...
+#ifndef METRICS_MAX_ROUTES
+#define METRICS_MAX_ROUTES 32
+#endif
+
+// Per-route request counts, status classes, latency histogram and heap held per response.
+// Counters are fixed atomics: recording never allocates or locks, and readers (terminal,
+// /metrics) see each counter consistently without stopping the server.
+class MetricsMiddleware : public Middleware {
+public:
+    static const uint8_t BUCKET_COUNT = 10;     // 9 bounds + overflow
+
+    struct RouteStats {
+        std::atomic<const char*> route;         // route path owned by its Router; nullptr = free slot
+        std::atomic<uint32_t> statusClass[5];   // 1xx..5xx
+        std::atomic<uint32_t> buckets[BUCKET_COUNT];
+        std::atomic<uint32_t> latencySumMicros; // wraps after ~71 min of handler time
+        std::atomic<uint32_t> latencyMaxMicros;
+        std::atomic<int32_t> heapDeltaMax;      // bytes still held once the response was queued
+    };
+
+    void handle(HttpRequest* request, std::function<void()> next) override {
+        // Requests are dispatched one at a time, but a handler may dispatch
+        // sub-requests (POST /batch): each is timed on its own, then the outer
+        // request's start is restored for its response
+        uint32_t outerMicros = _startMicros;
+        uint32_t outerHeap = _startHeap;
+        bool outerPending = _pending;
+
+        _startMicros = micros();
+        _startHeap = ESP.getFreeHeap();
+        _pending = true;
+        next();
+
+        _startMicros = outerMicros;
+        _startHeap = outerHeap;
+        _pending = outerPending;
+    }
+
+    void onResponse(HttpRequest* request, const char* route, int status) override {
+        RouteStats* stats = statsFor(route);
+        if (!stats) return;
+
+        uint8_t statusClass = constrain(status / 100, 1, 5) - 1;
+        stats->statusClass[statusClass].fetch_add(1, std::memory_order_relaxed);
+
+        // Rejected before this middleware ran: counted, but not timed
+        if (!_pending) return;
+        _pending = false;
+
+        uint32_t latency = micros() - _startMicros;
+        int32_t heapDelta = (int32_t)_startHeap - (int32_t)ESP.getFreeHeap();
+
+        uint8_t bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && latency > BUCKET_BOUNDS_MICROS[bucket]) bucket++;
+        stats->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        stats->latencySumMicros.fetch_add(latency, std::memory_order_relaxed);
+        raiseTo(stats->latencyMaxMicros, latency);
+        raiseTo(stats->heapDeltaMax, heapDelta);
+    }
+
+    // Prometheus text exposition format (version 0.0.4)
+    void printPrometheus(Print& out) const {
+        static const char* const classes[5] = { "1xx", "2xx", "3xx", "4xx", "5xx" };
+
+        out.print("# HELP jarvis_http_requests_total Routed HTTP requests by status class.\n"
+                  "# TYPE jarvis_http_requests_total counter\n");
+        for (const RouteStats& s : _routes) {
+            const char* route = s.route.load();
+            if (!route) continue;
+            for (uint8_t c = 0; c < 5; c++) {
+                uint32_t count = s.statusClass[c].load(std::memory_order_relaxed);
+                if (count) out.printf("jarvis_http_requests_total{route=\"%s\",code=\"%s\"} %u\n", route, classes[c], (unsigned)count);
+            }
+        }
+
+        out.print("# HELP jarvis_http_request_duration_seconds Time from the first middleware to the response being queued.\n"
+                  "# TYPE jarvis_http_request_duration_seconds histogram\n");
+        for (const RouteStats& s : _routes) {
+            const char* route = s.route.load();
+            if (!route) continue;
+            uint32_t cumulative = 0;
+            for (uint8_t b = 0; b < BUCKET_COUNT; b++) {
+                cumulative += s.buckets[b].load(std::memory_order_relaxed);
+                if (b < BUCKET_COUNT - 1)
+                    out.printf("jarvis_http_request_duration_seconds_bucket{route=\"%s\",le=\"%g\"} %u\n",
+                               route, BUCKET_BOUNDS_MICROS[b] / 1e6, (unsigned)cumulative);
+                else
+                    out.printf("jarvis_http_request_duration_seconds_bucket{route=\"%s\",le=\"+Inf\"} %u\n", route, (unsigned)cumulative);
+            }
+            out.printf("jarvis_http_request_duration_seconds_sum{route=\"%s\"} %.6f\n",
+                       route, s.latencySumMicros.load(std::memory_order_relaxed) / 1e6);
+            out.printf("jarvis_http_request_duration_seconds_count{route=\"%s\"} %u\n", route, (unsigned)cumulative);
+        }
+
+        out.print("# HELP jarvis_http_response_heap_bytes_max Largest heap drop between request start and response queued.\n"
+                  "# TYPE jarvis_http_response_heap_bytes_max gauge\n");
+        for (const RouteStats& s : _routes) {
+            const char* route = s.route.load();
+            if (route) out.printf("jarvis_http_response_heap_bytes_max{route=\"%s\"} %d\n",
+                                  route, (int)s.heapDeltaMax.load(std::memory_order_relaxed));
+        }
+
+        out.printf("# HELP jarvis_http_untracked_routes_total Responses for routes beyond METRICS_MAX_ROUTES.\n"
+                   "# TYPE jarvis_http_untracked_routes_total counter\n"
+                   "jarvis_http_untracked_routes_total %u\n", (unsigned)_untracked.load());
+        out.printf("# TYPE jarvis_heap_free_bytes gauge\njarvis_heap_free_bytes %u\n", (unsigned)ESP.getFreeHeap());
+        out.printf("# TYPE jarvis_uptime_seconds counter\njarvis_uptime_seconds %u\n", (unsigned)(millis() / 1000));
+    }
+
+    const RouteStats* routes() const { return _routes; }
+
+    void reset() {
+        for (RouteStats& s : _routes) {
+            for (auto& c : s.statusClass) c.store(0);
+            for (auto& b : s.buckets) b.store(0);
+            s.latencySumMicros.store(0);
+            s.latencyMaxMicros.store(0);
+            s.heapDeltaMax.store(0);
+        }
+        _untracked.store(0);
+    }
+
+    // Upper bounds of the histogram buckets
+    static constexpr uint32_t BUCKET_BOUNDS_MICROS[BUCKET_COUNT - 1] = {
+        1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+    };
+
+private:
+    RouteStats _routes[METRICS_MAX_ROUTES] = {};
+    std::atomic<uint32_t> _untracked{0};
+    uint32_t _startMicros = 0;
+    uint32_t _startHeap = 0;
+    bool _pending = false;
+
+    // Route paths are stable pointers, so a slot is claimed once with a CAS and then matched by address
+    RouteStats* statsFor(const char* route) {
+        for (RouteStats& s : _routes) {
+            const char* key = s.route.load();
+            if (key == route) return &s;
+            if (!key && s.route.compare_exchange_strong(key, route)) return &s;
+            if (key == route) return &s;    // claimed by someone else in the meantime
+        }
+        _untracked.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    template<typename T>
+    static void raiseTo(std::atomic<T>& target, T value) {
+        T current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value)) {}
+    }
+};
+
+constexpr uint32_t MetricsMiddleware::BUCKET_BOUNDS_MICROS[MetricsMiddleware::BUCKET_COUNT - 1];
@@ -0,0 +1,56 @@
+#pragma once
+#include "Router.h"
+#include "HttpError.h"
+#include "HttpSuccess.h"
+#include "JsonBody.h"
+#include "AudioPlayer.h"
+#include "../guards/AuthGuard.h"
+
+AuthGuard audioAuthGuard;
+
+static const BodySchema playBody({
+    { "file", BodyType::String, true, 128 },
+    { "volume", BodyType::Int },
+}, 256);
+
+Router audioRouter("/audio", [](Router *r) {
+    r->useGuards({ &audioAuthGuard });
+
+    r->get("/status", [r](HttpRequest *request) -> HttpSuccess {
+        AudioPlayer* player = r->use<AudioPlayer>("audio");
+
+        PooledJson status = JsonPool::acquire();
+        status["playing"] = player->isPlaying();
+        status["file"] = player->getCurrentFilename();
+        status["positionMs"] = player->getPlayedMs();
+        status["durationMs"] = player->getDurationMs();
+        status["volume"] = player->getVolume();
+        return HttpSuccess(std::move(status));
+    });
+
+    r->postWithSchema("/play", playBody, [r](HttpRequest *request, const ParsedBody &body) -> HttpSuccess {
+        String file = body.str("file");
+        if (file.isEmpty()) {
+            throw HttpError(400, "file is required");
+        }
+        if (!file.startsWith("/")) file = "/" + file;
+
+        AudioPlayer* player = r->use<AudioPlayer>("audio");
+        if (body.has("volume")) {
+            player->setVolume(constrain(body.integer("volume"), 0, 100));
+        }
+
+        if (!LittleFS.exists(file)) {
+            throw HttpError(404, "File not found");
+        }
+        if (!player->play(file)) {
+            throw HttpError(415, "Unsupported audio format");
+        }
+        return HttpSuccess(true);
+    });
+
+    r->post("/stop", [r](HttpRequest *request) -> HttpSuccess {
+        AudioPlayer* player = r->use<AudioPlayer>("audio");
+        return HttpSuccess(player->stop());
+    });
+});
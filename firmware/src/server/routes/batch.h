@@ -0,0 +1,141 @@
+#pragma once
+#include "Router.h"
+#include "HttpError.h"
+#include "HttpSuccess.h"
+#include "JsonBody.h"
+#include "JsonWriter.h"
+#include "SyntheticRequest.h"
+#include "../guards/AuthGuard.h"
+#include <ServerManager.h>
+#include <memory>
+#include <vector>
+
+// Most sub-requests per batch, and response bytes kept for all of them together
+#ifndef BATCH_MAX_REQUESTS
+#define BATCH_MAX_REQUESTS 8
+#endif
+static_assert(BATCH_MAX_REQUESTS < 16, "batch results are written as a msgpack fixarray");
+#ifndef BATCH_MAX_RESPONSE
+#define BATCH_MAX_RESPONSE 8192
+#endif
+
+// Checked once per batch, not by the sub-requests
+AuthGuard batchAuthGuard;
+
+struct BatchResult {
+    int status;
+    bool raw;           // body is in the batch's own format and is embedded as is
+    String body;
+};
+
+static bool batchMethod(const char* name, HttpMethod& method) {
+    if (!strcmp(name, "GET")) method = HttpMethod::Get;
+    else if (!strcmp(name, "POST")) method = HttpMethod::Post;
+    else if (!strcmp(name, "DELETE")) method = HttpMethod::Delete;
+    else return false;
+    return true;
+}
+
+static void batchPrintJson(Print& out, const std::vector<BatchResult>& results) {
+    out.print("{\"ok\":true,\"data\":[");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BatchResult& result = results[i];
+        if (i) out.write(',');
+        out.printf("{\"status\":%d,\"body\":", result.status);
+        if (result.raw) out.print(result.body);
+        else printJsonString(out, result.body.c_str());
+        out.write('}');
+    }
+    out.print("]}");
+}
+
+static void batchPrintMsgPack(Print& out, const std::vector<BatchResult>& results) {
+    printMsgPackEnvelope(out, true, "data");
+    out.write((uint8_t)(0x90 | results.size()));      // fixarray, see BATCH_MAX_REQUESTS
+    for (const BatchResult& result : results) {
+        out.write((uint8_t)0x82);
+        printMsgPackString(out, "status", 6);
+        out.write((uint8_t)0xcd);                      // uint16
+        out.write((uint8_t)(result.status >> 8));
+        out.write((uint8_t)result.status);
+        printMsgPackString(out, "body", 4);
+        if (result.raw) out.write(reinterpret_cast<const uint8_t*>(result.body.c_str()), result.body.length());
+        else printMsgPackString(out, result.body.c_str(), result.body.length());
+    }
+}
+
+// POST /batch with [{ method, path, body }] runs each entry in-process through
+// the normal routes, in order, and answers { ok, data: [{ status, body }] }.
+// The client's token is checked once here; guarded sub-requests are then trusted.
+// Without a valid token the batch still runs, and guarded entries answer 401.
+Router batchRouter("/batch", [](Router *r) {
+    r->postWithBody("", [r](HttpRequest *request, const uint8_t *data, size_t len) -> HttpSuccess {
+        PooledJson body = JsonPool::acquire();
+        if (deserializeBody(*body, request, data, len)) throw HttpError(400, "Invalid JSON body");
+        JsonArrayConst operations = body->as<JsonArrayConst>();
+        if (operations.isNull()) throw HttpError(400, "Expected an array of requests");
+        if (operations.size() > BATCH_MAX_REQUESTS) throw HttpError(413, "Too many requests in batch");
+
+        bool authenticated = false;
+        try {
+            authenticated = batchAuthGuard.canActivate(request);
+        } catch (const HttpError&) {
+        }
+
+        ServerManager* server = r->use<ServerManager>("server");
+        bool msgpack = request->acceptsMsgPack();
+        const char* format = msgpack ? "application/msgpack" : "application/json";
+
+        std::shared_ptr<std::vector<BatchResult>> results(new std::vector<BatchResult>());
+        results->reserve(operations.size());
+        size_t budget = BATCH_MAX_RESPONSE;
+
+        for (JsonObjectConst operation : operations) {
+            HttpMethod method = HttpMethod::Other;
+            bool valid = batchMethod(operation["method"] | "GET", method);
+            const char* path = operation["path"] | "";
+            SyntheticRequest sub(method, path);
+            if (msgpack) sub.withHeader("Accept", "application/msgpack");
+            if (authenticated) sub.withAuthentication();
+
+            if (!valid) {
+                HttpError(400, "Unsupported method").send(&sub);
+            } else if (path[0] != '/') {
+                HttpError(400, "path is required").send(&sub);
+            } else if (sub.url() == "/batch" || sub.url().startsWith("/batch/")) {
+                HttpError(400, "Batches cannot be nested").send(&sub);
+            } else if (server->fillsBody(sub)) {
+                HttpError(400, "Streamed responses cannot be batched").send(&sub);
+            } else if (operation["body"].isNull()) {
+                server->handle(sub);
+            } else {
+                String subBody;
+                serializeJson(operation["body"], subBody);
+                server->handle(sub, reinterpret_cast<const uint8_t*>(subBody.c_str()), subBody.length());
+            }
+
+            // Bodies that were cut off or do not fit the batch are replaced by an error
+            if (sub.bodyLength() > sub.body().length() || sub.bodyLength() > budget) {
+                sub.reset();
+                HttpError(507, "Response too large for a batch").send(&sub);
+            }
+            budget -= budget < sub.body().length() ? budget : sub.body().length();
+
+            BatchResult result;
+            result.status = sub.status();
+            result.raw = strcmp(sub.contentType(), format) == 0 && sub.bodyLength() > 0;
+            result.body = sub.body();
+            results->push_back(std::move(result));
+        }
+
+        size_t sizeHint = 16;
+        for (const BatchResult& result : *results) sizeHint += result.body.length() + 24;
+
+        HttpResponse response(200, format);
+        response.stream(sizeHint, [results, msgpack](Print& out) {
+            if (msgpack) batchPrintMsgPack(out, *results);
+            else batchPrintJson(out, *results);
+        });
+        return HttpSuccess(std::move(response));
+    }, {}, 2048);
+});
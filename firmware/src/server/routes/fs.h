@@ -0,0 +1,225 @@
+#pragma once
+#include "Router.h"
+#include "HttpError.h"
+#include "HttpSuccess.h"
+#include "OpenFiles.h"
+#include <LittleFS.h>
+#include <memory>
+#include "../guards/AuthGuard.h"
+
+AuthGuard fsAuthGuard;
+
+// An upload that received no chunk for this long is considered abandoned
+#ifndef FS_UPLOAD_IDLE_MS
+#define FS_UPLOAD_IDLE_MS 5000
+#endif
+
+// Absolute LittleFS path from ?path=<path>, or the rest of the URL for /fs/file/<path>;
+// "." and ".." segments are refused
+static String fsPathParam(HttpRequest* request) {
+    PathParam rest = request->pathParam("*");
+    if (rest.empty() && !request->hasParam("path")) throw HttpError(400, "path parameter is required");
+    String path = rest.empty() ? request->param("path") : rest.toString();
+    if (!path.startsWith("/")) path = "/" + path;
+    if (path.indexOf("/./") >= 0 || path.indexOf("/../") >= 0 || path.endsWith("/.") || path.endsWith("/..")) {
+        throw HttpError(400, "Invalid path");
+    }
+    return path;
+}
+
+static const char* fsContentType(const String& path) {
+    if (path.endsWith(".wav")) return "audio/wav";
+    if (path.endsWith(".mp3")) return "audio/mpeg";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".txt") || path.endsWith(".log")) return "text/plain";
+    if (path.endsWith(".html")) return "text/html";
+    return "application/octet-stream";
+}
+
+// Single range of "bytes=first-last", "bytes=first-" or "bytes=-suffix" (RFC 7233).
+// Multiple ranges are not supported and are answered with the whole file.
+static bool fsParseRange(const String& header, size_t size, size_t& first, size_t& last) {
+    if (!header.startsWith("bytes=") || header.indexOf(',') >= 0) return false;
+    int dash = header.indexOf('-');
+    if (dash < 0) return false;
+    String from = header.substring(6, dash);
+    String to = header.substring(dash + 1);
+    from.trim();
+    to.trim();
+
+    if (from.isEmpty()) {
+        // Suffix: the last N bytes
+        size_t suffix = strtoul(to.c_str(), nullptr, 10);
+        if (to.isEmpty() || suffix == 0 || size == 0) throw HttpError(416, "Range not satisfiable");
+        first = suffix >= size ? 0 : size - suffix;
+        last = size - 1;
+        return true;
+    }
+    first = strtoul(from.c_str(), nullptr, 10);
+    last = to.isEmpty() ? size - 1 : strtoul(to.c_str(), nullptr, 10);
+    if (first >= size || last < first) throw HttpError(416, "Range not satisfiable");
+    if (last >= size) last = size - 1;
+    return true;
+}
+
+// The upload being written. Chunks come from the web server task one at a time,
+// so one upload at a time is enough; a second one gets 409 until the first ends.
+struct FsUpload {
+    const void* request = nullptr;          // HttpRequest::id() of the uploading request
+    File file;
+    std::unique_ptr<OpenFiles::Use> open;   // set while file is open
+    String path;
+    size_t received = 0;
+    uint32_t lastChunkMs = 0;
+
+    bool busy(const void* other) const {
+        return request && request != other && millis() - lastChunkMs < FS_UPLOAD_IDLE_MS;
+    }
+
+    // Drops a partial file, e.g. of a client that went away mid-upload
+    void abort() {
+        if (file) file.close();
+        open.reset();
+        if (path.length()) LittleFS.remove(path + ".part");
+        request = nullptr;
+        path = "";
+        received = 0;
+    }
+};
+
+static FsUpload fsUpload;
+
+Router fsRouter("/fs", [](Router *r) {
+    r->useGuards({ &fsAuthGuard });
+
+    // Directory listing: [{ name, size, dir }]
+    r->get("/list", [](HttpRequest *request) -> HttpSuccess {
+        String path = request->hasParam("path") ? fsPathParam(request) : String("/");
+
+        File dir = LittleFS.open(path);
+        if (!dir || !dir.isDirectory()) throw HttpError(404, "Directory not found");
+
+        PooledJson entries = JsonPool::acquire();
+        JsonArray list = entries->to<JsonArray>();
+        for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+            String name = file.name();
+            int lastSlash = name.lastIndexOf('/');
+            if (lastSlash >= 0) name = name.substring(lastSlash + 1);
+
+            JsonObject entry = list.createNestedObject();
+            entry["name"] = name;
+            entry["size"] = file.isDirectory() ? 0 : file.size();
+            entry["dir"] = file.isDirectory();
+            if (entries->overflowed()) throw HttpError(507, "Directory listing too large");
+        }
+        dir.close();
+        return HttpSuccess(std::move(entries));
+    });
+
+    // Download. The file is read straight into the TCP send buffer as the client
+    // acknowledges data, so memory use does not depend on the file size.
+    Router::Handler download = [](HttpRequest *request) -> HttpSuccess {
+        String path = fsPathParam(request);
+        File file = LittleFS.open(path, "r");
+        if (!file || file.isDirectory()) throw HttpError(404, "File not found");
+
+        size_t size = file.size();
+        size_t first = 0;
+        size_t last = size ? size - 1 : 0;
+        bool partial = request->hasHeader("Range") &&
+                       fsParseRange(request->header("Range"), size, first, last);
+        size_t length = size ? last - first + 1 : 0;
+
+        HttpResponse response(partial ? 206 : 200, fsContentType(path));
+        OpenFiles::Use use;
+        response.fill(length, [file, use, first, length](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+            if (index >= length) return 0;
+            if (file.position() != first + index) file.seek(first + index);
+            size_t chunk = length - index < maxLen ? length - index : maxLen;
+            int read = file.read(buffer, chunk);
+            return read > 0 ? read : 0;
+        });
+        response.header("Accept-Ranges", "bytes");
+        response.header("Cache-Control", "no-cache");
+        if (partial) {
+            response.header("Content-Range", "bytes " + String(first) + "-" + String(last) + "/" + String(size));
+        }
+        return HttpSuccess(std::move(response));
+    };
+    r->get("/file", download);
+    r->get("/file/*", download);
+    r->fills("/file");
+    r->fills("/file/*");
+
+    // Upload: POST /fs/file?path=... with the raw file as body. Each chunk is
+    // written to "<path>.part" as it arrives; the file replaces <path> when complete.
+    r->postStream("/file",
+        [](HttpRequest *request, const uint8_t *data, size_t len, size_t index, size_t total) {
+            if (index == 0) {
+                if (fsUpload.busy(request->id())) throw HttpError(409, "Another upload is in progress");
+                fsUpload.abort();
+
+                String path = fsPathParam(request);
+                if (path.endsWith("/")) throw HttpError(400, "Invalid path");
+                size_t free = LittleFS.totalBytes() - LittleFS.usedBytes();
+                if (total > free) throw HttpError(507, "Not enough space");
+
+                fsUpload.file = LittleFS.open(path + ".part", "w");
+                if (!fsUpload.file) throw HttpError(500, "Cannot create file");
+                fsUpload.open.reset(new OpenFiles::Use());
+                fsUpload.request = request->id();
+                fsUpload.path = path;
+            }
+            if (fsUpload.request != request->id()) throw HttpError(409, "Upload was interrupted");
+
+            fsUpload.lastChunkMs = millis();
+            if (fsUpload.file.write(data, len) != len) {
+                fsUpload.abort();
+                throw HttpError(507, "Write failed");
+            }
+            fsUpload.received += len;
+        },
+        [](HttpRequest *request) -> HttpSuccess {
+            String path;
+            size_t size = 0;
+            if (fsUpload.request == request->id()) {
+                path = fsUpload.path;
+                size = fsUpload.received;
+                fsUpload.file.close();
+                fsUpload.open.reset();
+                LittleFS.remove(path);
+                bool renamed = LittleFS.rename(path + ".part", path);
+                fsUpload.request = nullptr;
+                fsUpload.path = "";
+                fsUpload.received = 0;
+                if (!renamed) throw HttpError(500, "Cannot store file");
+            } else {
+                // Empty body: create an empty file
+                path = fsPathParam(request);
+                File file = LittleFS.open(path, "w");
+                if (!file) throw HttpError(500, "Cannot create file");
+                file.close();
+            }
+
+            PooledJson result = JsonPool::acquire();
+            result["path"] = path;
+            result["size"] = size;
+            return HttpSuccess(std::move(result));
+        });
+
+    Router::Handler remove = [](HttpRequest *request) -> HttpSuccess {
+        String path = fsPathParam(request);
+        if (path == "/") throw HttpError(400, "Invalid path");
+
+        File target = LittleFS.open(path);
+        if (!target) throw HttpError(404, "File not found");
+        bool isDir = target.isDirectory();
+        target.close();
+
+        bool removed = isDir ? LittleFS.rmdir(path) : LittleFS.remove(path);
+        if (!removed) throw HttpError(409, isDir ? "Directory is not empty" : "Cannot remove file");
+        return HttpSuccess(true);
+    };
+    r->del("/file", remove);
+    r->del("/file/*", remove);
+});
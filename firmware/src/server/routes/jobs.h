@@ -0,0 +1,44 @@
+#pragma once
+#include "Router.h"
+#include "HttpError.h"
+#include "HttpSuccess.h"
+#include <JobQueue.h>
+
+static HttpSuccess jobStatus(Router* r, uint32_t id) {
+    JobQueue* jobs = r->use<JobQueue>("jobs");
+    JobQueue::Info job;
+    if (!jobs->info(id, job)) throw HttpError(404, "Unknown job");
+
+    PooledJson result = JsonPool::acquire();
+    result["id"] = job.id;
+    result["name"] = job.name;
+    result["state"] = JobQueue::stateName(job.state);
+    result["queuedMs"] = job.queuedMs;
+    result["runMs"] = job.runMs;
+    if (job.state == JobQueue::State::Failed) {
+        result["status"] = job.status;
+        result["error"] = job.error;
+    } else if (job.result.length()) {
+        // Parsed, not serialized(): raw JSON text would be copied as-is into a msgpack body
+        PooledJson stored = JsonPool::acquire();
+        if (deserializeJson(*stored, job.result)) throw HttpError(500, "Job result is unreadable");
+        result["result"] = stored->as<JsonVariantConst>();
+    }
+    return HttpSuccess(std::move(result));
+}
+
+// Status of background jobs started by other routes (202 + id). Unguarded for the setup
+// wizard, which polls before it has a token: results must not hold credentials.
+Router jobsRouter("/jobs", [](Router *r) {
+    // GET /jobs/<id>; GET /jobs?id=<id> is kept for older clients
+    r->get("/:id", [r](HttpRequest *request) -> HttpSuccess {
+        unsigned long id;
+        if (!request->pathParam("id").toULong(id)) throw HttpError(400, "Invalid job id");
+        return jobStatus(r, id);
+    });
+
+    r->get("", [r](HttpRequest *request) -> HttpSuccess {
+        if (!request->hasParam("id")) throw HttpError(400, "id parameter is required");
+        return jobStatus(r, strtoul(request->param("id").c_str(), nullptr, 10));
+    });
+});
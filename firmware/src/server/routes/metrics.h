@@ -0,0 +1,23 @@
+#pragma once
+#include "Router.h"
+#include "HttpSuccess.h"
+#include "server/middlewares/metrics.h"
+#include <AdmissionControl.h>
+#include <ServerManager.h>
+
+// Prometheus scrape target; plain text, not the JSON envelope
+Router metricsRouter("/metrics", [](Router *r) {
+    r->get("", [r](HttpRequest *request) -> HttpSuccess {
+        MetricsMiddleware* metrics = r->use<MetricsMiddleware>("metrics");
+        AdmissionControl* admission = r->use<AdmissionControl>("admission");
+        ServerManager* server = r->use<ServerManager>("server");
+        HttpResponse response(200, "text/plain; version=0.0.4");
+        response.stream(2048, [metrics, admission, server](Print& out) {
+            metrics->printPrometheus(out);
+            if (admission) admission->printPrometheus(out);
+            if (server) out.printf("# TYPE jarvis_http_backend_info gauge\njarvis_http_backend_info{backend=\"%s\"} 1\n",
+                                   server->backendName());
+        });
+        return HttpSuccess(std::move(response));
+    });
+});
@@ -6,9 +6,11 @@
 #include "ConfigManager.h"
 
 Router statusRouter("/status", [](Router *r) {
-    r->get("/wizard", [r](AsyncWebServerRequest *request) -> HttpSuccess {
+    r->get("/wizard", [r](HttpRequest *request) -> HttpSuccess {
         ConfigManager* config = r->use<ConfigManager>("config");
         bool isReady = config->get("isReady").as<bool>();
         return HttpSuccess(!isReady);
     }); // No guards for status route
+    // Polled by every page load; changes only when setup finishes
+    r->cache("/wizard", 60000, { "isReady" });
 });
@@ -0,0 +1,216 @@
+#pragma once
+#include "Router.h"
+#include "HttpError.h"
+#include "HttpSuccess.h"
+#include "ConfigManager.h"
+#include <Update.h>
+#include <LittleFS.h>
+#include <mbedtls/md.h>
+#include <EventHub.h>
+#include <JobQueue.h>
+#include <ServerManager.h>
+#include "OpenFiles.h"
+#include "MicManager.h"
+#include "AudioPlayer.h"
+#include <freertos/timers.h>
+#include "../guards/AuthGuard.h"
+
+AuthGuard systemAuthGuard;
+
+// An update that received no chunk for this long is considered abandoned
+#ifndef OTA_IDLE_MS
+#define OTA_IDLE_MS 10000
+#endif
+
+// The update being flashed. The image goes from each TCP segment straight into the
+// target partition and the running SHA-256; nothing is buffered beyond one chunk.
+struct OtaSession {
+    const void* request = nullptr;          // HttpRequest::id() of the uploading request
+    ConfigManager* config = nullptr;
+    mbedtls_md_context_t hash;
+    bool hashing = false;
+    bool filesystem = false;
+    char expected[65] = {};
+    size_t written = 0;
+    size_t total = 0;
+    uint32_t lastChunkMs = 0;
+    TimerHandle_t idleTimer = nullptr;      // aborts the update when the client goes quiet
+
+    bool busy(const void* other) const {
+        return request && request != other && millis() - lastChunkMs < OTA_IDLE_MS;
+    }
+
+    void finishHash(char* hexOut) {
+        static const char digits[] = "0123456789abcdef";
+        uint8_t digest[32];
+        mbedtls_md_finish(&hash, digest);
+        for (int i = 0; i < 32; i++) {
+            hexOut[i * 2] = digits[digest[i] >> 4];
+            hexOut[i * 2 + 1] = digits[digest[i] & 0x0F];
+        }
+        hexOut[64] = '\0';
+        releaseHash();
+    }
+
+    void releaseHash() {
+        if (hashing) mbedtls_md_free(&hash);
+        hashing = false;
+    }
+
+    void abort();
+};
+
+static OtaSession otaSession;
+
+static void otaPublish(EventHub* events, const char* state) {
+    if (!events) return;
+    char json[EVENT_HUB_PAYLOAD_SIZE];
+    snprintf(json, sizeof(json), "{\"state\":\"%s\",\"target\":\"%s\",\"written\":%u,\"total\":%u}",
+             state, otaSession.filesystem ? "fs" : "firmware",
+             (unsigned)otaSession.written, (unsigned)otaSession.total);
+    events->publish("ota", json);
+}
+
+// A filesystem image replaces config.json too; write the running config back so
+// Wi-Fi credentials, the password hash and the JWT secret survive a /web update.
+// After a failed image LittleFS is formatted and only the config is left.
+static void otaRestoreConfig() {
+    LittleFS.begin(true);
+    if (otaSession.config) otaSession.config->save();
+}
+
+// Drops an unfinished update, e.g. of a client that went away mid-upload
+inline void OtaSession::abort() {
+    if (idleTimer) xTimerStop(idleTimer, 0);
+    bool running = Update.isRunning();
+    if (running) Update.abort();
+    if (running && filesystem) otaRestoreConfig();
+    releaseHash();
+    request = nullptr;
+}
+
+// Timer task: the abort writes flash, so it is left to the job worker, which
+// takes the dispatch lock like the upload handlers do
+static void otaIdleExpired(TimerHandle_t timer) {
+    Router* r = static_cast<Router*>(pvTimerGetTimerID(timer));
+    ServerManager* server = r->use<ServerManager>("server");
+    EventHub* events = r->use<EventHub>("events");
+    try {
+        r->use<JobQueue>("jobs")->submit("system.otaAbort", [server, events](JsonDocument&) {
+            ServerManager::DispatchLock lock(*server);
+            if (!otaSession.request || millis() - otaSession.lastChunkMs < OTA_IDLE_MS) return;
+            otaSession.abort();
+            otaPublish(events, "failed");
+        });
+    } catch (const HttpError&) {
+        xTimerReset(timer, 0);   // queue full: look again after another idle period
+    }
+}
+
+// The partition is unmounted for a filesystem image; refuse while anything has a file open
+static void otaCheckFilesystemIdle(Router* r) {
+    MicManager* mic = r->use<MicManager>("mic");
+    AudioPlayer* audio = r->use<AudioPlayer>("audio");
+    if (mic && mic->isRecording()) throw HttpError(409, "A recording is in progress");
+    if (audio && audio->isPlaying()) throw HttpError(409, "Audio is playing");
+    if (OpenFiles::inUse()) throw HttpError(409, "Files are open, try again");
+}
+
+Router systemRouter("/system", [](Router *r) {
+    r->useGuards({ &systemAuthGuard });
+
+    // POST /system/ota?sha256=<hex>[&target=firmware|fs] with the raw image as body.
+    // Firmware goes to the inactive OTA slot and is only made bootable when the
+    // SHA-256 matches. Progress is published on the "ota" event topic.
+    r->postStream("/ota",
+        [r](HttpRequest *request, const uint8_t *data, size_t len, size_t index, size_t total) {
+            EventHub* events = r->use<EventHub>("events");
+
+            if (index == 0) {
+                if (otaSession.busy(request->id())) throw HttpError(409, "Another update is in progress");
+                otaSession.abort();
+
+                String sha256 = request->param("sha256");
+                sha256.toLowerCase();
+                if (sha256.length() != 64) throw HttpError(400, "sha256 parameter is required");
+                String target = request->hasParam("target") ? request->param("target") : String("firmware");
+                if (target != "firmware" && target != "fs") throw HttpError(400, "target must be firmware or fs");
+                if (total == 0) throw HttpError(411, "Content-Length is required");
+
+                if (target == "fs") otaCheckFilesystemIdle(r);
+
+                otaSession.config = r->use<ConfigManager>("config");
+                otaSession.filesystem = target == "fs";
+                if (otaSession.filesystem) LittleFS.end();   // the partition is overwritten in place
+                if (!Update.begin(total, otaSession.filesystem ? U_SPIFFS : U_FLASH)) {
+                    if (otaSession.filesystem) otaRestoreConfig();
+                    throw HttpError(507, Update.errorString());
+                }
+
+                mbedtls_md_init(&otaSession.hash);
+                mbedtls_md_setup(&otaSession.hash, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+                mbedtls_md_starts(&otaSession.hash);
+                otaSession.hashing = true;
+                strncpy(otaSession.expected, sha256.c_str(), sizeof(otaSession.expected) - 1);
+                otaSession.request = request->id();
+                otaSession.written = 0;
+                otaSession.total = total;
+                if (!otaSession.idleTimer)
+                    otaSession.idleTimer = xTimerCreate("OtaIdle", pdMS_TO_TICKS(OTA_IDLE_MS), pdFALSE, r, otaIdleExpired);
+            }
+            if (otaSession.request != request->id()) throw HttpError(409, "Update was interrupted");
+
+            otaSession.lastChunkMs = millis();
+            if (otaSession.idleTimer) xTimerReset(otaSession.idleTimer, 0);
+            mbedtls_md_update(&otaSession.hash, data, len);
+            if (Update.write(const_cast<uint8_t*>(data), len) != len) {
+                String error = Update.errorString();
+                otaSession.abort();
+                otaPublish(events, "failed");
+                throw HttpError(500, error);
+            }
+            otaSession.written += len;
+            otaPublish(events, "writing");
+        },
+        [r](HttpRequest *request) -> HttpSuccess {
+            if (otaSession.request != request->id()) throw HttpError(400, "Empty image");
+            EventHub* events = r->use<EventHub>("events");
+
+            if (otaSession.idleTimer) xTimerStop(otaSession.idleTimer, 0);
+            char actual[65];
+            otaSession.finishHash(actual);
+            bool filesystem = otaSession.filesystem;
+            otaSession.request = nullptr;
+
+            if (strcmp(actual, otaSession.expected) != 0) {
+                Update.abort();
+                if (filesystem) otaRestoreConfig();
+                otaPublish(events, "failed");
+                throw HttpError(422, "SHA-256 mismatch");
+            }
+            if (!Update.end()) {
+                if (filesystem) otaRestoreConfig();
+                otaPublish(events, "failed");
+                throw HttpError(500, Update.errorString());
+            }
+            if (filesystem) otaRestoreConfig();
+            otaPublish(events, "rebooting");
+
+            // Reboot once the response had time to leave
+            JobQueue* jobs = r->use<JobQueue>("jobs");
+            try {
+                jobs->submit("system.reboot", [](JsonDocument&) {
+                    vTaskDelay(pdMS_TO_TICKS(1000));
+                    ESP.restart();
+                });
+            } catch (const HttpError&) {
+                // Queue full: the new image is still installed and runs on the next reboot
+            }
+
+            PooledJson result = JsonPool::acquire();
+            result["target"] = filesystem ? "fs" : "firmware";
+            result["size"] = otaSession.written;
+            result["sha256"] = actual;
+            return HttpSuccess(std::move(result));
+        });
+});
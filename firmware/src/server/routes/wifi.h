@@ -3,86 +3,127 @@
 #include "JWTAuth.h"
 #include "HttpError.h"
 #include "HttpSuccess.h"
+#include "JsonBody.h"
 #include "ConfigManager.h"
 #include "WiFiManager.h"
+#include <JobQueue.h>
+#include <ServerManager.h>
+#include <memory>
+
+// Longest a /wifi/list?since=... long-poll waits for a newer scan
+#ifndef WIFI_LIST_WAIT_MS
+#define WIFI_LIST_WAIT_MS 15000
+#endif
+
+// SSIDs are at most 32 bytes, WPA2 keys 64
+static const BodySchema connectBody({
+    { "ssid", BodyType::String, true, 32 },
+    { "password", BodyType::String, false, 64 },
+    { "authPassword", BodyType::String, false, 128 },
+}, 512);
 
 Router wifiRouter("/wifi", [](Router *r) {
-    r->get("/list", [r](AsyncWebServerRequest *request) -> HttpSuccess {
+    // {generation, ageMs, networks} from the cached scan table. With ?since=<generation>
+    // the answer waits (up to WIFI_LIST_WAIT_MS) for a newer scan and asks for one; on
+    // timeout the current table is sent. Requests that cannot wait (esp_http_server
+    // before IDF 5.1, in-process requests) get the current table at once. The network
+    // array is the one string WiFiManager serialized for this scan, copied straight
+    // into the response.
+    r->get("/list", [r](HttpRequest *request) -> HttpSuccess {
         WiFiManager* wifi = r->use<WiFiManager>("wifi");
-        bool isConnected = wifi->isConnected();
-        if (!isConnected) {
-            if (wifi->isScanComplete()) {
-                String jsonString;
-                DynamicJsonDocument wifiList = wifi->getScanResults();
-                serializeJson(wifiList, jsonString);
-                Serial.println(jsonString);
-                return HttpSuccess(wifiList);
+        if (wifi->isConnected()) throw HttpError(400, "Already connected to a WiFi.");
+
+        uint32_t since = request->hasParam("since") ? request->param("since").toInt() : 0;
+        if (wifi->scanGeneration() <= since) wifi->requestScan();
+
+        struct ListState {
+            WiFiManager* wifi;
+            uint32_t since;
+            uint32_t deadline;
+            WiFiScan scan;
+            char head[80];
+            size_t headLength;
+        };
+        uint32_t wait = request->canWait() ? WIFI_LIST_WAIT_MS : 0;
+        std::shared_ptr<ListState> state(new ListState{ wifi, since, millis() + wait, WiFiScan(), "", 0 });
+
+        HttpResponse response(200);
+        response.fill(HttpResponse::UNKNOWN_LENGTH, [state](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            if (index == 0) {
+                if (state->wifi->scanGeneration() <= state->since && (int32_t)(millis() - state->deadline) < 0)
+                    return HttpResponse::FILL_LATER;
+                state->scan = state->wifi->scanResults();
+                state->headLength = snprintf(state->head, sizeof(state->head),
+                    "{\"ok\":true,\"data\":{\"generation\":%u,\"ageMs\":%u,\"networks\":",
+                    (unsigned)state->scan.generation,
+                    state->scan.generation ? (unsigned)(millis() - state->scan.scannedAt) : 0u);
             }
-            else
-            {
-                throw HttpError(408, "WiFi Scan not complete, try again later.");
+
+            // head + networks + "}}", read piecewise at `index`
+            static const char tail[] = "}}";
+            const char* networks = state->scan.json ? state->scan.json->c_str() : "[]";
+            size_t networksLength = state->scan.json ? state->scan.json->length() : 2;
+            const char* parts[3] = { state->head, networks, tail };
+            size_t lengths[3] = { state->headLength, networksLength, sizeof(tail) - 1 };
+
+            size_t written = 0;
+            size_t offset = index;
+            for (uint8_t i = 0; i < 3 && written < maxLen; i++) {
+                if (offset >= lengths[i]) { offset -= lengths[i]; continue; }
+                size_t count = lengths[i] - offset < maxLen - written ? lengths[i] - offset : maxLen - written;
+                memcpy(buffer + written, parts[i] + offset, count);
+                written += count;
+                offset = 0;
             }
-        }
-        else {
-            throw HttpError(400, "Already connected to a WiFi.");
-        }
+            return written;
+        });
+        return HttpSuccess(std::move(response));
     });
+    r->fills("/list");
 
-    r->postWithBody("/connect", [r](AsyncWebServerRequest *request, const uint8_t *data) -> HttpSuccess {
-        DynamicJsonDocument body(1024);
-        DeserializationError error = deserializeJson(body, data);
-        if (error) {
-            throw HttpError(400, "Invalid JSON body");
-        }
+    r->postWithSchema("/connect", connectBody, [r](HttpRequest *request, const ParsedBody &body) -> HttpSuccess {
         WiFiManager* wifi = r->use<WiFiManager>("wifi");
         if (wifi->isConnected()) throw HttpError(400, "Already connected to a WiFi.");
-        
-        String ssid = body["ssid"];
-        String password = body["password"];
-        String authPassword = body["authPassword"];
-
-        String canConnect = wifi->tryConnect(ssid, password, 4000);
-        if (canConnect == "")
-            throw HttpError(400, "Couldn't connect to the wifi.");
-
-        // Background task to stop AP after X seconds
-        unsigned long stopDelayMs = 5000;  // for example: 5 seconds
 
-        xTaskCreate(
-            [](void* param) {
-                WiFiManager* wifi = static_cast<WiFiManager*>(param);
-                delay(5000);  // wait X seconds
-                wifi->stopAP();  // stop the access point
-                vTaskDelete(NULL);
-            },
-            "StopAPTask",   // name
-            4096,           // stack size
-            wifi,           // parameter
-            1,              // priority
-            NULL            // handle
-        );
+        String ssid = body.str("ssid");
+        String password = body.str("password");
+        String authPassword = body.str("authPassword");
+        if (ssid.isEmpty()) throw HttpError(400, "ssid is required");
 
+        // Connecting blocks for seconds; run it on the job worker, never on the network task
         ConfigManager* config = r->use<ConfigManager>("config");
-        String jwtKey = config->get("jwt")["secret"].as<String>();
-        String hashedPassword = JWTAuth::hmacSha256(authPassword, jwtKey);
+        JobQueue* jobs = r->use<JobQueue>("jobs");
+        ServerManager* server = r->use<ServerManager>("server");
+        uint32_t id = jobs->submit("wifi.connect", [wifi, config, jobs, server, ssid, password, authPassword](JsonDocument& result) {
+            String canConnect = wifi->tryConnect(ssid, password, 4000);
+            if (canConnect == "")
+                throw HttpError(400, "Couldn't connect to the wifi.");
 
-        JsonVariant wifiJson = config->get("wifi");
-        wifiJson["ssid"] = ssid;
-        wifiJson["password"] = password;
-        config->set("hashedPassword", hashedPassword);
-        config->set("wifi", wifiJson);
-        config->set("isReady", true);
+            // Handlers read the config and validate tokens with the same HMAC state
+            ServerManager::DispatchLock lock(*server);
+            String jwtKey = config->get("jwt")["secret"].as<String>();
+            String hashedPassword = JWTAuth::hmacSha256(authPassword, jwtKey);
 
-        DynamicJsonDocument payload(256);
-        payload["user"] = "admin";
-        payload["iat"] = millis() / 1000; // Issued at time
-        payload["exp"] = (millis() / 1000) + 3600; // Expiration time (1 hour)
+            JsonVariant wifiJson = config->get("wifi");
+            wifiJson["ssid"] = ssid;
+            wifiJson["password"] = password;
+            config->set("hashedPassword", hashedPassword);
+            config->set("wifi", wifiJson);
+            config->set("isReady", true);
 
-        String accessToken = JWTAuth::createToken(payload.as<JsonObject>());
+            // No token here: GET /jobs/<id> is unguarded, so anyone on the AP could read it.
+            // The wizard logs in with authPassword at the new address instead.
+            result["ip"] = canConnect;
 
-        DynamicJsonDocument result(52);
-        result["ip"] = canConnect;
-        result["accessToken"] = accessToken;
-        return HttpSuccess(result);
+            // The client reads the result through the AP; keep it up a little longer.
+            // If the queue is full the AP simply stays up.
+            try {
+                jobs->submit("wifi.stopAP", [wifi](JsonDocument&) {
+                    vTaskDelay(pdMS_TO_TICKS(5000));
+                    wifi->stopAP();
+                });
+            } catch (const HttpError&) {}
+        });
+        return JobQueue::accepted(request, id);
     });
 });
@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+#include <EventHub.h>
+#include <WiFiManager.h>
+#include <MicManager.h>
+#include <FaceManager.h>
+
+// Live device state for the dashboard and the setup wizard at /events.
+// Topics: scan, wifi, mic, recording, face, heap, plus ota while an update is flashed
+// (published by routes/system.h). Each carries a small JSON object and is only sent
+// when it changed.
+EventHub deviceEvents("/events");
+
+void attachDeviceEvents(WiFiManager* wifi, MicManager* mic, Face* face, volatile uint8_t* micLevel) {
+    static WiFiManager* wifiManager = wifi;
+    static MicManager* micManager = mic;
+    static Face* deviceFace = face;
+    static volatile uint8_t* level = micLevel;
+
+    deviceEvents.addSampler([](EventHub& hub) {
+        char json[EVENT_HUB_PAYLOAD_SIZE];
+
+        // A new generation means /wifi/list has newer results
+        WiFiScan scan = wifiManager->scanResults();
+        snprintf(json, sizeof(json), "{\"complete\":%s,\"count\":%u,\"generation\":%u}",
+                 scan.generation ? "true" : "false", (unsigned)scan.count, (unsigned)scan.generation);
+        hub.publish("scan", json);
+
+        bool connected = wifiManager->isConnected();
+        snprintf(json, sizeof(json), "{\"connected\":%s,\"ip\":\"%s\"}",
+                 connected ? "true" : "false", connected ? wifiManager->ipAddress().c_str() : "");
+        hub.publish("wifi", json);
+
+        snprintf(json, sizeof(json), "{\"spectrum\":%s,\"level\":%u}",
+                 micManager->isSpectrumActive() ? "true" : "false",
+                 micManager->isSpectrumActive() ? (unsigned)*level : 0u);
+        hub.publish("mic", json);
+
+        snprintf(json, sizeof(json), "{\"active\":%s,\"ms\":%u,\"bytes\":%u}",
+                 micManager->isRecording() ? "true" : "false",
+                 (unsigned)micManager->getRecordedDuration(), (unsigned)micManager->getRecordedBytes());
+        hub.publish("recording", json);
+
+        snprintf(json, sizeof(json), "{\"emotion\":%d}", (int)deviceFace->Behavior.CurrentEmotion);
+        hub.publish("face", json);
+
+        // Kilobytes, so allocation noise does not turn into an event per interval
+        snprintf(json, sizeof(json), "{\"freeKb\":%u,\"largestKb\":%u}",
+                 (unsigned)(ESP.getFreeHeap() / 1024), (unsigned)(ESP.getMaxAllocHeap() / 1024));
+        hub.publish("heap", json);
+    });
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <MicManager.h>
+
+// Streams spectrum frames to the dashboard as 16-byte binary messages (one byte per band)
+AsyncWebSocket spectrumSocket("/ws/spectrum");
+
+// Latest frame, handed from the spectrum task to pumpSpectrumSocket(). One slot:
+// a frame that was not sent yet is replaced, the audio side never waits on the network.
+static QueueHandle_t spectrumFrames = nullptr;
+
+// Spectrum runs only while at least one dashboard client is connected (unless started from the terminal)
+void attachSpectrumSocket(MicManager* mic) {
+    static MicManager* micManager = mic;
+    static bool startedBySocket = false;
+
+    spectrumFrames = xQueueCreate(1, SpectrumFrame::BAND_COUNT);
+
+    // Runs on the AsyncTCP task; start and stop only signal the spectrum task
+    spectrumSocket.onEvent([](AsyncWebSocket* server, AsyncWebSocketClient* client,
+                              AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        if (type == WS_EVT_CONNECT && !micManager->isSpectrumActive()) {
+            startedBySocket = micManager->startSpectrum();
+        } else if (type == WS_EVT_DISCONNECT && server->count() == 0 && startedBySocket) {
+            micManager->stopSpectrum();
+            startedBySocket = false;
+        }
+    });
+
+    micManager->addSpectrumListener([](const SpectrumFrame& frame) {
+        if (spectrumFrames && spectrumSocket.count() > 0) xQueueOverwrite(spectrumFrames, frame.bands);
+    });
+}
+
+// Called from loop(): sends the latest frame (~20 frames/s) and drops closed clients.
+// The library has no client lock, so the socket is driven from one task only, as its
+// examples do, never from the spectrum task.
+void pumpSpectrumSocket() {
+    static uint32_t lastSend = 0;
+    spectrumSocket.cleanupClients();
+    if (!spectrumFrames || millis() - lastSend < 50) return;
+
+    uint8_t bands[SpectrumFrame::BAND_COUNT];
+    if (xQueueReceive(spectrumFrames, bands, 0) != pdTRUE) return;
+    if (spectrumSocket.count() == 0 || !spectrumSocket.availableForWriteAll()) return;   // drop instead of queueing
+    lastSend = millis();
+    spectrumSocket.binaryAll(bands, sizeof(bands));
+}
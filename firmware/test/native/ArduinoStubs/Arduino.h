@@ -0,0 +1,236 @@
+#pragma once
+// Host stand-in for the parts of the Arduino-ESP32 core the firmware libraries use,
+// for the [env:native] tests. Behaviour follows the core where tests depend on it.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <strings.h>
+#include <thread>
+
+#define HEX 16
+#define DEC 10
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+using std::max;
+using std::min;
+
+template<typename T, typename L, typename H>
+T constrain(T value, L low, H high) { return value < low ? low : (value > high ? high : value); }
+
+inline uint32_t micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+inline uint32_t millis() { return micros() / 1000; }
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void yield() { std::this_thread::yield(); }
+inline uint32_t esp_random() { return ((uint32_t)rand() << 16) ^ (uint32_t)rand(); }
+
+// The core's String lives on malloc/realloc, not operator new; kept that way so
+// ServerManager's allocation count means the same thing on the host
+template<typename T>
+struct MallocAllocator {
+    typedef T value_type;
+    MallocAllocator() {}
+    template<typename U> MallocAllocator(const MallocAllocator<U>&) {}
+    T* allocate(size_t n) {
+        T* p = static_cast<T*>(malloc(n * sizeof(T)));
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+    void deallocate(T* p, size_t) { free(p); }
+    template<typename U> bool operator==(const MallocAllocator<U>&) const { return true; }
+    template<typename U> bool operator!=(const MallocAllocator<U>&) const { return false; }
+};
+
+typedef std::basic_string<char, std::char_traits<char>, MallocAllocator<char>> StringBase;
+
+class String : public StringBase {
+public:
+    String() {}
+    String(const char* text) : StringBase(text ? text : "") {}
+    String(const StringBase& text) : StringBase(text) {}
+    String(const std::string& text) : StringBase(text.data(), text.size()) {}
+    String(char c) : StringBase(1, c) {}
+    String(int value, unsigned char base = DEC) : StringBase(format(base == HEX ? "%x" : "%d", value)) {}
+    String(unsigned value, unsigned char base = DEC) : StringBase(format(base == HEX ? "%x" : "%u", value)) {}
+    String(long value, unsigned char base = DEC) : StringBase(format(base == HEX ? "%lx" : "%ld", value)) {}
+    String(unsigned long value, unsigned char base = DEC) : StringBase(format(base == HEX ? "%lx" : "%lu", value)) {}
+    String(long long value) : StringBase(format("%lld", value)) {}
+    String(unsigned long long value) : StringBase(format("%llu", value)) {}
+    String(unsigned char value, unsigned char base = DEC) : StringBase(format(base == HEX ? "%x" : "%u", value)) {}
+    String(float value, unsigned int decimals = 2) : StringBase(format("%.*f", decimals, (double)value)) {}
+    String(double value, unsigned int decimals = 2) : StringBase(format("%.*f", decimals, value)) {}
+
+    String& operator=(const char* text) {
+        assign(text ? text : "");
+        return *this;
+    }
+
+    unsigned int length() const { return (unsigned int)size(); }
+    bool isEmpty() const { return empty(); }
+    bool reserve(unsigned int capacity) {
+        StringBase::reserve(capacity);
+        return true;
+    }
+    bool concat(const char* text) {
+        if (text) append(text);
+        return true;
+    }
+    bool concat(const char* text, unsigned int length) {
+        append(text, length);
+        return true;
+    }
+    bool concat(const String& text) {
+        append(text);
+        return true;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return position(find(text, from)); }
+    int lastIndexOf(char c) const { return position(rfind(c)); }
+    int lastIndexOf(const String& text) const { return position(rfind(text)); }
+    String substring(unsigned int from) const { return from >= size() ? String() : String(substr(from)); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (to > size()) to = size();
+        if (from >= to) return String();
+        return String(substr(from, to - from));
+    }
+    bool startsWith(const String& prefix) const { return compare(0, prefix.size(), prefix) == 0; }
+    bool endsWith(const String& suffix) const {
+        return size() >= suffix.size() && compare(size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+    bool equals(const String& other) const { return *this == other; }
+    bool equalsIgnoreCase(const String& other) const { return strcasecmp(c_str(), other.c_str()) == 0; }
+    char charAt(unsigned int index) const { return index < size() ? (*this)[index] : '\0'; }
+    void setCharAt(unsigned int index, char c) {
+        if (index < size()) (*this)[index] = c;
+    }
+    void replace(const String& from, const String& to) {
+        if (from.empty()) return;
+        for (size_t at = find(from); at != npos; at = find(from, at + to.size())) StringBase::replace(at, from.size(), to);
+    }
+    void trim() {
+        size_t first = find_first_not_of(" \t\r\n");
+        size_t last = find_last_not_of(" \t\r\n");
+        *this = first == npos ? String() : String(substr(first, last - first + 1));
+    }
+    void toLowerCase() { for (char& c : *this) c = (char)tolower((unsigned char)c); }
+    void toUpperCase() { for (char& c : *this) c = (char)toupper((unsigned char)c); }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+
+private:
+    static int position(size_t at) { return at == npos ? -1 : (int)at; }
+    static StringBase format(const char* pattern, ...) {
+        char buffer[48];
+        va_list args;
+        va_start(args, pattern);
+        vsnprintf(buffer, sizeof(buffer), pattern, args);
+        va_end(args);
+        return buffer;
+    }
+};
+
+// What `a + b` yields in the core; only here so code naming it compiles
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& text) : String(text) {}
+};
+
+inline StringSumHelper operator+(const String& a, const String& b) { return String(static_cast<const StringBase&>(a) + b); }
+inline StringSumHelper operator+(const String& a, const char* b) { return String(static_cast<const StringBase&>(a) + (b ? b : "")); }
+inline StringSumHelper operator+(const char* a, const String& b) { return String((a ? a : "") + static_cast<const StringBase&>(b)); }
+inline StringSumHelper operator+(const String& a, char b) { return String(static_cast<const StringBase&>(a) + b); }
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t written = 0;
+        for (size_t i = 0; i < size; i++) written += write(buffer[i]);
+        return written;
+    }
+    size_t write(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(reinterpret_cast<const uint8_t*>(text.c_str()), text.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    size_t println() { return write("\r\n"); }
+    template<typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+
+    size_t printf(const char* pattern, ...) {
+        char buffer[256];
+        va_list args;
+        va_start(args, pattern);
+        int length = vsnprintf(buffer, sizeof(buffer), pattern, args);
+        va_end(args);
+        if (length < 0) return 0;
+        return write(reinterpret_cast<const uint8_t*>(buffer), std::min((size_t)length, sizeof(buffer) - 1));
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() { return -1; }
+    virtual void flush() {}
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        for (int c; count < length && (c = read()) >= 0; count++) buffer[count] = (char)c;
+        return count;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+    String readStringUntil(char terminator) {
+        String text;
+        for (int c; (c = read()) >= 0 && c != terminator; ) text += (char)c;
+        return text;
+    }
+    String readString() { return readStringUntil('\0'); }
+};
+
+// Serial writes to stdout, with nothing to read
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int availableForWrite() { return 256; }
+    using Print::write;
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMinFreeHeap() { return 150000; }
+    uint32_t getMaxAllocHeap() { return 110000; }
+    uint32_t getHeapSize() { return 320000; }
+    void restart() {}
+};
+extern EspClass ESP;
+
+#include "freertos/FreeRTOS.h"
@@ -0,0 +1,6 @@
+#include <Arduino.h>
+#include <WiFi.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
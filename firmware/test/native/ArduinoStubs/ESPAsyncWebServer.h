@@ -0,0 +1,196 @@
+#pragma once
+// Declarations of the ESPAsyncWebServer API the AsyncBackend uses, so the library
+// compiles on the host. Nothing listens: native tests dispatch with
+// ServerManager::handle() and never call begin().
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+
+typedef enum {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_PATCH = 0b00010000,
+    HTTP_HEAD = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+
+class AsyncWebServerRequest;
+class AsyncClient {
+public:
+    void close(bool = false) {}
+    bool canSend() { return true; }
+    size_t space() { return 1436; }
+};
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+class AsyncWebParameter {
+public:
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+    bool isPost() const { return false; }
+    bool isFile() const { return false; }
+    size_t size() const { return 0; }
+
+private:
+    String _name;
+    String _value;
+};
+
+class AsyncWebServerResponse {
+public:
+    virtual ~AsyncWebServerResponse() {}
+    void addHeader(const String&, const String&) {}
+    void setCode(int) {}
+    void setContentLength(size_t) {}
+    void setContentType(const String&) {}
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+    AsyncResponseStream(const String&, size_t) {}
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+    using Print::write;
+};
+
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+typedef std::function<String(const String&)> AwsTemplateProcessor;
+
+class AsyncWebServerRequest {
+public:
+    void* _tempObject = nullptr;
+
+    AsyncClient* client() { return &_client; }
+    const String& url() const { return _url; }
+    WebRequestMethodComposite method() const { return HTTP_GET; }
+    const char* methodToString() const { return "GET"; }
+    size_t contentLength() const { return 0; }
+    const String& contentType() const { return _empty; }
+
+    size_t headers() const { return 0; }
+    bool hasHeader(const String&) const { return false; }
+    AsyncWebHeader* getHeader(const String&) const { return nullptr; }
+    AsyncWebHeader* getHeader(size_t) const { return nullptr; }
+    void addInterestingHeader(const String&) {}
+
+    size_t params() const { return 0; }
+    bool hasParam(const String&, bool = false, bool = false) const { return false; }
+    AsyncWebParameter* getParam(const String&, bool = false, bool = false) const { return nullptr; }
+    AsyncWebParameter* getParam(size_t) const { return nullptr; }
+    bool hasArg(const char*) const { return false; }
+    const String& arg(const String&) const { return _empty; }
+
+    void onDisconnect(std::function<void()>) {}
+    void redirect(const String&) {}
+
+    void send(AsyncWebServerResponse* response) { delete response; }
+    void send(int, const String& = String(), const String& = String()) {}
+    AsyncWebServerResponse* beginResponse(int, const String& = String(), const String& = String()) {
+        return new AsyncWebServerResponse();
+    }
+    AsyncWebServerResponse* beginResponse(const String&, size_t, AwsResponseFiller, AwsTemplateProcessor = nullptr) {
+        return new AsyncWebServerResponse();
+    }
+    AsyncWebServerResponse* beginChunkedResponse(const String&, AwsResponseFiller, AwsTemplateProcessor = nullptr) {
+        return new AsyncWebServerResponse();
+    }
+    AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460) {
+        return new AsyncResponseStream(contentType, bufferSize);
+    }
+
+private:
+    AsyncClient _client;
+    String _url;
+    String _empty;
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+    virtual bool canHandle(AsyncWebServerRequest*) { return false; }
+    virtual void handleRequest(AsyncWebServerRequest*) {}
+    virtual void handleUpload(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool) {}
+    virtual void handleBody(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t) {}
+    virtual bool isRequestHandlerTrivial() { return true; }
+};
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+
+class AsyncWebSocketClient {
+public:
+    uint32_t id() const { return 0; }
+    void text(const String&) {}
+    void binary(const uint8_t*, size_t) {}
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+    typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType, void*, uint8_t*, size_t)> AwsEventHandler;
+
+    explicit AsyncWebSocket(const String& url) : _url(url) {}
+    const char* url() const { return _url.c_str(); }
+    void onEvent(AwsEventHandler) {}
+    size_t count() const { return 0; }
+    bool availableForWriteAll() { return true; }
+    void textAll(const String&) {}
+    void binaryAll(const uint8_t*, size_t) {}
+    void cleanupClients() {}
+
+private:
+    String _url;
+};
+
+class AsyncEventSourceClient {
+public:
+    void send(const char*, const char* = nullptr, uint32_t = 0, uint32_t = 0) {}
+    uint32_t lastId() const { return 0; }
+    size_t packetsWaiting() const { return 0; }
+    bool connected() const { return false; }
+};
+
+class AsyncEventSource : public AsyncWebHandler {
+public:
+    explicit AsyncEventSource(const String&) {}
+    void onConnect(std::function<void(AsyncEventSourceClient*)>) {}
+    void send(const char*, const char* = nullptr, uint32_t = 0, uint32_t = 0) {}
+    size_t count() const { return 0; }
+    size_t avgPacketsWaiting() const { return 0; }
+};
+
+class AsyncStaticWebHandler : public AsyncWebHandler {
+public:
+    AsyncStaticWebHandler& setDefaultFile(const char*) { return *this; }
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t) {}
+    void begin() {}
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler) { return *handler; }
+    void onNotFound(ArRequestHandlerFunction) {}
+    void onRequestBody(ArBodyHandlerFunction) {}
+    AsyncStaticWebHandler& serveStatic(const char*, fs::FS&, const char*) { return _static; }
+
+private:
+    AsyncStaticWebHandler _static;
+};
@@ -0,0 +1,218 @@
+#include "FS.h"
+#include "LittleFS.h"
+#include <cerrno>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+namespace fs {
+
+struct File::Handle {
+    FS* fs = nullptr;
+    String path;
+    FILE* file = nullptr;
+    bool directory = false;
+    std::vector<String> entries;    // directory: full paths of the children
+    size_t next = 0;
+
+    ~Handle() {
+        if (file) fclose(file);
+    }
+};
+
+File::operator bool() const { return _handle && (_handle->file || _handle->directory); }
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!_handle || !_handle->file) return 0;
+    // Overwrites inside the file take no new space
+    size_t at = position();
+    size_t current = this->size();
+    size_t growth = at + size > current ? at + size - current : 0;
+    size_t free = _handle->fs->freeBytes();
+    if (growth > free) size -= growth - free;
+    size_t written = fwrite(buffer, 1, size, _handle->file);
+    fflush(_handle->file);
+    return written;
+}
+
+int File::available() {
+    if (!_handle || !_handle->file) return 0;
+    size_t total = size();
+    size_t at = position();
+    return at < total ? (int)(total - at) : 0;
+}
+
+int File::read() {
+    if (!_handle || !_handle->file) return -1;
+    int c = fgetc(_handle->file);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    int c = read();
+    if (c >= 0) ungetc(c, _handle->file);
+    return c;
+}
+
+void File::flush() {
+    if (_handle && _handle->file) fflush(_handle->file);
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!_handle || !_handle->file) return 0;
+    return fread(buffer, 1, size, _handle->file);
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+    if (!_handle || !_handle->file) return false;
+    static const int whence[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    return fseek(_handle->file, (long)position, whence[mode]) == 0;
+}
+
+size_t File::position() const {
+    if (!_handle || !_handle->file) return 0;
+    long at = ftell(_handle->file);
+    return at < 0 ? 0 : (size_t)at;
+}
+
+size_t File::size() const {
+    if (!_handle || !_handle->file) return 0;
+    fflush(_handle->file);
+    struct stat info;
+    return fstat(fileno(_handle->file), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void File::close() {
+    _handle.reset();
+}
+
+time_t File::getLastWrite() {
+    struct stat info;
+    if (!_handle || stat(_handle->fs->hostPath(_handle->path).c_str(), &info) != 0) return 0;
+    return info.st_mtime;
+}
+
+const char* File::path() const { return _handle ? _handle->path.c_str() : ""; }
+
+const char* File::name() const {
+    if (!_handle) return "";
+    const char* slash = strrchr(_handle->path.c_str(), '/');
+    return slash ? slash + 1 : _handle->path.c_str();
+}
+
+bool File::isDirectory() const { return _handle && _handle->directory; }
+
+File File::openNextFile(const char* mode) {
+    if (!_handle || !_handle->directory || _handle->next >= _handle->entries.size()) return File();
+    return _handle->fs->open(_handle->entries[_handle->next++], mode);
+}
+
+void File::rewindDirectory() {
+    if (_handle) _handle->next = 0;
+}
+
+String FS::hostPath(const String& path) const {
+    return _root + (path.startsWith("/") ? path : "/" + path);
+}
+
+File FS::open(const String& path, const char* mode, bool) {
+    String host = hostPath(path);
+    std::shared_ptr<File::Handle> handle(new File::Handle());
+    handle->fs = this;
+    handle->path = path;
+
+    struct stat info;
+    if (stat(host.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        if (mode[0] != 'r') return File();
+        handle->directory = true;
+        DIR* dir = opendir(host.c_str());
+        if (!dir) return File();
+        String prefix = path.endsWith("/") ? path : path + "/";
+        for (struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) continue;
+            handle->entries.push_back(prefix + entry->d_name);
+        }
+        closedir(dir);
+        return File(handle);
+    }
+
+    // "w" may seek back and rewrite, as on the device
+    const char* hostMode = mode[0] == 'w' ? "w+b" : (mode[0] == 'a' ? "a+b" : (mode[1] == '+' ? "r+b" : "rb"));
+    handle->file = fopen(host.c_str(), hostMode);
+    if (!handle->file) return File();
+    return File(handle);
+}
+
+bool FS::exists(const String& path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const String& path) { return unlink(hostPath(path).c_str()) == 0; }
+
+bool FS::rename(const String& from, const String& to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const String& path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const String& path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+}   // namespace fs
+
+// Sum of file sizes below host, or deletes them (and the directories) with remove
+static size_t walk(const String& host, bool remove) {
+    size_t total = 0;
+    DIR* dir = opendir(host.c_str());
+    if (!dir) return 0;
+    for (struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) continue;
+        String child = host + "/" + entry->d_name;
+        struct stat info;
+        if (stat(child.c_str(), &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            total += walk(child, remove);
+            if (remove) rmdir(child.c_str());
+        } else {
+            total += info.st_size;
+            if (remove) unlink(child.c_str());
+        }
+    }
+    closedir(dir);
+    return total;
+}
+
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) {
+    // mkdir -p of the root
+    for (size_t at = 1; at <= _root.length(); at++) {
+        if (at == _root.length() || _root[at] == '/') ::mkdir(_root.substring(0, at).c_str(), 0755);
+    }
+    struct stat info;
+    return stat(_root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool LittleFSFS::format() {
+    walk(_root, true);
+    return begin();
+}
+
+size_t LittleFSFS::usedBytes() { return walk(_root, false); }
+
+size_t LittleFSFS::freeBytes() {
+    size_t used = usedBytes();
+    return used < _totalBytes ? _totalBytes - used : 0;
+}
+
+bool LittleFSFS::info(FSInfo& info) {
+    info.totalBytes = totalBytes();
+    info.usedBytes = usedBytes();
+    info.blockSize = 4096;
+    info.pageSize = 256;
+    info.maxOpenFiles = 10;
+    info.maxPathLength = 32;
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+// fs::FS and fs::File over a host directory, so code using LittleFS reads and
+// writes real files in tests. Paths are absolute within the mounted root.
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+    struct Handle;
+
+    File() {}
+    explicit File(std::shared_ptr<Handle> handle) : _handle(handle) {}
+
+    explicit operator bool() const;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t* buffer, size_t size);
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    time_t getLastWrite();
+    const char* path() const;
+    const char* name() const;        // base name, as in arduino-esp32 2.x
+    bool isDirectory() const;
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+
+private:
+    std::shared_ptr<Handle> _handle;
+};
+
+class FS {
+public:
+    explicit FS(const String& root) : _root(root) {}
+    virtual ~FS() {}
+
+    File open(const String& path, const char* mode = FILE_READ, bool create = false);
+    bool exists(const String& path);
+    bool remove(const String& path);
+    bool rename(const String& from, const String& to);
+    bool mkdir(const String& path);
+    bool rmdir(const String& path);
+
+    // Host directory backing path
+    String hostPath(const String& path) const;
+    // Writes past this come back short, as on a full partition
+    virtual size_t freeBytes() { return SIZE_MAX; }
+
+protected:
+    String _root;
+};
+
+}   // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
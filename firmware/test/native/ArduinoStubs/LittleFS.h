@@ -0,0 +1,42 @@
+#pragma once
+#include "FS.h"
+
+// Where the native LittleFS keeps its files, relative to the working directory
+#ifndef NATIVE_LITTLEFS_ROOT
+#define NATIVE_LITTLEFS_ROOT ".pio/native-littlefs"
+#endif
+// Reported partition size
+#ifndef NATIVE_LITTLEFS_SIZE
+#define NATIVE_LITTLEFS_SIZE (1408 * 1024)
+#endif
+
+struct FSInfo {
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+class LittleFSFS : public fs::FS {
+public:
+    LittleFSFS() : fs::FS(NATIVE_LITTLEFS_ROOT) {}
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();                  // deletes every file under the root
+    size_t totalBytes() { return _totalBytes; }
+    size_t usedBytes();
+    bool info(FSInfo& info);
+    size_t freeBytes() override;
+
+    // Script: shrink the partition to fill it up
+    void setTotalBytes(size_t size) { _totalBytes = size; }
+
+private:
+    size_t _totalBytes = NATIVE_LITTLEFS_SIZE;
+};
+
+extern LittleFSFS LittleFS;
@@ -0,0 +1,92 @@
+#pragma once
+// A scriptable Wi-Fi driver: tests set the networks a scan finds and whether
+// begin() connects. Scans finish at once.
+#include <Arduino.h>
+#include <vector>
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_AUTH_OPEN = 0, WIFI_AUTH_WPA2_PSK = 3 } wifi_auth_mode_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _bytes{ a, b, c, d } {}
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+        return text;
+    }
+    operator String() const { return toString(); }
+
+private:
+    uint8_t _bytes[4];
+};
+
+class WiFiClass {
+public:
+    struct Network {
+        String ssid;
+        int32_t rssi;
+        wifi_auth_mode_t auth;
+    };
+
+    // Script
+    std::vector<Network> networks;       // what the next scan finds
+    bool joinable = true;                // begin() connects
+    int scansStarted = 0;
+
+    wifi_mode_t getMode() { return _mode; }
+    bool mode(wifi_mode_t mode) {
+        _mode = mode;
+        return true;
+    }
+
+    void begin(const char* ssid, const char* = nullptr) {
+        _ssid = ssid;
+        _status = joinable ? WL_CONNECTED : WL_CONNECT_FAILED;
+    }
+    bool disconnect(bool = false, bool = false) {
+        _status = WL_DISCONNECTED;
+        return true;
+    }
+    wl_status_t status() { return _status; }
+    bool isConnected() { return _status == WL_CONNECTED; }
+    IPAddress localIP() { return isConnected() ? IPAddress(192, 168, 1, 50) : IPAddress(); }
+
+    bool softAP(const char*, const char* = nullptr) {
+        _mode = _mode == WIFI_STA ? WIFI_AP_STA : WIFI_AP;
+        return true;
+    }
+    bool softAPdisconnect(bool = false) {
+        _mode = _mode == WIFI_AP_STA ? WIFI_STA : WIFI_OFF;
+        return true;
+    }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    String macAddress() { return "24:0A:C4:00:00:01"; }
+
+    int16_t scanNetworks(bool async = false, bool = false) {
+        scansStarted++;
+        _scanned = networks;
+        _scanDone = true;
+        return async ? WIFI_SCAN_RUNNING : (int16_t)_scanned.size();
+    }
+    int16_t scanComplete() { return _scanDone ? (int16_t)_scanned.size() : WIFI_SCAN_FAILED; }
+    void scanDelete() {
+        _scanned.clear();
+        _scanDone = false;
+    }
+    String SSID(uint8_t i = 0) { return i < _scanned.size() ? _scanned[i].ssid : (i == 0 ? _ssid : String()); }
+    int32_t RSSI(uint8_t i = 0) { return i < _scanned.size() ? _scanned[i].rssi : 0; }
+    wifi_auth_mode_t encryptionType(uint8_t i) { return i < _scanned.size() ? _scanned[i].auth : WIFI_AUTH_OPEN; }
+
+private:
+    wifi_mode_t _mode = WIFI_OFF;
+    wl_status_t _status = WL_IDLE_STATUS;
+    String _ssid;
+    std::vector<Network> _scanned;
+    bool _scanDone = false;
+};
+
+extern WiFiClass WiFi;
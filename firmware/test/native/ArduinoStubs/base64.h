@@ -0,0 +1,25 @@
+#pragma once
+// Standard alphabet with padding, as the core's base64 class
+#include <Arduino.h>
+
+class base64 {
+public:
+    static String encode(const uint8_t* data, size_t length) {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        String out;
+        out.reserve((length + 2) / 3 * 4);
+        for (size_t i = 0; i < length; i += 3) {
+            uint32_t bits = (uint32_t)data[i] << 16;
+            if (i + 1 < length) bits |= (uint32_t)data[i + 1] << 8;
+            if (i + 2 < length) bits |= data[i + 2];
+            out += alphabet[(bits >> 18) & 0x3F];
+            out += alphabet[(bits >> 12) & 0x3F];
+            out += i + 1 < length ? alphabet[(bits >> 6) & 0x3F] : '=';
+            out += i + 2 < length ? alphabet[bits & 0x3F] : '=';
+        }
+        return out;
+    }
+    static String encode(const String& text) {
+        return encode(reinterpret_cast<const uint8_t*>(text.c_str()), text.length());
+    }
+};
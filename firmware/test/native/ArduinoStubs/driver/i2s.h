@@ -0,0 +1,58 @@
+#pragma once
+// An I2S port that reads silence at the configured sample rate, so the capture
+// task runs on the host without a microphone
+#include <Arduino.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1 = 1, I2S_NUM_MAX } i2s_port_t;
+typedef enum { I2S_MODE_MASTER = 1, I2S_MODE_SLAVE = 2, I2S_MODE_TX = 4, I2S_MODE_RX = 8 } i2s_mode_t;
+typedef enum { I2S_BITS_PER_SAMPLE_16BIT = 16, I2S_BITS_PER_SAMPLE_32BIT = 32 } i2s_bits_per_sample_t;
+typedef enum { I2S_CHANNEL_FMT_RIGHT_LEFT, I2S_CHANNEL_FMT_ONLY_RIGHT, I2S_CHANNEL_FMT_ONLY_LEFT } i2s_channel_fmt_t;
+typedef enum { I2S_COMM_FORMAT_STAND_I2S = 1, I2S_COMM_FORMAT_I2S = 1 } i2s_comm_format_t;
+#define I2S_PIN_NO_CHANGE (-1)
+
+typedef struct {
+    i2s_mode_t mode;
+    uint32_t sample_rate;
+    i2s_bits_per_sample_t bits_per_sample;
+    i2s_channel_fmt_t channel_format;
+    i2s_comm_format_t communication_format;
+    int intr_alloc_flags;
+    int dma_buf_count;
+    int dma_buf_len;
+    bool use_apll;
+} i2s_config_t;
+
+typedef struct {
+    int bck_io_num;
+    int ws_io_num;
+    int data_out_num;
+    int data_in_num;
+} i2s_pin_config_t;
+
+inline uint32_t& nativeI2SSampleRate(i2s_port_t port) {
+    static uint32_t rates[I2S_NUM_MAX] = {};
+    return rates[port];
+}
+
+inline esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* config, int, void*) {
+    nativeI2SSampleRate(port) = config->sample_rate;
+    return ESP_OK;
+}
+inline esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+    nativeI2SSampleRate(port) = 0;
+    return ESP_OK;
+}
+inline esp_err_t i2s_set_pin(i2s_port_t, const i2s_pin_config_t*) { return ESP_OK; }
+
+inline esp_err_t i2s_read(i2s_port_t port, void* buffer, size_t size, size_t* bytesRead, TickType_t) {
+    uint32_t rate = nativeI2SSampleRate(port);
+    if (!rate) return ESP_FAIL;
+    memset(buffer, 0, size);
+    *bytesRead = size;
+    delay((uint32_t)(size / sizeof(int32_t) * 1000 / rate));
+    return ESP_OK;
+}
@@ -0,0 +1,186 @@
+#pragma once
+// FreeRTOS on std::thread: one tick is one millisecond, tasks are detached threads,
+// queues and semaphores are mutex-protected buffers. Priorities and cores are ignored.
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+
+struct NativeQueue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t itemSize;
+
+    // Waits for pred with the lock held; false on timeout
+    template<typename Pred>
+    bool wait(std::unique_lock<std::mutex>& lock, TickType_t ticks, Pred pred) {
+        if (ticks == portMAX_DELAY) {
+            changed.wait(lock, pred);
+            return true;
+        }
+        return changed.wait_for(lock, std::chrono::milliseconds(ticks), pred);
+    }
+};
+typedef NativeQueue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    NativeQueue* queue = new NativeQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+inline void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->wait(lock, ticks, [queue] { return queue->items.size() < queue->length; })) return pdFALSE;
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+inline BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    return xQueueSend(queue, item, ticks);
+}
+inline BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.clear();
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->wait(lock, ticks, [queue] { return !queue->items.empty(); })) return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+inline BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->wait(lock, ticks, [queue] { return !queue->items.empty(); })) return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    return pdTRUE;
+}
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)(queue->length - queue->items.size());
+}
+inline BaseType_t xQueueReset(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+// Semaphores: a counting queue of empty items; recursive mutexes track their owner
+struct NativeSemaphore {
+    NativeQueue count;
+    std::recursive_timed_mutex recursive;
+};
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+    NativeSemaphore* semaphore = new NativeSemaphore();
+    semaphore->count.length = 1;
+    semaphore->count.itemSize = 0;
+    return semaphore;
+}
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    NativeSemaphore* semaphore = new NativeSemaphore();
+    semaphore->count.length = max;
+    semaphore->count.itemSize = 0;
+    for (UBaseType_t i = 0; i < initial; i++) semaphore->count.items.emplace_back();
+    return semaphore;
+}
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return xSemaphoreCreateCounting(1, 1); }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new NativeSemaphore(); }
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    uint8_t unused;
+    return xQueueReceive(&semaphore->count, &unused, ticks);
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return xQueueSend(&semaphore->count, nullptr, 0);
+}
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        semaphore->recursive.lock();
+        return pdTRUE;
+    }
+    return semaphore->recursive.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+    semaphore->recursive.unlock();
+    return pdTRUE;
+}
+
+// Tasks
+typedef void* TaskHandle_t;
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    static thread_local char self;
+    return &self;
+}
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char*, uint32_t, void* param,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = reinterpret_cast<TaskHandle_t>(1);
+    std::thread(task, param).detach();
+    return pdPASS;
+}
+inline BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stack, void* param,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(task, name, stack, param, priority, handle, 0);
+}
+// Only a task deleting itself is supported: the thread parks for good
+inline void vTaskDelete(TaskHandle_t) {
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+}
+inline TickType_t xTaskGetTickCount() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+inline void vTaskDelayUntil(TickType_t* last, TickType_t increment) {
+    *last += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*last - now) > 0) vTaskDelay(*last - now);
+}
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 4096; }
+
+// Critical sections: one process-wide lock stands in for every portMUX
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+inline std::recursive_mutex& nativeCriticalSection() {
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+#define portENTER_CRITICAL(mux) nativeCriticalSection().lock()
+#define portEXIT_CRITICAL(mux) nativeCriticalSection().unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
@@ -0,0 +1,37 @@
+#pragma once
+// SHA-256 and HMAC-SHA256 behind the mbedTLS message-digest API, the only digest
+// the firmware asks for
+#include <cstddef>
+#include <cstdint>
+
+typedef enum { MBEDTLS_MD_NONE = 0, MBEDTLS_MD_SHA256 = 6 } mbedtls_md_type_t;
+
+typedef struct mbedtls_md_info_t {
+    mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    size_t used;
+} mbedtls_sha256_state;
+
+typedef struct mbedtls_md_context_t {
+    const mbedtls_md_info_t* info;
+    mbedtls_sha256_state sha;
+    uint8_t innerPad[64];           // key ^ 0x36, once hmac_starts ran
+    uint8_t outerPad[64];           // key ^ 0x5c
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type);
+void mbedtls_md_init(mbedtls_md_context_t* ctx);
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* info, int hmac);
+void mbedtls_md_free(mbedtls_md_context_t* ctx);
+int mbedtls_md_starts(mbedtls_md_context_t* ctx);
+int mbedtls_md_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t length);
+int mbedtls_md_finish(mbedtls_md_context_t* ctx, unsigned char* output);
+int mbedtls_md_hmac_starts(mbedtls_md_context_t* ctx, const unsigned char* key, size_t keyLength);
+int mbedtls_md_hmac_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t length);
+int mbedtls_md_hmac_finish(mbedtls_md_context_t* ctx, unsigned char* output);
+int mbedtls_md_hmac_reset(mbedtls_md_context_t* ctx);
@@ -0,0 +1,64 @@
+// Static file fallback on the host: pio test -e native
+// No asset manifest, so StaticAssetHandler::serveFile() answers from /web like the
+// IdfBackend does. URLs are given as the backend hands them over, percent-decoded.
+#include <unity.h>
+#include <LittleFS.h>
+#include <StaticAssetHandler.h>
+#include <SyntheticRequest.h>
+
+static StaticAssetHandler assets;
+
+static void writeFile(const char* path, const char* text) {
+    File file = LittleFS.open(path, "w");
+    file.print(text);
+    file.close();
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_files_under_the_root_are_served() {
+    SyntheticRequest index(HttpMethod::Get, "/");
+    TEST_ASSERT_TRUE(assets.serveFile(index));
+    TEST_ASSERT_EQUAL(200, index.status());
+    TEST_ASSERT_EQUAL_STRING("text/html", index.contentType());
+    TEST_ASSERT_EQUAL_STRING("<h1>Jarvis</h1>", index.body().c_str());
+
+    SyntheticRequest script(HttpMethod::Get, "/js/app.js");
+    TEST_ASSERT_TRUE(assets.serveFile(script));
+    TEST_ASSERT_EQUAL_STRING("application/javascript", script.contentType());
+
+    SyntheticRequest missing(HttpMethod::Get, "/nope.js");
+    TEST_ASSERT_FALSE(assets.serveFile(missing));
+}
+
+void test_dot_segments_do_not_leave_the_root() {
+    const char* urls[] = {
+        "/../config.json",              // GET /%2e%2e/config.json, decoded
+        "/js/../../config.json",
+        "/./../config.json",
+        "/..",
+        "/js/.",
+        "../config.json",
+    };
+    for (const char* url : urls) {
+        SyntheticRequest request(HttpMethod::Get, url);
+        TEST_ASSERT_FALSE(assets.serveFile(request));
+        TEST_ASSERT_FALSE(request.answered());
+    }
+}
+
+int main(int argc, char** argv) {
+    LittleFS.format();
+    LittleFS.mkdir("/web");
+    LittleFS.mkdir("/web/js");
+    writeFile("/config.json", "{\"jwt\":{\"secret\":\"do-not-serve\"}}");
+    writeFile("/web/index.html", "<h1>Jarvis</h1>");
+    writeFile("/web/js/app.js", "console.log(1);");
+    assets.load(LittleFS, "/web/");     // no manifest: plain files only
+
+    UNITY_BEGIN();
+    RUN_TEST(test_files_under_the_root_are_served);
+    RUN_TEST(test_dot_segments_do_not_leave_the_root);
+    return UNITY_END();
+}
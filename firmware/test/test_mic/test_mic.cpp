@@ -0,0 +1,152 @@
+// Capture path on the host: pio test -e native
+// The I2S port reads silence; recordings use a real-time tone and land in the
+// directory-backed LittleFS.
+#include <unity.h>
+#include <MicManager.h>
+
+static MicManager mic(26, 25, 33);
+
+static uint32_t readU32(File& file, uint32_t offset) {
+    uint32_t value = 0;
+    file.seek(offset);
+    file.read(reinterpret_cast<uint8_t*>(&value), sizeof(value));
+    return value;
+}
+
+void setUp() {
+    LittleFS.setTotalBytes(LittleFS.usedBytes() + 256 * 1024);
+}
+
+void tearDown() {}
+
+void test_recording_writes_a_wav_with_the_final_size() {
+    TEST_ASSERT_TRUE(mic.setSource(new ToneAudioSource(440.0f, 0.5f, true)));
+    TEST_ASSERT_TRUE(mic.startRecording("/rec.wav"));
+    TEST_ASSERT_TRUE(mic.isRecording());
+    delay(500);
+    TEST_ASSERT_TRUE(mic.stopRecording());
+    TEST_ASSERT_FALSE(mic.isRecording());
+
+    File file = LittleFS.open("/rec.wav", "r");
+    TEST_ASSERT_TRUE((bool)file);
+    size_t bytes = mic.getRecordedBytes();
+    TEST_ASSERT_TRUE(bytes > 0);
+    TEST_ASSERT_EQUAL(44 + bytes, file.size());
+
+    char riff[4];
+    file.read(reinterpret_cast<uint8_t*>(riff), 4);
+    TEST_ASSERT_EQUAL_MEMORY("RIFF", riff, 4);
+    TEST_ASSERT_EQUAL(36 + bytes, readU32(file, 4));
+    TEST_ASSERT_EQUAL(16000, readU32(file, 24));
+    TEST_ASSERT_EQUAL(bytes, readU32(file, 40));
+    file.close();
+
+    TEST_ASSERT_TRUE(mic.setSource(nullptr));
+    LittleFS.remove("/rec.wav");
+}
+
+void test_benchmark_keeps_up_with_real_time() {
+    MicManager::CaptureBenchmark result;
+    TEST_ASSERT_TRUE(mic.runBenchmark(16000, result));
+    TEST_ASSERT_TRUE(result.samples >= 16000);
+    TEST_ASSERT_TRUE(result.blocks > 0);
+    TEST_ASSERT_EQUAL(0, result.dropped);
+    TEST_ASSERT_TRUE(result.samples * 1000000.0 / result.totalMicros >= 16000);
+    TEST_ASSERT_FALSE(LittleFS.exists("/bench.wav"));
+    TEST_ASSERT_FALSE(mic.isCapturing());
+    TEST_ASSERT_EQUAL_STRING("i2s", mic.sourceName());
+}
+
+void test_benchmark_fails_on_a_full_filesystem() {
+    LittleFS.setTotalBytes(LittleFS.usedBytes() + 4096);
+    MicManager::CaptureBenchmark result;
+    TEST_ASSERT_FALSE(mic.runBenchmark(16000, result));
+    TEST_ASSERT_TRUE(result.samples < 16000);
+    TEST_ASSERT_FALSE(LittleFS.exists("/bench.wav"));
+    TEST_ASSERT_FALSE(mic.isCapturing());
+}
+
+void test_spectrum_start_and_stop_do_not_wait() {
+    TEST_ASSERT_TRUE(mic.setSource(new ToneAudioSource(440.0f, 0.5f, true)));
+    static volatile uint32_t frames = 0;
+    frames = 0;
+    int listener = mic.addSpectrumListener([](const SpectrumFrame&) { frames++; });
+
+    // Called on the network task: neither may wait for the spectrum or capture task
+    uint32_t started = millis();
+    TEST_ASSERT_TRUE(mic.startSpectrum());
+    TEST_ASSERT_TRUE(millis() - started < 20);
+    uint32_t timeout = millis() + 2000;
+    while (frames == 0 && millis() < timeout) delay(5);
+    TEST_ASSERT_TRUE(frames > 0);
+
+    started = millis();
+    TEST_ASSERT_TRUE(mic.stopSpectrum());
+    TEST_ASSERT_FALSE(mic.stopSpectrum());
+    TEST_ASSERT_TRUE(millis() - started < 20);
+
+    // Started again before the task wound down: it keeps running
+    TEST_ASSERT_TRUE(mic.startSpectrum());
+    uint32_t seen = frames;
+    timeout = millis() + 2000;
+    while (frames == seen && millis() < timeout) delay(5);
+    TEST_ASSERT_TRUE(frames > seen);
+
+    TEST_ASSERT_TRUE(mic.stopSpectrum());
+    timeout = millis() + 2000;
+    while (mic.isCapturing() && millis() < timeout) delay(5);
+    TEST_ASSERT_FALSE(mic.isCapturing());
+    TEST_ASSERT_EQUAL(0, mic.bus().subscriberCount());
+
+    mic.removeSpectrumListener(listener);
+    TEST_ASSERT_TRUE(mic.setSource(nullptr));
+}
+
+void test_unsubscribe_wakes_a_blocked_receiver() {
+    AudioBus bus;
+    TEST_ASSERT_TRUE(bus.begin());
+    int id = bus.subscribe("blocked", 2, AudioBus::DropPolicy::DropNewest);
+    TEST_ASSERT_TRUE(id >= 0);
+
+    struct Receiver {
+        AudioBus* bus;
+        int id;
+        volatile bool inside;
+        volatile bool returned;
+        AudioBlock* block;
+    };
+    static Receiver receiver;
+    receiver = Receiver{ &bus, id, false, false, nullptr };
+    xTaskCreate([](void* param) {
+        Receiver* r = static_cast<Receiver*>(param);
+        r->inside = true;
+        r->block = r->bus->receive(r->id, pdMS_TO_TICKS(5000));
+        r->returned = true;
+        vTaskDelete(nullptr);
+    }, "Receiver", 2048, &receiver, 1, nullptr);
+    while (!receiver.inside) delay(1);
+    delay(20);
+
+    // Unsubscribed from another task while the receiver waits on the queue
+    uint32_t started = millis();
+    bus.unsubscribe(id);
+    TEST_ASSERT_TRUE(millis() - started < 100);
+    TEST_ASSERT_TRUE(receiver.returned);
+    TEST_ASSERT_NULL(receiver.block);
+    TEST_ASSERT_EQUAL(0, bus.subscriberCount());
+    TEST_ASSERT_NULL(bus.receive(id, 0));
+    TEST_ASSERT_EQUAL(AudioBus::POOL_SIZE, bus.freeBlocks());
+}
+
+int main(int argc, char** argv) {
+    LittleFS.format();
+    mic.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_recording_writes_a_wav_with_the_final_size);
+    RUN_TEST(test_benchmark_keeps_up_with_real_time);
+    RUN_TEST(test_benchmark_fails_on_a_full_filesystem);
+    RUN_TEST(test_spectrum_start_and_stop_do_not_wait);
+    RUN_TEST(test_unsubscribe_wakes_a_blocked_receiver);
+    return UNITY_END();
+}
@@ -0,0 +1,401 @@
+// Routes, guards and middleware on the host: pio test -e native
+// Requests are SyntheticRequests dispatched with ServerManager::handle(), the same
+// path /batch and `server bench` use on the device.
+#include <unity.h>
+#include <algorithm>
+#include <ServerManager.h>
+#include <SyntheticRequest.h>
+#include <JobQueue.h>
+#include "server/guards/AuthGuard.h"
+#include "server/routes/auth.h"
+#include "server/routes/status.h"
+#include "server/routes/wifi.h"
+#include "server/routes/jobs.h"
+#include "commands/server.h"
+
+static const char* PASSWORD = "correct horse";
+
+// Records what reached the client, as MetricsMiddleware does
+class RecordingMiddleware : public Middleware {
+public:
+    int handled = 0;
+    int lastStatus = 0;
+    String lastRoute;
+
+    void handle(HttpRequest* request, std::function<void()> next) override {
+        handled++;
+        next();
+    }
+    void onResponse(HttpRequest* request, const char* route, int status) override {
+        lastRoute = route;
+        lastStatus = status;
+    }
+};
+
+AuthGuard testAuthGuard;
+
+static const BodySchema echoBody({
+    { "name", BodyType::String, true, 32 },
+}, 128);
+
+Router guardedRouter("/guarded", [](Router *r) {
+    r->useGuards({ &testAuthGuard });
+    r->get("/ping", [](HttpRequest *request) -> HttpSuccess {
+        return HttpSuccess(String("pong"));
+    });
+    r->postWithSchema("/echo", echoBody, [](HttpRequest *request, const ParsedBody &body) -> HttpSuccess {
+        return HttpSuccess(String(body.str("name")));
+    });
+});
+
+// Cached, and answers differently per query parameter
+static int greetings = 0;
+Router greetRouter("/greet", [](Router *r) {
+    r->get("", [](HttpRequest *request) -> HttpSuccess {
+        greetings++;
+        return HttpSuccess(String("hello ") + (request->hasParam("name") ? request->param("name") : String("you")));
+    });
+    r->cache("", 60000);
+});
+
+static ServerManager* server;
+static WiFiManager* wifi;
+static JobQueue jobs;
+static RecordingMiddleware recorder;
+
+static void dispatch(SyntheticRequest& request, const char* body = nullptr) {
+    server->handle(request, reinterpret_cast<const uint8_t*>(body), body ? strlen(body) : 0);
+}
+
+static String login() {
+    SyntheticRequest request(HttpMethod::Post, "/auth/login");
+    dispatch(request, "{\"password\":\"correct horse\"}");
+    const String& cookie = request.responseHeader("Set-Cookie");
+    int start = cookie.indexOf('=') + 1;
+    return cookie.substring(start, cookie.indexOf(';'));
+}
+
+static bool waitForJob(uint32_t id, JobQueue::Info& info) {
+    for (int i = 0; i < 1000; i++) {   // behind a wifi.stopAP job that waits 5 s
+        if (jobs.info(id, info) && (info.state == JobQueue::State::Done || info.state == JobQueue::State::Failed))
+            return true;
+        delay(10);
+    }
+    return false;
+}
+
+void setUp() {
+    WiFi.disconnect();
+    WiFi.mode(WIFI_AP);
+}
+
+void tearDown() {}
+
+void test_wizard_is_shown_until_setup_finished() {
+    SyntheticRequest request(HttpMethod::Get, "/status/wizard");
+    dispatch(request);
+    TEST_ASSERT_EQUAL(200, request.status());
+    TEST_ASSERT_EQUAL_STRING("application/json", request.contentType());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":true,\"data\":true}", request.body().c_str());
+    TEST_ASSERT_EQUAL_STRING("/status/wizard", recorder.lastRoute.c_str());
+    TEST_ASSERT_EQUAL(200, recorder.lastStatus);
+
+    // Cached, with an ETag, until isReady changes
+    SyntheticRequest again(HttpMethod::Get, "/status/wizard");
+    again.withHeader("If-None-Match", request.responseHeader("ETag"));
+    dispatch(again);
+    TEST_ASSERT_EQUAL(304, again.status());
+
+    ConfigManager::getInstance().set("isReady", true);
+    SyntheticRequest ready(HttpMethod::Get, "/status/wizard");
+    dispatch(ready);
+    TEST_ASSERT_EQUAL(200, ready.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":true,\"data\":false}", ready.body().c_str());
+    ConfigManager::getInstance().set("isReady", false);
+}
+
+void test_cache_keys_on_the_query_parameters_read() {
+    const char* targets[] = { "/greet?name=ada", "/greet?name=alan", "/greet", "/greet?name=ada&unused=1" };
+    const char* bodies[] = { "hello ada", "hello alan", "hello you", "hello ada" };
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 4; i++) {
+            SyntheticRequest request(HttpMethod::Get, targets[i]);
+            dispatch(request);
+            TEST_ASSERT_EQUAL(200, request.status());
+            TEST_ASSERT_EQUAL_STRING((String("{\"ok\":true,\"data\":\"") + bodies[i] + "\"}").c_str(),
+                                     request.body().c_str());
+        }
+    }
+    // One handler run per value of `name`; the parameter it never reads is not in the key
+    TEST_ASSERT_EQUAL(3, greetings);
+}
+
+void test_unknown_route_is_404() {
+    SyntheticRequest request(HttpMethod::Get, "/status/nope");
+    TEST_ASSERT_FALSE(server->handle(request));
+    TEST_ASSERT_EQUAL(404, request.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"Not found\"}", request.body().c_str());
+}
+
+void test_login_rejects_missing_and_wrong_passwords() {
+    SyntheticRequest missing(HttpMethod::Post, "/auth/login");
+    dispatch(missing, "{}");
+    TEST_ASSERT_EQUAL(400, missing.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"password is required\"}", missing.body().c_str());
+
+    SyntheticRequest wrong(HttpMethod::Post, "/auth/login");
+    dispatch(wrong, "{\"password\":\"wrong\"}");
+    TEST_ASSERT_EQUAL(400, wrong.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"Invalid password.\"}", wrong.body().c_str());
+
+    SyntheticRequest invalid(HttpMethod::Post, "/auth/login");
+    dispatch(invalid, "not json");
+    TEST_ASSERT_EQUAL(400, invalid.status());
+    TEST_ASSERT_EQUAL(400, recorder.lastStatus);
+}
+
+void test_login_issues_a_token_the_guard_accepts() {
+    SyntheticRequest request(HttpMethod::Post, "/auth/login");
+    dispatch(request, "{\"password\":\"correct horse\"}");
+    TEST_ASSERT_EQUAL(200, request.status());
+    TEST_ASSERT_TRUE(request.body().startsWith("{\"ok\": true, \"data\": { \"accessToken\": \""));
+    TEST_ASSERT_TRUE(request.responseHeader("Set-Cookie").startsWith("accessToken="));
+
+    String token = login();
+    TEST_ASSERT_EQUAL(2, (int)std::count(token.begin(), token.end(), '.'));
+
+    SyntheticRequest bearer(HttpMethod::Get, "/guarded/ping");
+    bearer.withHeader("Authorization", "Bearer " + token);
+    dispatch(bearer);
+    TEST_ASSERT_EQUAL(200, bearer.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":true,\"data\":\"pong\"}", bearer.body().c_str());
+
+    SyntheticRequest cookie(HttpMethod::Get, "/guarded/ping");
+    cookie.withHeader("Cookie", "theme=dark; accessToken=" + token);
+    dispatch(cookie);
+    TEST_ASSERT_EQUAL(200, cookie.status());
+}
+
+void test_guard_rejects_missing_and_forged_tokens() {
+    int handled = recorder.handled;
+    SyntheticRequest none(HttpMethod::Get, "/guarded/ping");
+    dispatch(none);
+    TEST_ASSERT_EQUAL(401, none.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"Unauthorized\"}", none.body().c_str());
+    TEST_ASSERT_EQUAL(401, recorder.lastStatus);
+
+    String token = login();
+    TEST_ASSERT_TRUE(token.length() > 0);
+    token.setCharAt(token.length() - 1, token[token.length() - 1] == 'a' ? 'b' : 'a');
+    SyntheticRequest forged(HttpMethod::Get, "/guarded/ping");
+    forged.withHeader("Authorization", "Bearer " + token);
+    dispatch(forged);
+    TEST_ASSERT_EQUAL(401, forged.status());
+
+    // Batch entries are trusted once the batch itself was checked
+    SyntheticRequest trusted(HttpMethod::Get, "/guarded/ping");
+    trusted.withAuthentication();
+    dispatch(trusted);
+    TEST_ASSERT_EQUAL(200, trusted.status());
+    TEST_ASSERT_TRUE(recorder.handled > handled);
+}
+
+// operator new calls for one dispatch of request, after a first one has warmed it up
+static uint32_t allocationsFor(SyntheticRequest& request, const char* body = nullptr) {
+    dispatch(request, body);
+    TEST_ASSERT_EQUAL(200, request.status());
+    request.reset();
+    TEST_ASSERT_TRUE(ServerManager::beginAllocationCount());
+    dispatch(request, body);
+    uint32_t allocations = ServerManager::endAllocationCount();
+    TEST_ASSERT_EQUAL(200, request.status());
+    return allocations;
+}
+
+void test_warm_routes_do_not_allocate() {
+    String token = login();
+    SyntheticRequest ping(HttpMethod::Get, "/guarded/ping");
+    ping.withHeader("Authorization", "Bearer " + token);
+    TEST_ASSERT_EQUAL(0, allocationsFor(ping));
+
+    SyntheticRequest echo(HttpMethod::Post, "/guarded/echo");
+    echo.withHeader("Authorization", "Bearer " + token);
+    TEST_ASSERT_EQUAL(0, allocationsFor(echo, "{\"name\":\"jarvis\",\"ignored\":[1,2,3]}"));
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":true,\"data\":\"jarvis\"}", echo.body().c_str());
+}
+
+// `server bench` on the host: the same measurement, printed with the test output
+void test_bench_reports_rate_and_allocations() {
+    String token = login();
+    struct Case { HttpMethod method; const char* target; const char* body; bool authorized; int status; };
+    static const Case cases[] = {
+        { HttpMethod::Get,  "/status/wizard", nullptr, false, 200 },
+        { HttpMethod::Post, "/auth/login", "{\"password\":\"\"}", false, 400 },
+        { HttpMethod::Post, "/wifi/connect", "{}", false, 400 },
+        { HttpMethod::Get,  "/guarded/ping", nullptr, true, 200 },
+        { HttpMethod::Get,  "/guarded/ping", nullptr, false, 401 },
+        { HttpMethod::Post, "/guarded/echo", "{\"name\":\"jarvis\"}", true, 200 },
+    };
+
+    for (const Case& c : cases) {
+        BenchResult result = measureBench(server, c.method, c.target, c.body ? c.body : "",
+                                          c.authorized ? token : String(), 200);
+        TEST_MESSAGE(formatBench(result).c_str());
+        TEST_ASSERT_EQUAL(c.status, result.status);
+        TEST_ASSERT_TRUE(result.requestsPerSecond() > 0);
+        TEST_ASSERT_TRUE(result.allocsPerRequest >= 0);   // JARVIS_ALLOC_TRACE in the native env
+        if (c.authorized) TEST_ASSERT_EQUAL(0, (int)result.allocsPerRequest);
+    }
+}
+
+void test_wifi_list_sends_the_cached_scan() {
+    WiFi.networks = { { "home", -48, WIFI_AUTH_WPA2_PSK }, { "cafe", -71, WIFI_AUTH_OPEN } };
+    wifi->requestScan();
+    wifi->updateScan();     // starts the scan
+    wifi->updateScan();     // collects it
+    TEST_ASSERT_TRUE(wifi->scanGeneration() > 0);
+
+    SyntheticRequest request(HttpMethod::Get, "/wifi/list");
+    dispatch(request);
+    TEST_ASSERT_EQUAL(200, request.status());
+    String expectedHead = "{\"ok\":true,\"data\":{\"generation\":" + String(wifi->scanGeneration()) + ",\"ageMs\":";
+    TEST_ASSERT_TRUE(request.body().startsWith(expectedHead));
+    TEST_ASSERT_TRUE(request.body().endsWith(
+        ",\"networks\":[{\"ssid\":\"home\",\"rssi\":-48,\"secure\":true,\"hidden\":false},"
+        "{\"ssid\":\"cafe\",\"rssi\":-71,\"secure\":false,\"hidden\":false}]}}"));
+}
+
+void test_wifi_connect_validates_the_body() {
+    SyntheticRequest missing(HttpMethod::Post, "/wifi/connect");
+    dispatch(missing, "{\"password\":\"secret\"}");
+    TEST_ASSERT_EQUAL(400, missing.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"ssid is required\"}", missing.body().c_str());
+
+    SyntheticRequest tooLong(HttpMethod::Post, "/wifi/connect");
+    dispatch(tooLong, "{\"ssid\":\"0123456789abcdef0123456789abcdefX\"}");
+    TEST_ASSERT_EQUAL(400, tooLong.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"ssid is too long\"}", tooLong.body().c_str());
+
+    SyntheticRequest wrongType(HttpMethod::Post, "/wifi/connect");
+    dispatch(wrongType, "{\"ssid\":42}");
+    TEST_ASSERT_EQUAL(400, wrongType.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"ssid must be a string\"}", wrongType.body().c_str());
+}
+
+void test_wifi_connect_runs_as_a_job_and_finishes_setup() {
+    ConfigManager& config = ConfigManager::getInstance();
+    WiFi.joinable = true;
+
+    SyntheticRequest request(HttpMethod::Post, "/wifi/connect");
+    dispatch(request, "{\"ssid\":\"home\",\"password\":\"wifi-pass\",\"authPassword\":\"new admin\"}");
+    TEST_ASSERT_EQUAL(202, request.status());
+    TEST_ASSERT_TRUE(request.responseHeader("Location").startsWith("/jobs/"));
+    uint32_t id = request.responseHeader("Location").substring(6).toInt();
+    TEST_ASSERT_EQUAL_STRING(("{\"ok\":true,\"data\":{\"id\":" + String(id) + "}}").c_str(), request.body().c_str());
+
+    JobQueue::Info info;
+    TEST_ASSERT_TRUE(waitForJob(id, info));
+    TEST_ASSERT_EQUAL(JobQueue::State::Done, info.state);
+    TEST_ASSERT_EQUAL_STRING("{\"ip\":\"192.168.1.50\"}", info.result.c_str());
+    TEST_ASSERT_EQUAL_STRING("home", config.get("wifi")["ssid"].as<String>().c_str());
+    TEST_ASSERT_TRUE(config.get("isReady").as<bool>());
+    TEST_ASSERT_EQUAL_STRING(JWTAuth::hmacSha256("new admin", config.get("jwt")["secret"].as<String>()).c_str(),
+                             config.get("hashedPassword").as<String>().c_str());
+
+    // Already connected now
+    SyntheticRequest again(HttpMethod::Post, "/wifi/connect");
+    dispatch(again, "{\"ssid\":\"home\"}");
+    TEST_ASSERT_EQUAL(400, again.status());
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":false,\"error\":\"Already connected to a WiFi.\"}", again.body().c_str());
+
+    // Restore the state the other tests expect
+    config.set("isReady", false);
+    config.set("hashedPassword", JWTAuth::hmacSha256(PASSWORD, config.get("jwt")["secret"].as<String>()));
+}
+
+void test_wifi_connect_job_fails_when_the_network_refuses() {
+    WiFi.joinable = false;
+    SyntheticRequest request(HttpMethod::Post, "/wifi/connect");
+    dispatch(request, "{\"ssid\":\"elsewhere\"}");
+    TEST_ASSERT_EQUAL(202, request.status());
+    uint32_t id = request.responseHeader("Location").substring(6).toInt();
+
+    JobQueue::Info info;
+    TEST_ASSERT_TRUE(waitForJob(id, info));
+    TEST_ASSERT_EQUAL(JobQueue::State::Failed, info.state);
+    TEST_ASSERT_EQUAL(400, info.status);
+    TEST_ASSERT_EQUAL_STRING("Couldn't connect to the wifi.", info.error.c_str());
+    WiFi.joinable = true;
+}
+
+void test_finished_job_reads_back_over_msgpack() {
+    uint32_t id = jobs.submit("test.result", [](JsonDocument& result) {
+        result["token"] = "abc";
+        result["count"] = 3;
+    });
+    JobQueue::Info info;
+    TEST_ASSERT_TRUE(waitForJob(id, info));
+
+    SyntheticRequest request(HttpMethod::Get, "/jobs/" + String(id));
+    request.withHeader("Accept", "application/msgpack");
+    dispatch(request);
+    TEST_ASSERT_EQUAL(200, request.status());
+    TEST_ASSERT_EQUAL_STRING("application/msgpack", request.contentType());
+
+    JsonDocument decoded;
+    TEST_ASSERT_FALSE(deserializeMsgPack(decoded, request.body().c_str(), request.body().length()));
+    TEST_ASSERT_TRUE(decoded["ok"].as<bool>());
+    TEST_ASSERT_EQUAL_STRING("done", decoded["data"]["state"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("abc", decoded["data"]["result"]["token"].as<const char*>());
+    TEST_ASSERT_EQUAL(3, decoded["data"]["result"]["count"].as<int>());
+
+    SyntheticRequest json(HttpMethod::Get, "/jobs/" + String(id));
+    dispatch(json);
+    TEST_ASSERT_TRUE(json.body().endsWith(",\"result\":{\"token\":\"abc\",\"count\":3}}}"));
+}
+
+int main(int argc, char** argv) {
+    // Provisioned the way prebuild.py does it: ConfigManager only creates keys inside an object
+    LittleFS.format();
+    File seed = LittleFS.open("/config.json", "w");
+    seed.print("{\"isReady\":false,\"wifi\":{\"ssid\":\"\"},\"jwt\":{\"secret\":\"native-test-secret\"}}");
+    seed.close();
+    ConfigManager& config = ConfigManager::getInstance();
+    config.set("hashedPassword", JWTAuth::hmacSha256(PASSWORD, "native-test-secret"));
+
+    wifi = new WiFiManager();
+    jobs.begin();
+    server = new ServerManager(80);
+    config.onChange([](const String& key) {
+        server->invalidateCache(key);
+        if (key.startsWith("jwt")) JWTAuth::resetKey();
+    });
+    server->addDependency("config", &config);
+    server->addDependency("wifi", wifi);
+    server->addDependency("jobs", &jobs);
+    server->addDependency("server", server);
+    server->use(&recorder);
+    server->addRouter(&authRouter);
+    server->addRouter(&statusRouter);
+    server->addRouter(&wifiRouter);
+    server->addRouter(&jobsRouter);
+    server->addRouter(&guardedRouter);
+    server->addRouter(&greetRouter);
+    server->begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_wizard_is_shown_until_setup_finished);
+    RUN_TEST(test_cache_keys_on_the_query_parameters_read);
+    RUN_TEST(test_unknown_route_is_404);
+    RUN_TEST(test_login_rejects_missing_and_wrong_passwords);
+    RUN_TEST(test_login_issues_a_token_the_guard_accepts);
+    RUN_TEST(test_guard_rejects_missing_and_forged_tokens);
+    RUN_TEST(test_warm_routes_do_not_allocate);
+    RUN_TEST(test_bench_reports_rate_and_allocations);
+    RUN_TEST(test_wifi_list_sends_the_cached_scan);
+    RUN_TEST(test_wifi_connect_validates_the_body);
+    RUN_TEST(test_wifi_connect_runs_as_a_job_and_finishes_setup);
+    RUN_TEST(test_wifi_connect_job_fails_when_the_network_refuses);
+    RUN_TEST(test_finished_job_reads_back_over_msgpack);
+    return UNITY_END();
+}
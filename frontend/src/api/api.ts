@@ -1,5 +1,6 @@
 /* eslint-disable @typescript-eslint/no-explicit-any */
-import axios, { AxiosError } from "axios";
+import axios, { AxiosError, type AxiosResponseHeaders } from "axios";
+import { decodeMsgPack } from "./msgpack";
 
 export interface ApiResponse<T = any> {
   ok: boolean;
@@ -9,10 +10,29 @@ export interface ApiResponse<T = any> {
 // ✅ Base URL config
 const BASE_URL = import.meta.env.VITE_API_URL || `${window.location.origin}`;
 
+// ✅ Responses: MessagePack when the device supports it (smaller, no number
+// formatting on the device), JSON otherwise; decoded by their Content-Type
+const decodeResponse = (data: unknown, headers: AxiosResponseHeaders): any => {
+  if (!(data instanceof ArrayBuffer) || data.byteLength === 0) return data;
+  const type = String(headers?.["content-type"] ?? "");
+  if (type.includes("msgpack")) return decodeMsgPack(data);
+  const text = new TextDecoder().decode(data);
+  try {
+    return JSON.parse(text);
+  } catch {
+    return text;
+  }
+};
+
 const api = axios.create({
   baseURL: BASE_URL,
   withCredentials: true, // keep cookies/session
-  headers: { "Content-Type": "application/json" },
+  headers: {
+    "Content-Type": "application/json",
+    Accept: "application/msgpack, application/json",
+  },
+  responseType: "arraybuffer",
+  transformResponse: [decodeResponse],
 });
 
 // ✅ Handle GET requests
@@ -40,6 +60,70 @@ export const postApi = async <T = any>(
   }
 };
 
+// ✅ Several requests in one round trip (POST /batch). Entries run in order on the
+// device and each result carries its own HTTP status and { ok, data } envelope.
+export interface BatchRequest {
+  method?: "GET" | "POST" | "DELETE";
+  path: string;
+  body?: any;
+}
+
+export interface BatchResult<T = any> {
+  status: number;
+  body: ApiResponse<T> | string;
+}
+
+export const batchApi = async (
+  requests: BatchRequest[]
+): Promise<ApiResponse<BatchResult[]>> => postApi<BatchResult[]>("/batch", requests);
+
+// ✅ Background jobs: routes that answer 202 return { id }; poll until the job finished
+export interface JobStatus<T = any> {
+  id: number;
+  name: string;
+  state: "queued" | "running" | "done" | "failed";
+  result?: T;
+  error?: string;
+}
+
+export const waitForJob = async <T = any>(
+  id: number,
+  intervalMs = 500,
+  timeoutMs = 30000
+): Promise<ApiResponse<T>> => {
+  const deadline = Date.now() + timeoutMs;
+  while (Date.now() < deadline) {
+    const res = await getApi<JobStatus<T>>(`/jobs/${id}`);
+    if (!res.ok) return res as ApiResponse<T>;
+    const job = res.data as JobStatus<T>;
+    if (job.state === "done") return { ok: true, data: job.result as T };
+    if (job.state === "failed")
+      return { ok: false, data: job.error || "Job failed." };
+    await new Promise((resolve) => setTimeout(resolve, intervalMs));
+  }
+  return { ok: false, data: "Timed out waiting for the device." };
+};
+
+// ✅ Subscribe to device events (Server-Sent Events at /events).
+// Each topic delivers its latest state as JSON; returns an unsubscribe function.
+export const subscribeEvents = (
+  handlers: Record<string, (data: any) => void>
+): (() => void) => {
+  const source = new EventSource(`${BASE_URL}/events`, {
+    withCredentials: true,
+  });
+  Object.entries(handlers).forEach(([topic, handler]) => {
+    source.addEventListener(topic, (event) => {
+      try {
+        handler(JSON.parse((event as MessageEvent).data));
+      } catch (err) {
+        console.error(`Bad ${topic} event`, err);
+      }
+    });
+  });
+  return () => source.close();
+};
+
 // ✅ Centralized error handler
 const handleAxiosError = (err: unknown): ApiResponse => {
   if (axios.isAxiosError(err)) {
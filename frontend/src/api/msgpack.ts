@@ -0,0 +1,77 @@
+/* eslint-disable @typescript-eslint/no-explicit-any */
+
+// ✅ Minimal MessagePack decoder for device responses (Accept: application/msgpack).
+// Covers everything ArduinoJson writes: nil, booleans, integers, float32/64,
+// strings, binary, arrays and maps. Extension types are not used by the device.
+const textDecoder = new TextDecoder();
+
+export const decodeMsgPack = (buffer: ArrayBuffer): any => {
+  const view = new DataView(buffer);
+  const bytes = new Uint8Array(buffer);
+  let pos = 0;
+
+  const str = (length: number): string => {
+    const value = textDecoder.decode(bytes.subarray(pos, pos + length));
+    pos += length;
+    return value;
+  };
+  const bin = (length: number): Uint8Array => {
+    const value = bytes.slice(pos, pos + length);
+    pos += length;
+    return value;
+  };
+  const array = (length: number): any[] => {
+    const value = new Array(length);
+    for (let i = 0; i < length; i++) value[i] = read();
+    return value;
+  };
+  const map = (length: number): Record<string, any> => {
+    const value: Record<string, any> = {};
+    for (let i = 0; i < length; i++) {
+      const key = String(read());
+      value[key] = read();
+    }
+    return value;
+  };
+
+  const read = (): any => {
+    if (pos >= bytes.length) throw new Error("Truncated MessagePack data");
+    const type = bytes[pos++];
+
+    if (type <= 0x7f) return type; // positive fixint
+    if (type >= 0xe0) return type - 0x100; // negative fixint
+    if ((type & 0xe0) === 0xa0) return str(type & 0x1f);
+    if ((type & 0xf0) === 0x90) return array(type & 0x0f);
+    if ((type & 0xf0) === 0x80) return map(type & 0x0f);
+
+    let value: any;
+    switch (type) {
+      case 0xc0: return null;
+      case 0xc2: return false;
+      case 0xc3: return true;
+      case 0xc4: value = view.getUint8(pos); pos += 1; return bin(value);
+      case 0xc5: value = view.getUint16(pos); pos += 2; return bin(value);
+      case 0xc6: value = view.getUint32(pos); pos += 4; return bin(value);
+      case 0xca: value = view.getFloat32(pos); pos += 4; return value;
+      case 0xcb: value = view.getFloat64(pos); pos += 8; return value;
+      case 0xcc: value = view.getUint8(pos); pos += 1; return value;
+      case 0xcd: value = view.getUint16(pos); pos += 2; return value;
+      case 0xce: value = view.getUint32(pos); pos += 4; return value;
+      case 0xcf: value = Number(view.getBigUint64(pos)); pos += 8; return value;
+      case 0xd0: value = view.getInt8(pos); pos += 1; return value;
+      case 0xd1: value = view.getInt16(pos); pos += 2; return value;
+      case 0xd2: value = view.getInt32(pos); pos += 4; return value;
+      case 0xd3: value = Number(view.getBigInt64(pos)); pos += 8; return value;
+      case 0xd9: value = view.getUint8(pos); pos += 1; return str(value);
+      case 0xda: value = view.getUint16(pos); pos += 2; return str(value);
+      case 0xdb: value = view.getUint32(pos); pos += 4; return str(value);
+      case 0xdc: value = view.getUint16(pos); pos += 2; return array(value);
+      case 0xdd: value = view.getUint32(pos); pos += 4; return array(value);
+      case 0xde: value = view.getUint16(pos); pos += 2; return map(value);
+      case 0xdf: value = view.getUint32(pos); pos += 4; return map(value);
+    }
+    throw new Error(`Unsupported MessagePack type 0x${type.toString(16)}`);
+  };
+
+  return read();
+};
@@ -0,0 +1,46 @@
+import React, { useEffect, useState } from "react";
+import ReconnectingWebSocket from "reconnecting-websocket";
+
+const BAND_COUNT = 16;
+
+// Live microphone spectrum streamed by the device over /ws/spectrum (one byte per band)
+const SpectrumView: React.FC = () => {
+  const [bands, setBands] = useState<number[]>(Array(BAND_COUNT).fill(0));
+  const [connected, setConnected] = useState(false);
+
+  useEffect(() => {
+    const base = import.meta.env.VITE_API_URL || window.location.origin;
+    const url = base.replace(/^http/, "ws") + "/ws/spectrum";
+    const ws = new ReconnectingWebSocket(url);
+    ws.binaryType = "arraybuffer";
+
+    ws.onopen = () => setConnected(true);
+    ws.onclose = () => setConnected(false);
+    ws.onmessage = (event) => {
+      if (event.data instanceof ArrayBuffer) {
+        setBands(Array.from(new Uint8Array(event.data)));
+      }
+    };
+
+    return () => ws.close();
+  }, []);
+
+  return (
+    <div>
+      <div className="flex items-end gap-1 h-40 p-3 rounded-lg border border-neutral-300 dark:border-neutral-700">
+        {bands.map((level, i) => (
+          <div
+            key={i}
+            className="flex-1 bg-blue-500 rounded-t transition-[height] duration-75"
+            style={{ height: `${(level / 255) * 100}%` }}
+          />
+        ))}
+      </div>
+      <p className="text-neutral-500 text-sm mt-2">
+        {connected ? "Live" : "Connecting..."}
+      </p>
+    </div>
+  );
+};
+
+export default SpectrumView;
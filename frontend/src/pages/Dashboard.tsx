@@ -2,9 +2,10 @@ import React, { useState } from "react";
 import { motion, AnimatePresence } from "framer-motion";
 import DarkModeToggle from "../components/DarkModeToggle";
 import PixelEye from "../components/pixelEye";
+import SpectrumView from "../components/SpectrumView";
 import { useNavigate } from "react-router-dom";
 
-type Section = "webserver" | "password" | "wifi";
+type Section = "webserver" | "password" | "wifi" | "mic";
 
 const Dashboard: React.FC = () => {
   const navigate = useNavigate();
@@ -79,6 +80,16 @@ const Dashboard: React.FC = () => {
             >
               Wi-Fi Setup
             </button>
+            <button
+              onClick={() => setActiveSection("mic")}
+              className={`w-full text-left px-4 py-2 rounded-lg transition ${
+                activeSection === "mic"
+                  ? "bg-blue-500 text-white"
+                  : "hover:bg-neutral-200 dark:hover:bg-neutral-800"
+              }`}
+            >
+              Microphone
+            </button>
           </nav>
         </div>
 
@@ -182,6 +193,22 @@ const Dashboard: React.FC = () => {
               </button>
             </motion.div>
           )}
+
+          {activeSection === "mic" && (
+            <motion.div
+              key="mic"
+              initial={{ opacity: 0, y: 30 }}
+              animate={{ opacity: 1, y: 0 }}
+              exit={{ opacity: 0, y: -30 }}
+              transition={{ duration: 0.3 }}
+            >
+              <h2 className="text-2xl font-bold mb-4">Microphone Spectrum</h2>
+              <p className="text-neutral-500 mb-6">
+                Live band levels from the device microphone.
+              </p>
+              <SpectrumView />
+            </motion.div>
+          )}
         </AnimatePresence>
       </div>
     </div>
@@ -1,10 +1,10 @@
 /* eslint-disable @typescript-eslint/no-explicit-any */
-import React, { useEffect, useState } from "react";
+import React, { useEffect, useRef, useState } from "react";
 import { useNavigate } from "react-router-dom";
 import PixelEye from "../components/pixelEye";
 import DarkModeToggle from "../components/DarkModeToggle";
 import { motion, AnimatePresence } from "framer-motion";
-import { getApi, postApi } from "../api/api";
+import { getApi, postApi, subscribeEvents, waitForJob } from "../api/api";
 import { useNotification } from "../providers/NotificationProvider";
 
 interface WifiNetwork {
@@ -14,9 +14,20 @@ interface WifiNetwork {
   hidden?: boolean;
 }
 
+interface ScanEvent {
+  complete: boolean;
+  count: number;
+  generation: number;
+}
+
+interface WifiList {
+  generation: number;
+  ageMs: number;
+  networks: WifiNetwork[];
+}
+
 interface ConnectionResult {
   ip: string;
-  accessToken: string;
 }
 
 type Step = "setPassword" | "scan" | "wifiPassword" | "connecting" | "done";
@@ -36,29 +47,49 @@ const Wizard: React.FC = () => {
 
   const notif = useNotification();
 
-  // Fetch Wi-Fi list
+  // The device keeps the last scan; ?since=<generation> waits for a newer one
+  const generation = useRef(0);
+
+  const fetchWifiList = async (since?: number) => {
+    try {
+      const res = await getApi<WifiList>(
+        since === undefined ? "/wifi/list" : `/wifi/list?since=${since}`
+      );
+      if (!res.ok) throw new Error(res.data as string);
+      const list = res.data as WifiList;
+      generation.current = list.generation;
+      setWifiList(list.networks || []);
+    } catch (err: any) {
+      console.error(err);
+      setError("Failed to scan Wi-Fi networks.");
+      notif.notify(
+        (err as string) || "Failed to scan Wi-Fi networks.",
+        "error"
+      );
+    } finally {
+      setLoading(false);
+    }
+  };
+
   useEffect(() => {
     if (step !== "scan") return;
-    const fetchWifiList = async () => {
-      try {
-        setLoading(true);
-        const res = await getApi<WifiNetwork[]>("/wifi/list");
-        if (res.ok) setWifiList((res.data as WifiNetwork[]) || []);
-        else throw new Error(res.data as string);
-      } catch (err: any) {
-        console.error(err);
-        setError("Failed to scan Wi-Fi networks.");
-        notif.notify(
-          (err as string) || "Failed to scan Wi-Fi networks.",
-          "error"
-        );
-      } finally {
-        setLoading(false);
-      }
-    };
+    setLoading(true);
+    // Waits for the first scan when the device has none yet
     fetchWifiList();
+
+    // Background rescans are announced over /events
+    return subscribeEvents({
+      scan: (scan: ScanEvent) => {
+        if (scan.generation > generation.current) fetchWifiList();
+      },
+    });
   }, [step]);
 
+  const handleRescan = () => {
+    setLoading(true);
+    fetchWifiList(generation.current);
+  };
+
   const handleSetPassword = () => {
     if (!loginPassword || !confirmPassword) {
       setError("Please fill in both fields.");
@@ -83,12 +114,17 @@ const Wizard: React.FC = () => {
       setLoading(true);
       setStep("connecting");
 
-      const res = await postApi<ConnectionResult>("/wifi/connect", {
+      // The device connects in a background job; poll it until it finished
+      const job = await postApi<{ id: number }>("/wifi/connect", {
         ssid,
         password: wifiPass,
         authPassword: loginPassword,
       });
+      if (!job.ok) throw new Error(job.data as string);
 
+      const res = await waitForJob<ConnectionResult>(
+        (job.data as { id: number }).id
+      );
       if (!res.ok) throw new Error(res.data as string);
       setConnectionResult(res.data as ConnectionResult);
       setStep("done");
@@ -186,7 +222,7 @@ const Wizard: React.FC = () => {
                 ))}
               </div>
               <button
-                onClick={() => setStep("scan")}
+                onClick={handleRescan}
                 className="mt-4 text-blue-500 hover:underline"
               >
                 Rescan